@@ -225,4 +225,46 @@ namespace ScriptAPI
 			WP_CS_Utility::ConvertVector3(_direction)
 		);
 	}
+
+	//vvv			Bulk Definition			vvv
+
+	//System::Numerics::Vector3 and glm::vec3 are both 3 packed floats, pinned arrays are passed as is
+	static_assert(sizeof(System::Numerics::Vector3) == sizeof(glm::vec3));
+
+#ifndef DEFINE_CS_BULK_SET
+#define DEFINE_CS_BULK_SET(_name, _cppFunc)												\
+void WP_CS_PhysicsBulk:: _name (array<System::UInt32>^ _objectIDs, array<CS_Vec3>^ _values)	\
+{																						\
+	if (!_objectIDs || !_values || !_objectIDs->Length) { return; }						\
+	unsigned const count = static_cast<unsigned>(System::Math::Min(_objectIDs->Length, _values->Length));	\
+	pin_ptr<System::UInt32> pIDs = &_objectIDs[0];										\
+	pin_ptr<CS_Vec3> pValues = &_values[0];												\
+	WP_PhysicsCS2CPP:: _cppFunc (pIDs, reinterpret_cast<glm::vec3*>(pValues), count);	\
+}																						\
+
+#endif
+
+	DEFINE_CS_BULK_SET(SetVelocities, SetVelocities);
+	DEFINE_CS_BULK_SET(AddVelocities, AddVelocities);
+	DEFINE_CS_BULK_SET(AddImpulses, AddImpulses);
+	DEFINE_CS_BULK_SET(SetPositions, SetPositions);
+	DEFINE_CS_BULK_SET(GetVelocities, GetVelocities);	//out values, same signature
+	DEFINE_CS_BULK_SET(GetPositions, GetPositions);
+
+	System::UInt32 WP_CS_PhysicsBulk::Raycasts(array<CS_Vec3>^ _origins, array<CS_Vec3>^ _directions,
+		array<System::UInt32>^ _outIDs, array<System::Single>^ _outHitFractions)
+	{
+		if (!_origins || !_directions || !_outIDs || !_outHitFractions || !_origins->Length) { return 0; }
+		unsigned const count = static_cast<unsigned>(System::Math::Min(
+			System::Math::Min(_origins->Length, _directions->Length),
+			System::Math::Min(_outIDs->Length, _outHitFractions->Length)));
+		pin_ptr<CS_Vec3> pOrigins = &_origins[0];
+		pin_ptr<CS_Vec3> pDirections = &_directions[0];
+		pin_ptr<System::UInt32> pIDs = &_outIDs[0];
+		pin_ptr<System::Single> pFractions = &_outHitFractions[0];
+		return WP_PhysicsCS2CPP::Raycasts(
+			reinterpret_cast<glm::vec3*>(pOrigins),
+			reinterpret_cast<glm::vec3*>(pDirections),
+			count, pIDs, pFractions);
+	}
 }
\ No newline at end of file
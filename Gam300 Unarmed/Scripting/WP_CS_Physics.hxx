@@ -217,6 +217,47 @@ namespace ScriptAPI
 
 	};
 
+	/*!***********************************************************************
+	\brief
+		Batched physics calls. Each function crosses into native code once for
+		the whole array instead of once per object. ids and values are parallel
+		arrays of equal length, ids without physics are skipped.
+	*************************************************************************/
+	public ref class WP_CS_PhysicsBulk
+	{
+	public:
+		using CS_Vec3 = System::Numerics::Vector3;
+
+		static void SetVelocities(array<System::UInt32>^ _objectIDs, array<CS_Vec3>^ _velocities);
+		static void AddVelocities(array<System::UInt32>^ _objectIDs, array<CS_Vec3>^ _velocities);
+		static void AddImpulses(array<System::UInt32>^ _objectIDs, array<CS_Vec3>^ _impulses);
+		static void SetPositions(array<System::UInt32>^ _objectIDs, array<CS_Vec3>^ _positions);
+
+		/*!***********************************************************************
+		\brief
+			Fills _outVelocities/_outPositions with the value of each object in
+			_objectIDs. Objects without physics write zero.
+		*************************************************************************/
+		static void GetVelocities(array<System::UInt32>^ _objectIDs, array<CS_Vec3>^ _outVelocities);
+		static void GetPositions(array<System::UInt32>^ _objectIDs, array<CS_Vec3>^ _outPositions);
+
+		/*!***********************************************************************
+		\brief
+			Casts one ray per entry of _origins, from _origins[i] to
+			_origins[i] + _directions[i].
+		\param [out] _outIDs
+			the gameobject id of the first object hit by each ray.
+		\param [out] _outHitFractions
+			the hitFraction of each ray's hit.
+		\return
+			number of rays that hit an object.
+		*************************************************************************/
+		static System::UInt32 Raycasts(array<CS_Vec3>^ _origins, array<CS_Vec3>^ _directions,
+			array<System::UInt32>^ _outIDs, array<System::Single>^ _outHitFractions);
+	internal:
+		WP_CS_PhysicsBulk() {};
+	};
+
 #if 0	
 	public ref class WP_CS_Physics
 	{
@@ -123,4 +123,53 @@ namespace WP_PhysicsCS2CPP
 		if (!pComp || !(pComp->m_isNPC)) { return false; }	//no non-character implementation
 		return WP_PhysicsSystem::GetInstance()->CharacterGetIsGrounded(_objectID);
 	}
+
+	//vvv			Bulk functions. _count entries per array, arrays pinned by the caller			vvv
+
+	static_assert(sizeof(WP_GameObjectID) == sizeof(unsigned), "bulk ids are passed as unsigned arrays");
+
+	void DLL_API SetVelocities(unsigned const* _objectIDs, glm::vec3 const* _newVels, unsigned _count)
+	{
+		WP_PhysicsSystem::GetInstance()->BulkSetLinearVelocity({ _objectIDs, _count }, { _newVels, _count });
+	}
+
+	void DLL_API AddVelocities(unsigned const* _objectIDs, glm::vec3 const* _newVels, unsigned _count)
+	{
+		WP_PhysicsSystem::GetInstance()->BulkAddVelocity({ _objectIDs, _count }, { _newVels, _count });
+	}
+
+	void DLL_API AddImpulses(unsigned const* _objectIDs, glm::vec3 const* _forces, unsigned _count)
+	{
+		WP_PhysicsSystem::GetInstance()->BulkAddImpulse({ _objectIDs, _count }, { _forces, _count });
+	}
+
+	void DLL_API GetVelocities(unsigned const* _objectIDs, glm::vec3* _outVels, unsigned _count)
+	{
+		WP_PhysicsSystem::GetInstance()->BulkGetLinearVelocity({ _objectIDs, _count }, { _outVels, _count });
+	}
+
+	void DLL_API SetPositions(unsigned const* _objectIDs, glm::vec3 const* _newPositions, unsigned _count)
+	{
+		WP_PhysicsSystem::GetInstance()->BulkSetPosition({ _objectIDs, _count }, { _newPositions, _count });
+	}
+
+	void DLL_API GetPositions(unsigned const* _objectIDs, glm::vec3* _outPositions, unsigned _count)
+	{
+		WP_PhysicsSystem::GetInstance()->BulkGetPosition({ _objectIDs, _count }, { _outPositions, _count });
+	}
+
+	unsigned DLL_API Raycasts(glm::vec3 const* _origins, glm::vec3 const* _directions, unsigned _count,
+		unsigned* _outIDs, float* _outHitFractions)
+	{
+		thread_local std::vector<WP_PhysicsSystem::WP_RayResult> results;	//reused between calls
+		results.resize(_count);
+		unsigned const numHits = WP_PhysicsSystem::GetInstance()->BulkCastRay(
+			{ _origins, _count }, { _directions, _count }, results);
+		for (unsigned i{}; i < _count; ++i)
+		{
+			_outIDs[i] = results[i].first;
+			_outHitFractions[i] = results[i].second;
+		}
+		return numHits;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+//Summary of a physics flight recorder dump, see WP_PhysicsFlightRecorder.
+//Usage: WP_PhysicsFlightSummary <dump.wpfr> [number of worst frames, default 5]
+//Builds with WP_PhysicsFlightRecorder.cpp only, no engine or Jolt needed.
+#include <WP_EngineSystem/WP_PhysicsFlightRecorder.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using WP_Recorder = WP_PhysicsFlightRecorder;
+	using WP_FrameRecord = WP_Recorder::WP_FrameRecord;
+
+	void PrintFrame(WP_FrameRecord const& _record)
+	{
+		std::printf("  frame %u: %.3f ms physics, %.3f ms frame, %u steps\n", _record.m_frame, _record.GetTotalTime(),
+			_record.m_frameTime * 1000.f, _record.m_numCollisionSteps);
+		std::printf("    bodies %u (%u active), pairs %u, constraints %u, contacts +%u =%u -%u, delayed %u, temp %u bytes\n",
+			_record.m_numBodies, _record.m_numActiveBodies, _record.m_numBodyPairs, _record.m_numContactConstraints,
+			_record.m_numContactsAdded, _record.m_numContactsPersisted, _record.m_numContactsRemoved,
+			_record.m_numDelayedCommands, _record.m_tempAllocatorHighWaterMark);
+		std::printf("   ");
+		for (uint32_t phase{}; phase < WP_Recorder::c_NumPhases; ++phase)
+		{
+			std::printf(" %s %.3f", WP_Recorder::GetPhaseName(static_cast<WP_Recorder::WP_PhysicsPhase>(phase)), _record.m_phaseTimes[phase]);
+		}
+		std::printf("\n");
+		for (WP_Recorder::WP_IslandRecord const& island : _record.m_topIslands)
+		{
+			if (island.m_numContacts == 0) { break; }
+			std::printf("    island of body %u: %u bodies, %u contacts\n", island.m_bodyIndex, island.m_numBodies, island.m_numContacts);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "Usage: %s <dump.wpfr> [number of worst frames]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	uint32_t const numWorst = (argc > 2) ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 5;
+
+	WP_Recorder::WP_FileHeader header{};
+	std::vector<WP_FrameRecord> records;
+	if (!WP_Recorder::Load(argv[1], header, records))
+	{
+		std::fprintf(stderr, "Could not read %s, missing, truncated or from another build\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+	std::printf("%s: %u records, %s dump", argv[1], header.m_numRecords,
+		(header.m_trigger == WP_Recorder::WP_DumpTrigger::HITCH) ? "hitch" : "manual");
+	if (header.m_hitchThreshold > 0.f) { std::printf(", hitch threshold %.2f ms", header.m_hitchThreshold); }
+	std::printf("\n");
+	if (records.empty()) { return EXIT_SUCCESS; }
+	std::printf("frames %u to %u\n\n", records.front().m_frame, records.back().m_frame);
+
+	//per phase average and worst
+	std::printf("%-14s %10s %10s\n", "phase (ms)", "average", "max");
+	for (uint32_t phase{}; phase <= WP_Recorder::c_NumPhases; ++phase)
+	{
+		bool const isTotal = phase == WP_Recorder::c_NumPhases;
+		float sum{}, max{};
+		for (WP_FrameRecord const& record : records)
+		{
+			float const time = isTotal ? record.GetTotalTime() : record.m_phaseTimes[phase];
+			sum += time;
+			max = std::max(max, time);
+		}
+		std::printf("%-14s %10.3f %10.3f\n", isTotal ? "total" : WP_Recorder::GetPhaseName(static_cast<WP_Recorder::WP_PhysicsPhase>(phase)),
+			sum / static_cast<float>(records.size()), max);
+	}
+
+	//world size peaks
+	auto peak = [&records](uint32_t WP_FrameRecord::* _member)
+		{
+			return (*std::max_element(records.begin(), records.end(),
+				[_member](WP_FrameRecord const& _lhs, WP_FrameRecord const& _rhs) { return _lhs.*_member < _rhs.*_member; })).*_member;
+		};
+	std::printf("\npeak bodies %u, active %u, pairs %u, constraints %u, contacts added %u, delayed %u, temp %u bytes\n",
+		peak(&WP_FrameRecord::m_numBodies), peak(&WP_FrameRecord::m_numActiveBodies), peak(&WP_FrameRecord::m_numBodyPairs),
+		peak(&WP_FrameRecord::m_numContactConstraints), peak(&WP_FrameRecord::m_numContactsAdded),
+		peak(&WP_FrameRecord::m_numDelayedCommands), peak(&WP_FrameRecord::m_tempAllocatorHighWaterMark));
+
+	//slowest updates, then the last one, which is usually the hitch
+	std::vector<uint32_t> order(records.size());
+	std::iota(order.begin(), order.end(), 0u);
+	uint32_t const numShown = std::min<uint32_t>(numWorst, static_cast<uint32_t>(order.size()));
+	std::partial_sort(order.begin(), order.begin() + numShown, order.end(),
+		[&records](uint32_t _lhs, uint32_t _rhs) { return records[_lhs].GetTotalTime() > records[_rhs].GetTotalTime(); });
+	std::printf("\n%u slowest updates\n", numShown);
+	for (uint32_t i{}; i < numShown; ++i) { PrintFrame(records[order[i]]); }
+	std::printf("\nlast update\n");
+	PrintFrame(records.back());
+	return EXIT_SUCCESS;
+}
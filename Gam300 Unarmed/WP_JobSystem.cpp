@@ -0,0 +1,245 @@
+#include <WP_EngineSystem/WP_JobSystem.h>
+#include <algorithm>
+CREATE_ENGINE_INSTANCE_CPP(WP_JobSystem);
+
+namespace
+{
+	thread_local int t_workerIndex = -1;		//index of this thread in m_workers, -1 outside the workers
+}
+
+WP_JobSystem::WP_JobSystem() :
+	WP_EngineSystem(WP_EngineSystem::s_kSystemFlagsAll, "WP_JobSystem")
+{
+	//the main thread runs jobs too whenever it waits
+	uint32_t const numWorkers = static_cast<uint32_t>(std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1));
+	m_workers.reserve(numWorkers);
+	for (uint32_t i{}; i < numWorkers; ++i)
+	{
+		m_workers.push_back(std::make_unique<WP_Worker>());
+	}
+	m_isRunning = true;
+	for (uint32_t i{}; i < numWorkers; ++i)
+	{
+		m_workers[i]->m_thread = std::thread(&WP_JobSystem::WorkerMain, this, i);
+	}
+}
+
+WP_JobSystem::~WP_JobSystem()
+{
+	Shutdown();
+}
+
+void WP_JobSystem::OnUpdate()
+{	//Empty by Design, workers run on their own
+}
+
+void WP_JobSystem::OnApplicationEnd()
+{
+	Shutdown();
+}
+
+void WP_JobSystem::Shutdown()
+{
+	if (!m_isRunning.exchange(false)) { return; }
+	{
+		std::lock_guard lock{ m_sleepMutex };
+	}
+	m_sleepCondition.notify_all();
+	for (auto& worker : m_workers)
+	{
+		if (worker->m_thread.joinable()) { worker->m_thread.join(); }
+	}
+	//anything still queued runs here, jobs scheduled from now on run on the caller
+	WP_Job job;
+	while (Pop(job)) { Run(job); }
+}
+
+bool WP_JobSystem::GetIsWorkerThread() const
+{
+	return t_workerIndex >= 0;
+}
+
+void WP_JobSystem::Schedule(WP_JobFunction _function, WP_JobPriority _priority, WP_JobCounter* _counter)
+{
+	if (_counter) { _counter->m_count.fetch_add(1, std::memory_order_acq_rel); }
+	WP_Job job{ std::move(_function), _counter };
+	if (!m_isRunning.load(std::memory_order_acquire))
+	{
+		Run(job);
+		return;
+	}
+	Push(std::move(job), _priority);
+}
+
+void WP_JobSystem::ScheduleAfter(WP_JobCounter& _dependency, WP_JobFunction _function, WP_JobPriority _priority, WP_JobCounter* _counter)
+{
+	if (_counter) { _counter->m_count.fetch_add(1, std::memory_order_acq_rel); }
+	{
+		std::lock_guard lock{ _dependency.m_pendingMutex };
+		if (!_dependency.IsDone())
+		{	//the last job of _dependency queues it in Finish
+			_dependency.m_pendingJobs.push_back(WP_JobCounter::WP_PendingJob{ std::move(_function), _priority, _counter });
+			return;
+		}
+	}
+	WP_Job job{ std::move(_function), _counter };
+	if (!m_isRunning.load(std::memory_order_acquire))
+	{
+		Run(job);
+		return;
+	}
+	Push(std::move(job), _priority);
+}
+
+void WP_JobSystem::Wait(WP_JobCounter& _counter)
+{
+	while (!_counter.IsDone())
+	{
+		if (TryRunJob()) { continue; }
+		if (!m_isRunning.load(std::memory_order_acquire))
+		{	//shut down, the last jobs finish on the threads running them
+			std::this_thread::yield();
+			continue;
+		}
+		//nothing to help with, sleep until the counter is done or a job is queued.
+		//raised before the checks, Finish and Push read these after their own change
+		_counter.m_numWaiting.fetch_add(1);
+		{
+			std::unique_lock lock{ m_sleepMutex };
+			m_numSleeping.fetch_add(1);
+			m_sleepCondition.wait(lock, [this, &_counter]()
+				{
+					return _counter.IsDone() || m_numQueued.load() > 0 || !m_isRunning.load();
+				});
+			m_numSleeping.fetch_sub(1);
+		}
+		_counter.m_numWaiting.fetch_sub(1);
+	}
+	//the last Finish may still be releasing the counter, the caller is free to destroy it after this
+	std::lock_guard lock{ _counter.m_pendingMutex };
+}
+
+bool WP_JobSystem::TryRunJob(WP_JobPriority _lowestPriority)
+{
+	WP_Job job;
+	if (!Pop(job, _lowestPriority)) { return false; }
+	Run(job);
+	return true;
+}
+
+void WP_JobSystem::Push(WP_Job&& _job, WP_JobPriority _priority)
+{
+	uint32_t const numWorkers = static_cast<uint32_t>(m_workers.size());
+	uint32_t const index = (t_workerIndex >= 0) ? static_cast<uint32_t>(t_workerIndex)
+		: m_nextWorker.fetch_add(1, std::memory_order_relaxed) % numWorkers;
+	WP_Worker& worker = *m_workers[index];
+	{
+		std::lock_guard lock{ worker.m_mutex };
+		worker.m_queues[static_cast<size_t>(_priority)].push_back(std::move(_job));
+	}
+	m_numQueued.fetch_add(1);
+	//sleepers raise the count before checking m_numQueued, one of the two sides always sees the other
+	if (m_numSleeping.load() > 0) { WakeSleepers(false); }
+}
+
+void WP_JobSystem::WakeSleepers(bool _isAll)
+{
+	{	//a thread between its checks and its wait would miss the notify otherwise
+		std::lock_guard lock{ m_sleepMutex };
+	}
+	if (_isAll) { m_sleepCondition.notify_all(); }
+	else { m_sleepCondition.notify_one(); }
+}
+
+bool WP_JobSystem::Pop(WP_Job& _outJob, WP_JobPriority _lowestPriority)
+{
+	if (m_numQueued.load(std::memory_order_acquire) == 0) { return false; }
+	uint32_t const numWorkers = static_cast<uint32_t>(m_workers.size());
+	int const self = t_workerIndex;
+	for (size_t priority{}; priority <= static_cast<size_t>(_lowestPriority); ++priority)
+	{
+		if (self >= 0)
+		{	//own queue, newest first while its data is still in cache
+			WP_Worker& worker = *m_workers[self];
+			std::lock_guard lock{ worker.m_mutex };
+			auto& queue = worker.m_queues[priority];
+			if (!queue.empty())
+			{
+				_outJob = std::move(queue.back());
+				queue.pop_back();
+				m_numQueued.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		for (uint32_t i{}; i < numWorkers; ++i)
+		{	//steal the oldest job, starting after this worker so thieves spread out
+			uint32_t const victim = (static_cast<uint32_t>(self + 1) + i) % numWorkers;
+			if (static_cast<int>(victim) == self) { continue; }
+			WP_Worker& worker = *m_workers[victim];
+			std::lock_guard lock{ worker.m_mutex };
+			auto& queue = worker.m_queues[priority];
+			if (!queue.empty())
+			{
+				_outJob = std::move(queue.front());
+				queue.pop_front();
+				m_numQueued.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void WP_JobSystem::Run(WP_Job& _job)
+{
+	_job.m_function();
+	if (_job.m_counter) { Finish(*_job.m_counter); }
+}
+
+void WP_JobSystem::Finish(WP_JobCounter& _counter)
+{
+	uint32_t count = _counter.m_count.load(std::memory_order_acquire);
+	while (count > 1)
+	{	//not the last job, no need for the lock
+		if (_counter.m_count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel)) { return; }
+	}
+
+	//last job, reach zero under the lock so ScheduleAfter and Wait see a consistent counter
+	std::vector<WP_JobCounter::WP_PendingJob> pending;
+	bool hasWaiters{};
+	{	//_counter may be gone once the lock is released, read its waiters inside
+		std::lock_guard lock{ _counter.m_pendingMutex };
+		_counter.m_count.fetch_sub(1);
+		pending.swap(_counter.m_pendingJobs);
+		hasWaiters = _counter.m_numWaiting.load() > 0;
+	}
+	if (hasWaiters) { WakeSleepers(true); }	//the waiter may not be the one notify_one picks
+	for (auto& job : pending)
+	{
+		WP_Job ready{ std::move(job.m_function), job.m_counter };
+		if (m_isRunning.load(std::memory_order_acquire)) { Push(std::move(ready), job.m_priority); }
+		else { Run(ready); }
+	}
+}
+
+void WP_JobSystem::WorkerMain(uint32_t _index)
+{
+	t_workerIndex = static_cast<int>(_index);
+	for (;;)
+	{
+		WP_Job job;
+		if (Pop(job))
+		{
+			Run(job);
+			continue;
+		}
+		std::unique_lock lock{ m_sleepMutex };
+		m_numSleeping.fetch_add(1);
+		m_sleepCondition.wait(lock, [this]()
+			{
+				return m_numQueued.load() > 0 || !m_isRunning.load(std::memory_order_acquire);
+			});
+		m_numSleeping.fetch_sub(1);
+		if (!m_isRunning.load(std::memory_order_acquire) && m_numQueued.load(std::memory_order_acquire) == 0) { return; }
+	}
+}
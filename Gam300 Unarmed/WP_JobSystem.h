@@ -0,0 +1,106 @@
+#pragma once
+#include <WP_EngineSystem/WP_EngineSystem.h>
+#include <WP_EngineSystem/WP_CSharp/WP_ImportExport.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Engine wide work stealing scheduler. One worker per core but the main thread, every system
+//(physics, animation, culling, scripting) schedules onto the same workers instead of making its own pool.
+//
+//Each worker owns one deque per priority. A worker pops its own newest job first, then steals
+//the oldest job of another worker, higher priorities before lower ones. Jobs scheduled from a
+//thread that is not a worker are spread over the workers round robin.
+//
+//Completion is tracked with WP_JobCounter: every job scheduled with a counter holds it up until it
+//finishes. Jobs can be held back until a counter reaches zero with ScheduleAfter, and Wait runs
+//other jobs while waiting, so it is safe to wait from inside a job. With nothing to run, waiting
+//threads and idle workers sleep, Push only wakes one if a thread is asleep.
+class DLL_API WP_JobSystem : WP_EngineSystem
+{
+public:
+	using WP_JobFunction = std::function<void()>;
+
+	enum class WP_JobPriority : uint8_t
+	{
+		HIGH,			//frame critical work, physics steps
+		NORMAL,
+		LOW,			//background work that may take several frames
+		NUM_PRIORITIES
+	};
+
+	class WP_JobCounter
+	{
+	public:
+		bool		IsDone() const { return m_count.load(std::memory_order_acquire) == 0; }
+		uint32_t	GetCount() const { return m_count.load(std::memory_order_acquire); }
+	private:
+		friend class WP_JobSystem;
+		struct WP_PendingJob
+		{
+			WP_JobFunction	m_function;
+			WP_JobPriority	m_priority;
+			WP_JobCounter*	m_counter;
+		};
+		std::atomic<uint32_t>		m_count{ 0 };
+		std::atomic<uint32_t>		m_numWaiting{ 0 };	//threads asleep in Wait on this counter
+		std::mutex					m_pendingMutex;
+		std::vector<WP_PendingJob>	m_pendingJobs;		//scheduled with ScheduleAfter, queued when the count reaches zero
+	};
+
+	void		OnApplicationEnd() override;
+
+	//_counter is raised now and lowered when the job has run, it must outlive the job
+	void		Schedule(WP_JobFunction _function, WP_JobPriority _priority = WP_JobPriority::NORMAL, WP_JobCounter* _counter = nullptr);
+	//queued once _dependency reaches zero, immediately if it already has
+	void		ScheduleAfter(WP_JobCounter& _dependency, WP_JobFunction _function,
+					WP_JobPriority _priority = WP_JobPriority::NORMAL, WP_JobCounter* _counter = nullptr);
+	//runs queued jobs on this thread until _counter reaches zero
+	void		Wait(WP_JobCounter& _counter);
+	//runs one queued job of _lowestPriority or higher on this thread, false if there was nothing to run
+	bool		TryRunJob(WP_JobPriority _lowestPriority = WP_JobPriority::LOW);
+
+	uint32_t	GetNumWorkers() const { return static_cast<uint32_t>(m_workers.size()); }
+	bool		GetIsWorkerThread() const;
+
+private:
+	WP_JobSystem();
+	~WP_JobSystem();
+	CREATE_ENGINE_INSTANCE_H(WP_JobSystem);
+
+	void OnUpdate() override;
+
+	struct WP_Job
+	{
+		WP_JobFunction	m_function;
+		WP_JobCounter*	m_counter = nullptr;
+	};
+	struct WP_Worker
+	{
+		std::mutex													m_mutex;
+		std::array<std::deque<WP_Job>, static_cast<size_t>(WP_JobPriority::NUM_PRIORITIES)>	m_queues;
+		std::thread													m_thread;
+	};
+
+	void		WorkerMain(uint32_t _index);
+	void		Push(WP_Job&& _job, WP_JobPriority _priority);
+	bool		Pop(WP_Job& _outJob, WP_JobPriority _lowestPriority = WP_JobPriority::LOW);
+	void		WakeSleepers(bool _isAll);
+	void		Run(WP_Job& _job);
+	void		Finish(WP_JobCounter& _counter);
+	void		Shutdown();
+
+	std::vector<std::unique_ptr<WP_Worker>>		m_workers;
+	std::atomic<uint32_t>						m_nextWorker{ 0 };		//round robin for jobs from outside the workers
+	std::atomic<uint32_t>						m_numQueued{ 0 };
+	std::atomic<bool>							m_isRunning{ false };
+	std::atomic<uint32_t>						m_numSleeping{ 0 };		//workers and waiters blocked on m_sleepCondition
+	std::mutex									m_sleepMutex;
+	std::condition_variable						m_sleepCondition;
+};
@@ -134,6 +134,10 @@ RTTR_REGISTRATION
 		(
 			rttr::metadata(MetaDataTypes::DISABLE_ON_RUN_IMGUI,true)
 		)
+		QUICK_REGISTER_RTTR_PROPERTY("m_isTrackedSensor",WP_Physics3D,GetIsTrackedSensor,SetIsTrackedSensor)
+		(
+			rttr::metadata(MetaDataTypes::DISABLE_ON_RUN_IMGUI,true)
+		)
 		.property("m_lockedAxes", &WP_Physics3D::GetLockedAxis, &WP_Physics3D::SetLockedAxis)
 		(
 			rttr::metadata(MetaDataTypes::CHAR_IS_BITMAP, true)
@@ -144,6 +148,10 @@ RTTR_REGISTRATION
 		QUICK_REGISTER_RTTR_PROPERTY("m_friction",WP_Physics3D,GetFriction,SetFriction)
 		QUICK_REGISTER_RTTR_PROPERTY("m_restitution",WP_Physics3D,GetCOR,SetCOR)
 		QUICK_REGISTER_RTTR_PROPERTY("m_mass",WP_Physics3D,GetMass,SetMass)
+		.property("m_meshPath", &WP_Physics3D::m_meshPath)
+		(
+			rttr::metadata(MetaDataTypes::DISABLE_ON_RUN_IMGUI,true)
+		)
 	;
 
 //================================================================================
@@ -233,11 +241,13 @@ void WP_Physics3D::Init()
 
 void WP_Physics3D::OnEnabled()
 {
+	WP_PhysicsSystem::GetInstance()->MarkTransformBindingsDirty();
 	SetBodyActive();
 }
 
 void WP_Physics3D::OnDisabled()
 {
+	WP_PhysicsSystem::GetInstance()->MarkTransformBindingsDirty();
 	SetBodyUnactive();
 }
 
@@ -262,15 +272,19 @@ WP_Physics3D& WP_Physics3D::operator=(WP_Physics3D&& _ref) noexcept
 
 	m_isActive = std::move(_ref.m_isActive);
 	m_isPureStatic = std::move(_ref.m_isPureStatic);
+	m_isBaked = std::exchange(_ref.m_isBaked, false);
+	m_isStreamed = std::exchange(_ref.m_isStreamed, false);
 	m_useTransformScale = std::move(_ref.m_useTransformScale);
 	m_isNPC = std::move(_ref.m_isNPC);
 	m_motionType = std::move(_ref.m_motionType);
 	m_shapeType = std::move(_ref.m_shapeType);
+	m_meshPath = std::move(_ref.m_meshPath);
 	m_lockedAxis = std::move(_ref.m_lockedAxis);
 
 	m_objectLayer = std::move(_ref.m_objectLayer);
 
 	m_bID = std::move(_ref.m_bID);
+	if (!m_bID.IsInvalid()) { WP_PhysicsSystem::GetInstance()->MarkTransformBindingsDirty(); }	//bound to _ref's address
 
 	//advance settings
 	m_gravityScale = std::move(_ref.m_gravityScale);
@@ -296,11 +310,14 @@ WP_Physics3D& WP_Physics3D::operator=(WP_Physics3D const& _ref)
 	m_isNPC = _ref.m_isNPC;
 	m_motionType = _ref.m_motionType;
 	m_shapeType = _ref.m_shapeType;
+	m_meshPath = _ref.m_meshPath;
 	m_lockedAxis = _ref.m_lockedAxis;
 
 	m_objectLayer = _ref.m_objectLayer;
 
 	m_bID = JPH::BodyID(JPH::BodyID::cInvalidBodyID);
+	m_isBaked = false;
+	m_isStreamed = false;
 
 	//advance settings
 	m_gravityScale = _ref.m_gravityScale;
@@ -341,6 +358,10 @@ void WP_Physics3D::SetScale(glm::vec3 const& _scale)
 	case WP_PhysicsShape::CYLINDER:
 		SetScaleCylinder(_scale.x, _scale.y);	//cylinder, use x and y axis only
 		return;
+	case WP_PhysicsShape::MESH:
+	case WP_PhysicsShape::CONVEX_HULL:			//scale of the cooked mesh, used if m_useTransformScale is off
+		m_shapeScale = _scale;
+		return;
 	default:
 		assert(0 && "Invalid Shape type found,  WP_Physics3D::SetScale(glm::vec3 const& _scale)");
 		WP_ERROR("Invalid Shape type found,  WP_Physics3D::SetScale(glm::vec3 const& _scale)");
@@ -449,6 +470,7 @@ void WP_Physics3D::SetIsActive(bool _active)
 	m_isActive = _active;										//track active state in component
 
 	if (m_bID.IsInvalid()) { return; }	//if body not yet created, no change
+	WP_PhysicsSystem::GetInstance()->MarkSnapshotDirty(m_bID);
 	auto& bodyInterface = WP_PhysicsSystem::GetInstance()->GetPhysicsBI();
 	if (_active)
 		bodyInterface.ActivateBody(m_bID);
@@ -527,6 +549,7 @@ glm::vec3 WP_Physics3D::GetPosOffset() const
 void WP_Physics3D::SetPosOffset(glm::vec3 _newPos)
 {
 	m_posOffset = WP_Physics::ToJoltVec3(_newPos);
+	WP_PhysicsSystem::GetInstance()->MarkTransformBindingsDirty();
 }
 
 //================================================
@@ -539,6 +562,7 @@ glm::quat WP_Physics3D::GetRotOffset() const
 void WP_Physics3D::SetRotOffset(glm::quat _newRot)
 {
 	m_rotOffset = WP_Physics::ToJoltQuat(glm::normalize(_newRot));
+	WP_PhysicsSystem::GetInstance()->MarkTransformBindingsDirty();
 }
 
 glm::vec3 WP_Physics3D::GetRotOffsetAngles() const
@@ -550,6 +574,7 @@ void WP_Physics3D::SetRotOffsetAngles(glm::vec3 _newRot)
 {
 	GetRadianFromDegreesVector(_newRot);
 	m_rotOffset = JPH::Quat::sEulerAngles(WP_Physics::ToJoltVec3(_newRot));
+	WP_PhysicsSystem::GetInstance()->MarkTransformBindingsDirty();
 }
 
 
@@ -637,7 +662,7 @@ glm::vec3 WP_Physics3D::CharacterGetRotattion() const
 //================================================
 //				Add/Remove Functions
 //================================================
-void WP_Physics3D::AddBody()
+JPH::ShapeSettings::ShapeResult WP_Physics3D::CreateShape()
 {
 	auto* transComp = WP_ComponentList<WP_Transform3D>::GetComponentList()->GetComponent(GetGameObjectID());
 
@@ -695,32 +720,65 @@ void WP_Physics3D::AddBody()
 		shapeSettingsPtr = std::make_unique<JPH::CapsuleShapeSettings>(m_shapeScale.y, m_shapeScale.x);
 	}
 	break;
+	case WP_PhysicsShape::MESH:
+	case WP_PhysicsShape::CONVEX_HULL:
+	{	//cooked once per asset and shared, only the scale is per collider
+		using WP_CookType = WP_PhysicsMeshCooker::WP_CookType;
+		WP_CookType cookType = (m_shapeType == WP_PhysicsShape::MESH) ? WP_CookType::MESH : WP_CookType::CONVEX_HULL;
+		if (cookType == WP_CookType::MESH && !m_isPureStatic && m_motionType == JPH::EMotionType::Dynamic)
+		{
+			WP_WARN("Mesh colliders can not be dynamic, using the convex hull of %s. WP_Physics3D::CreateShape()", m_meshPath.c_str());
+			cookType = WP_CookType::CONVEX_HULL;
+		}
+		JPH::RefConst<JPH::Shape> cooked = WP_PhysicsSystem::GetInstance()->GetMeshCooker().GetShape(m_meshPath, cookType);
+		if (!cooked)
+		{
+			shapeSettingsPtr = std::make_unique<JPH::EmptyShapeSettings>();
+			break;
+		}
+		glm::vec3 const scale = (m_useTransformScale && transComp) ? transComp->m_globalScale : m_shapeScale;
+		shapeSettingsPtr = std::make_unique<JPH::ScaledShapeSettings>(cooked, WP_Physics::ToJoltVec3(scale));
+	}
+	break;
 	default:
 		assert(0 && "invalid shape type for physics component [%d]");
 		break;
 	};
-#ifdef _DEBUG
-	auto shapeChecker{ shapeSettingsPtr->Create() };
+	return shapeSettingsPtr->Create();
+}
+
+void WP_Physics3D::AddBody()
+{
+	if (m_isBaked || m_isStreamed) { return; }	//owned by its baked static or streaming cell
+	auto shapeChecker{ CreateShape() };
 	assert(shapeChecker.IsValid());				//check for invalid shapes
+	WP_PhysicsSystem::GetInstance()->MarkTransformBindingsDirty();
 
 	if (m_isNPC) { AddCharacter(shapeChecker); return; }	//if character, split off to character creation function
 
-	JPH::BodyCreationSettings bodySettings = JPH::BodyCreationSettings
-	(shapeChecker.Get()							//predefined & checked shape
-		, JPH::Vec3Arg()						//zero vector position, values will be updated before first physics loop
-		, JPH::QuatArg::sIdentity()				//Id Quartation for rotation, values will be updated before first physics loop
-		, m_motionType							//preset motion type
-		, m_objectLayer);						//preset objectLayer
-#else
-	if (m_isNPC) { AddCharacter(shapeSettingsPtr->Create()); return; }	//if character, split off to character creation function
+	WP_PhysicsSystem* const physicsSystem = WP_PhysicsSystem::GetInstance();
+	JPH::BodyCreationSettings const bodySettings = CreateBodySettings(shapeChecker);
+	m_bID = physicsSystem->AcquirePooledBody(bodySettings);		//parked body of the same shape on pooled layers
+	if (m_bID.IsInvalid())
+	{
+		m_bID = physicsSystem->GetPhysicsBI().CreateAndAddBody(bodySettings, JPH::EActivation::Activate);
+	}
+	m_isInPhysicsSystem = true;
+	//std::cout <<"created with ID[" << (m_bID.GetIndex()) << "]\n";
+	//WP_WARN("created with ID[%d]\n",m_bID.GetIndex());
+	assert(!m_bID.IsInvalid());
+	WP_PhysicsSystem::GetInstance()->GetPhysicsBI().SetUserData(m_bID,GetGameObjectID());
+	physicsSystem->UpdateSensorTracking(*this);
+}
 
+JPH::BodyCreationSettings WP_Physics3D::CreateBodySettings(JPH::ShapeSettings::ShapeResult const& _shape)
+{
 	JPH::BodyCreationSettings bodySettings = JPH::BodyCreationSettings
-	(shapeSettingsPtr->Create().Get()			//predefined shape
+	(_shape.Get()							//predefined & checked shape
 		, JPH::Vec3Arg()						//zero vector position, values will be updated before first physics loop
 		, JPH::QuatArg::sIdentity()				//Id Quartation for rotation, values will be updated before first physics loop
 		, m_motionType							//preset motion type
 		, m_objectLayer);						//preset objectLayer
-#endif // _DEBUG
 
 	if (m_isPureStatic)
 	{
@@ -733,6 +791,10 @@ void WP_Physics3D::AddBody()
 	}
 		
 	bodySettings.mIsSensor = m_isTrigger;
+	if (m_isTrigger && m_isTrackedSensor && (m_objectLayer == Layers::MOVING || m_objectLayer == Layers::NON_MOVING))
+	{	//opted in triggers go to the sensor tree instead of inflating the moving/static trees
+		bodySettings.mObjectLayer = Layers::SENSOR;
+	}
 	JPH::MassProperties massStats;
 	massStats.ScaleToMass(m_mass);
 	bodySettings.mMassPropertiesOverride = massStats;
@@ -740,13 +802,7 @@ void WP_Physics3D::AddBody()
 	bodySettings.mGravityFactor = m_gravityScale;
 	bodySettings.mFriction = m_friction;
 	bodySettings.mRestitution = m_restitution;
-	
-	m_bID = WP_PhysicsSystem::GetInstance()->GetPhysicsBI().CreateAndAddBody(bodySettings, JPH::EActivation::Activate);
-	m_isInPhysicsSystem = true;
-	//std::cout <<"created with ID[" << (m_bID.GetIndex()) << "]\n";
-	//WP_WARN("created with ID[%d]\n",m_bID.GetIndex());
-	assert(!m_bID.IsInvalid());
-	WP_PhysicsSystem::GetInstance()->GetPhysicsBI().SetUserData(m_bID,GetGameObjectID());
+	return bodySettings;
 }
 
 void WP_Physics3D::AddCharacter(JPH::ShapeSettings::ShapeResult const& _shape)
@@ -776,7 +832,21 @@ void WP_Physics3D::AddCharacter(JPH::ShapeSettings::ShapeResult const& _shape)
 
 void WP_Physics3D::RemoveBody() 
 {	
+	if (m_isStreamed)
+	{	//its body, if loaded, is freed by the cell and the cell forgets it
+		WP_PhysicsSystem::GetInstance()->UnstreamCollider(*this, false);
+		return;
+	}
+	if (m_isBaked)
+	{	//no body of its own, its cell is rebuilt without it
+		WP_PhysicsSystem::GetInstance()->UnbakeCollider(*this, false);
+		return;
+	}
 	if (m_bID.IsInvalid()) { return; }	//catch no create body
+	WP_PhysicsSystem::GetInstance()->MarkTransformBindingsDirty();
+	WP_PhysicsSystem::GetInstance()->ForgetIgnoredContacts(m_bID);	//a pooled body keeps its id
+	if (WP_PhysicsSystem::GetInstance()->GetIsRayCacheEnabled()) { WP_PhysicsSystem::GetInstance()->InvalidateRayCache(); }
+	WP_PhysicsSystem::GetInstance()->UnregisterSensor(GetGameObjectID());	//exits for what it was overlapping
 	if (m_isNPC) { RemoveCharacter(); return; }					//special remove npc
 
 	if (m_isInPhysicsSystem) 
@@ -784,8 +854,11 @@ void WP_Physics3D::RemoveBody()
 		WP_PhysicsSystem::GetInstance()->GetPhysicsBI().RemoveBody(m_bID);
 		m_isInPhysicsSystem = false;
 	}
-	//remove body from system, then destroy the body.
-	WP_PhysicsSystem::GetInstance()->GetPhysicsBI().DestroyBody(m_bID);
+	//remove body from system, then park or destroy the body.
+	if (!WP_PhysicsSystem::GetInstance()->ReleasePooledBody(m_bID))
+	{
+		WP_PhysicsSystem::GetInstance()->GetPhysicsBI().DestroyBody(m_bID);
+	}
 	m_bID = (JPH::BodyID)JPH::BodyID::cInvalidBodyID;
 }
 
@@ -822,6 +895,7 @@ void WP_Physics3D::SetBodyActive(bool _active)
 
 void WP_Physics3D::SetBodyActive() 
 {
+	if (m_isBaked || m_isStreamed) { return; }	//owned by its baked static or streaming cell
 	assert(!m_isInPhysicsSystem || !m_bID.IsInvalid());			//debug mode assert
 	if (m_isInPhysicsSystem || m_bID.IsInvalid()) { return; }	//catch on release 
 	if (m_isNPC) {
@@ -833,12 +907,16 @@ void WP_Physics3D::SetBodyActive()
 	else 
 	{
 		WP_PhysicsSystem::GetInstance()->GetPhysicsBI().AddBody(m_bID,WP_ACTIVATION_IS_ACTIVE(m_isActive));
+		WP_PhysicsSystem::GetInstance()->MarkSnapshotDirty(m_bID);
 		m_isInPhysicsSystem = true;
+		WP_PhysicsSystem::GetInstance()->UpdateSensorTracking(*this);
 	}
 }
 
 void WP_Physics3D::SetBodyUnactive() 
 {
+	if (m_isStreamed) { WP_PhysicsSystem::GetInstance()->UnstreamCollider(*this, true); }	//own body out of the cell, removed below
+	if (m_isBaked) { WP_PhysicsSystem::GetInstance()->UnbakeCollider(*this, true); }	//own body out of the cell, removed below
 	assert(m_isInPhysicsSystem && !m_bID.IsInvalid());			//debug mode assert
 	if (!m_isInPhysicsSystem || m_bID.IsInvalid()) { return; }	//catch on release 
 	if (m_isNPC) {
@@ -850,7 +928,9 @@ void WP_Physics3D::SetBodyUnactive()
 	else 
 	{
 		WP_PhysicsSystem::GetInstance()->GetPhysicsBI().RemoveBody(m_bID);
+		WP_PhysicsSystem::GetInstance()->MarkSnapshotDirty(m_bID);
 		m_isInPhysicsSystem = false;
+		WP_PhysicsSystem::GetInstance()->UnregisterSensor(GetGameObjectID());
 	}
 }
 
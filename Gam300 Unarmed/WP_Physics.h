@@ -5,6 +5,7 @@
 #include <WP_EngineSystem/WP_CSharp/WP_CSharpSystem.h>
 #include <WP_ECS/WP_Component.h>
 
+#include <string>
 #include <type_traits>
 
 //Other Jolt includes
@@ -15,6 +16,7 @@
 #include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
 #include <Jolt/Physics/Collision/Shape/CylinderShape.h>
 #include <Jolt/Physics/Collision/Shape/EmptyShape.h>
+#include <Jolt/Physics/Collision/Shape/ScaledShape.h>
 
 #include <Jolt/Physics/Body/BodyInterface.h>
 #include <Jolt/Physics/Body/BodyCreationSettings.h>
@@ -28,8 +30,9 @@ enum class WP_PhysicsShape : char
 	CUBE,
 	CAPSULE,
 	CYLINDER,
+	MESH,			//cooked from m_meshPath, static and kinematic only
+	CONVEX_HULL,	//cooked from m_meshPath
 	NUM_PHYSICS_SHAPES
-	//,CONVEX_HULL //custom shapes, currently unsupported
 };
 DLL_API WP_PhysicsShape& operator++(WP_PhysicsShape& _shape);
 DLL_API WP_PhysicsShape operator++(WP_PhysicsShape& _shape, int);
@@ -138,6 +141,8 @@ struct DLL_API WP_Physics3D : WP_Component
 	void OnEnabled() override;
 	void OnDisabled() override;
 
+	JPH::ShapeSettings::ShapeResult CreateShape();	//shape from shape type and scale, shared by AddBody and the static bake
+	JPH::BodyCreationSettings CreateBodySettings(JPH::ShapeSettings::ShapeResult const& _shape);	//zero transform, shared by AddBody and world streaming
 	void AddBody();
 	void SuspendBody();
 	void RemoveBody();
@@ -176,6 +181,7 @@ struct DLL_API WP_Physics3D : WP_Component
 	void SetIsNPC(bool);
 
 	DECLARE_GETTER_SETTER(GetIsTrigger, SetIsTrigger, bool, m_isTrigger);
+	DEFINE_GETTER_SETTER(GetIsTrackedSensor, SetIsTrackedSensor, bool, m_isTrackedSensor);
 
 	bool GetIsValid() const;
 
@@ -218,9 +224,12 @@ struct DLL_API WP_Physics3D : WP_Component
 	bool							m_isActive				{false};							//whether the body starts as active in the physics simulation, statics are always not active
 	bool							m_isPureStatic			{false};							//if pure static, m_motionType is ignored. body will never move. ignored if body is npc.
 	bool							m_isTrigger				{false};							//set the body to a trigger. dynamic is not allowed
-	bool							m_useTransformScale		{true};								//if true, use the scale in transform3D to set shape size
+	bool							m_isTrackedSensor		{false};							//trigger on MOVING/NON_MOVING is moved to Layers::SENSOR for enter/exit tracking, changes its layer pairs
+	bool							m_useTransformScale		{true};								//if true, use the scale in transform3D to set shape size, runtime changes rescale the body
 	bool							m_isNPC					{false};							//If this component is on an npc
 	bool							m_isInPhysicsSystem		{false};							//If this component has been added to physics system
+	bool							m_isBaked				{false};							//merged into a baked static cell by the physics system, m_bID stays invalid
+	bool							m_isStreamed			{false};							//owned by a streaming cell of the physics system, m_bID is only valid while the cell is loaded
 	JPH::EMotionType				m_motionType			{JPH::EMotionType::Static};			//motion type of object
 	WP_PhysicsShape					m_shapeType				{WP_PhysicsShape::CUBE};			//enum to represent shape
 	JPH::EAllowedDOFs				m_lockedAxis			{JPH::EAllowedDOFs::All};			//store which axis of the body is locked. ignored if physics body is character
@@ -238,6 +247,7 @@ struct DLL_API WP_Physics3D : WP_Component
 	float							m_maxSeperationDistance	{1.0f};								//maximum distance the character can be floating off the slope.
 
 	glm::vec3						m_shapeScale			{ 0.5f, 0.5f, 0.5f };				//scale of the shape 
+	std::string						m_meshPath				{};									//source mesh of MESH and CONVEX_HULL shapes, see WP_PhysicsMeshCooker
 
 	std::unique_ptr<JPH::Character>	m_charPtr				{nullptr};							//store pointer to character.
 
@@ -0,0 +1,95 @@
+#include <WP_EngineSystem/WP_PhysicsFlightRecorder.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<WP_PhysicsFlightRecorder::WP_FrameRecord>, "Records are written to file as raw bytes");
+static_assert(std::is_trivially_copyable_v<WP_PhysicsFlightRecorder::WP_FileHeader>, "Header is written to file as raw bytes");
+
+char const* WP_PhysicsFlightRecorder::GetPhaseName(WP_PhysicsPhase _phase)
+{
+	switch (_phase)
+	{
+	case WP_PhysicsPhase::PREPARE:			return "prepare";
+	case WP_PhysicsPhase::FORCE_FIELDS:		return "force fields";
+	case WP_PhysicsPhase::SIMULATION:		return "simulation";
+	case WP_PhysicsPhase::PROJECTILES:		return "projectiles";
+	case WP_PhysicsPhase::PUBLISH:			return "publish";
+	case WP_PhysicsPhase::CALLBACKS:		return "callbacks";
+	case WP_PhysicsPhase::WRITEBACK:		return "writeback";
+	default:								return "unknown";
+	}
+}
+
+float WP_PhysicsFlightRecorder::WP_FrameRecord::GetTotalTime() const
+{
+	return std::accumulate(m_phaseTimes.begin(), m_phaseTimes.end(), 0.f);
+}
+
+WP_PhysicsFlightRecorder::WP_PhysicsFlightRecorder(uint32_t _capacity)
+	: m_records(std::max(_capacity, 1u))
+{/*Empty by Design*/ }
+
+WP_PhysicsFlightRecorder::WP_FrameRecord& WP_PhysicsFlightRecorder::BeginRecord()
+{
+	WP_FrameRecord& record = m_records[m_next];
+	record = WP_FrameRecord{};
+	record.m_frame = m_frame++;
+	m_next = (m_next + 1) % GetCapacity();
+	m_numRecords = std::min(m_numRecords + 1, GetCapacity());
+	return record;
+}
+
+void WP_PhysicsFlightRecorder::Clear()
+{
+	m_next = 0;
+	m_numRecords = 0;
+}
+
+WP_PhysicsFlightRecorder::WP_FrameRecord const& WP_PhysicsFlightRecorder::GetRecord(uint32_t _index) const
+{
+	assert(_index < m_numRecords);
+	uint32_t const oldest = (m_next + GetCapacity() - m_numRecords) % GetCapacity();
+	return m_records[(oldest + _index) % GetCapacity()];
+}
+
+bool WP_PhysicsFlightRecorder::Dump(std::string const& _path, WP_DumpTrigger _trigger, float _hitchThreshold) const
+{
+	std::ofstream file{ _path, std::ios::binary | std::ios::trunc };
+	if (!file) { return false; }
+	WP_FileHeader header{};
+	std::memcpy(header.m_magic, c_Magic, sizeof(c_Magic));
+	header.m_version = c_Version;
+	header.m_recordSize = sizeof(WP_FrameRecord);
+	header.m_numPhases = c_NumPhases;
+	header.m_numTopIslands = WP_PHYSICS_FLIGHT_RECORDER_TOP_ISLANDS;
+	header.m_numRecords = m_numRecords;
+	header.m_trigger = _trigger;
+	header.m_hitchThreshold = _hitchThreshold;
+	file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+	//the ring is at most two contiguous runs, oldest first
+	uint32_t const oldest = (m_next + GetCapacity() - m_numRecords) % GetCapacity();
+	uint32_t const firstRun = std::min(m_numRecords, GetCapacity() - oldest);
+	file.write(reinterpret_cast<char const*>(&m_records[oldest]), static_cast<std::streamsize>(firstRun * sizeof(WP_FrameRecord)));
+	file.write(reinterpret_cast<char const*>(m_records.data()), static_cast<std::streamsize>((m_numRecords - firstRun) * sizeof(WP_FrameRecord)));
+	return static_cast<bool>(file);
+}
+
+bool WP_PhysicsFlightRecorder::Load(std::string const& _path, WP_FileHeader& _header, std::vector<WP_FrameRecord>& _records)
+{
+	std::ifstream file{ _path, std::ios::binary };
+	if (!file) { return false; }
+	if (!file.read(reinterpret_cast<char*>(&_header), sizeof(_header))) { return false; }
+	if (std::memcmp(_header.m_magic, c_Magic, sizeof(c_Magic)) != 0 || _header.m_version != c_Version
+		|| _header.m_recordSize != sizeof(WP_FrameRecord) || _header.m_numPhases != c_NumPhases
+		|| _header.m_numTopIslands != WP_PHYSICS_FLIGHT_RECORDER_TOP_ISLANDS)
+	{
+		return false;
+	}
+	_records.resize(_header.m_numRecords);
+	return static_cast<bool>(file.read(reinterpret_cast<char*>(_records.data()), static_cast<std::streamsize>(_records.size() * sizeof(WP_FrameRecord))));
+}
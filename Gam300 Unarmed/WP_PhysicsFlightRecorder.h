@@ -0,0 +1,111 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//physics updates kept, about five seconds at 60 updates a second
+#ifndef WP_PHYSICS_FLIGHT_RECORDER_FRAMES
+#define WP_PHYSICS_FLIGHT_RECORDER_FRAMES 300
+#endif
+
+//largest contact islands kept per record
+#ifndef WP_PHYSICS_FLIGHT_RECORDER_TOP_ISLANDS
+#define WP_PHYSICS_FLIGHT_RECORDER_TOP_ISLANDS 4
+#endif
+
+//Always on ring of compact per update records of the physics world, dumped to a binary file when
+//a frame spikes or on request, so a hitch can be looked at after the fact.
+//Records are fixed size and trivially copyable, the ring is allocated once and a dump is the file
+//header followed by the records oldest first. The format has no engine or Jolt types so the
+//summary tool in Tools/ builds from this file alone.
+//Main thread only.
+class WP_PhysicsFlightRecorder
+{
+public:
+	static constexpr char		c_Magic[4] = { 'W', 'P', 'F', 'R' };
+	static constexpr uint32_t	c_Version = 1;
+
+	//timed sections of WP_PhysicsSystem::OnUpdate, in order
+	enum class WP_PhysicsPhase : uint8_t
+	{
+		PREPARE,				//streaming, LOD and the transform to physics sync
+		FORCE_FIELDS,			//the force field step listener, taken out of SIMULATION
+		SIMULATION,				//every JPH::PhysicsSystem::Update of the frame
+		PROJECTILES,
+		PUBLISH,				//telemetry, body snapshot, awake set and sensors
+		CALLBACKS,				//contact streams, delayed commands, projectile hits and previews
+		WRITEBACK,				//physics to transform sync
+		NUM_PHASES
+	};
+	static constexpr uint32_t	c_NumPhases = static_cast<uint32_t>(WP_PhysicsPhase::NUM_PHASES);
+	static char const*			GetPhaseName(WP_PhysicsPhase _phase);
+
+	enum class WP_DumpTrigger : uint32_t
+	{
+		MANUAL,
+		HITCH
+	};
+
+	//bodies joined by contacts this update, an approximation of the solver islands that ignores constraints
+	struct WP_IslandRecord
+	{
+		uint32_t	m_numBodies = 0;
+		uint32_t	m_numContacts = 0;			//manifolds, one contact constraint each, summed over the collision steps
+		uint32_t	m_bodyIndex = 0;			//one body of the island, to find it again
+	};
+
+	struct WP_FrameRecord
+	{
+		uint32_t	m_frame = 0;				//physics updates since the recorder was created
+		float		m_frameTime = 0.f;			//seconds, engine delta time that drove this update
+		uint32_t	m_numCollisionSteps = 0;
+		uint32_t	m_numBodies = 0;
+		uint32_t	m_numActiveBodies = 0;
+		uint32_t	m_numBodyPairs = 0;			//busiest collision step
+		uint32_t	m_numContactConstraints = 0;	//busiest collision step
+		uint32_t	m_numContactsAdded = 0;
+		uint32_t	m_numContactsPersisted = 0;
+		uint32_t	m_numContactsRemoved = 0;
+		uint32_t	m_numDelayedCommands = 0;	//setters queued while the world was locked
+		uint32_t	m_tempAllocatorHighWaterMark = 0;
+		std::array<float, c_NumPhases>	m_phaseTimes{};		//milliseconds
+		std::array<WP_IslandRecord, WP_PHYSICS_FLIGHT_RECORDER_TOP_ISLANDS>	m_topIslands{};	//largest first by contacts, unused entries are zero
+
+		float		GetTotalTime() const;		//milliseconds, all phases
+	};
+
+	struct WP_FileHeader
+	{
+		char		m_magic[4];
+		uint32_t	m_version;
+		uint32_t	m_recordSize;				//sizeof(WP_FrameRecord), rejects files from a build with other limits
+		uint32_t	m_numPhases;
+		uint32_t	m_numTopIslands;
+		uint32_t	m_numRecords;
+		WP_DumpTrigger	m_trigger;
+		float		m_hitchThreshold;			//milliseconds, 0 if hitch dumps were off
+	};
+
+	explicit WP_PhysicsFlightRecorder(uint32_t _capacity = WP_PHYSICS_FLIGHT_RECORDER_FRAMES);
+
+	//slot for the next record, overwrites the oldest once the ring is full
+	WP_FrameRecord&			BeginRecord();
+	void					Clear();
+
+	uint32_t				GetNumRecords() const { return m_numRecords; }
+	uint32_t				GetCapacity() const { return static_cast<uint32_t>(m_records.size()); }
+	WP_FrameRecord const&	GetRecord(uint32_t _index) const;	//0 is the oldest
+	WP_FrameRecord const*	GetLatest() const { return m_numRecords ? &GetRecord(m_numRecords - 1) : nullptr; }
+
+	//false if the file could not be written
+	bool					Dump(std::string const& _path, WP_DumpTrigger _trigger, float _hitchThreshold) const;
+	//false if the file is missing, truncated or from another format
+	static bool				Load(std::string const& _path, WP_FileHeader& _header, std::vector<WP_FrameRecord>& _records);
+
+private:
+	std::vector<WP_FrameRecord>		m_records;
+	uint32_t						m_next = 0;			//slot BeginRecord hands out
+	uint32_t						m_numRecords = 0;
+	uint32_t						m_frame = 0;
+};
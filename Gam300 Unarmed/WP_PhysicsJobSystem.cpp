@@ -0,0 +1,54 @@
+#include <WP_EngineSystem/WP_PhysicsJobSystem.h>
+#include <thread>
+
+WP_PhysicsJobSystem::WP_PhysicsJobSystem(JPH::uint _maxJobs, JPH::uint _maxBarriers)
+	: JPH::JobSystemWithBarrier{ _maxBarriers }
+{
+	m_jobs.Init(_maxJobs, _maxJobs);
+}
+
+WP_PhysicsJobSystem::~WP_PhysicsJobSystem()
+{
+	WP_JobSystem::GetInstance()->Wait(m_numQueued);
+}
+
+int WP_PhysicsJobSystem::GetMaxConcurrency() const
+{	//the thread stepping physics helps through the barrier
+	return static_cast<int>(WP_JobSystem::GetInstance()->GetNumWorkers()) + 1;
+}
+
+WP_PhysicsJobSystem::JobHandle WP_PhysicsJobSystem::CreateJob(const char* _name, JPH::ColorArg _color, const JobFunction& _function, JPH::uint32 _numDependencies)
+{
+	JPH::uint32 index;
+	for (;;)
+	{
+		index = m_jobs.ConstructObject(_name, _color, this, _function, _numDependencies);
+		if (index != AvailableJobs::cInvalidObjectIndex) { break; }
+		//all jobs in flight, help with physics jobs only, a long low priority job would stall the step
+		if (!WP_JobSystem::GetInstance()->TryRunJob(WP_JobSystem::WP_JobPriority::HIGH)) { std::this_thread::yield(); }
+	}
+	Job* job = &m_jobs.Get(index);
+	JobHandle handle{ job };	//holds a reference until the caller is done with it
+	if (_numDependencies == 0) { QueueJob(job); }
+	return handle;
+}
+
+void WP_PhysicsJobSystem::QueueJob(Job* _job)
+{
+	_job->AddRef();		//released after it ran
+	WP_JobSystem::GetInstance()->Schedule([_job]()
+		{
+			_job->Execute();
+			_job->Release();
+		}, WP_JobSystem::WP_JobPriority::HIGH, &m_numQueued);
+}
+
+void WP_PhysicsJobSystem::QueueJobs(Job** _jobs, JPH::uint _numJobs)
+{
+	for (JPH::uint i{}; i < _numJobs; ++i) { QueueJob(_jobs[i]); }
+}
+
+void WP_PhysicsJobSystem::FreeJob(Job* _job)
+{
+	m_jobs.DestructObject(_job);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <WP_EngineSystem/WP_JobSystem.h>
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+
+//JPH::JobSystem on top of the engine WP_JobSystem, so physics steps run on the shared engine workers
+//instead of a pool of their own. Jobs live in a fixed free list like in JPH::JobSystemThreadPool,
+//and run as HIGH priority engine jobs once their dependencies are met. Barriers come from
+//JPH::JobSystemWithBarrier, the thread waiting on a barrier helps run its jobs.
+class WP_PhysicsJobSystem final : public JPH::JobSystemWithBarrier
+{
+public:
+	WP_PhysicsJobSystem(JPH::uint _maxJobs, JPH::uint _maxBarriers);
+	~WP_PhysicsJobSystem() override;
+
+	int				GetMaxConcurrency() const override;
+	JobHandle		CreateJob(const char* _name, JPH::ColorArg _color, const JobFunction& _function, JPH::uint32 _numDependencies = 0) override;
+
+protected:
+	void			QueueJob(Job* _job) override;
+	void			QueueJobs(Job** _jobs, JPH::uint _numJobs) override;
+	void			FreeJob(Job* _job) override;
+
+private:
+	using AvailableJobs = JPH::FixedSizeFreeList<Job>;
+	AvailableJobs					m_jobs;
+	WP_JobSystem::WP_JobCounter		m_numQueued;		//jobs handed to the engine, waited on before the free list goes away
+};
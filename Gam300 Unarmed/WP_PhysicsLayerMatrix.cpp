@@ -0,0 +1,197 @@
+#include <WP_EngineSystem/WP_PhysicsLayerMatrix.h>
+#include <WP_EngineSystem/WP_PhysicsSystem.h>
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <sstream>
+
+WP_PhysicsLayerMatrix::WP_PhysicsLayerMatrix()
+{
+	SetDefault();
+}
+
+void WP_PhysicsLayerMatrix::Clear()
+{
+	m_layerMasks.fill(0);
+	m_treeMasks.fill(0);
+	m_sensorLayers = 0;
+	m_passiveLayers = 0;
+	m_layerTree.fill(WP_LayerTree::MOVING);
+	m_layerNames.fill(std::string{});
+	m_numLayers = 0;
+}
+
+void WP_PhysicsLayerMatrix::SetDefault()
+{
+	using namespace Layers;
+	Clear();
+	SetLayer(NON_MOVING,	"NON_MOVING",	WP_LayerTree::NON_MOVING);
+	SetLayer(MOVING,		"MOVING",		WP_LayerTree::MOVING);
+	SetLayer(SENSOR,		"SENSOR",		WP_LayerTree::SENSOR);
+	SetLayer(DEBRIES,		"DEBRIES",		WP_LayerTree::DEBRIES);
+	SetLayer(BULLET,		"BULLET",		WP_LayerTree::BULLET);
+	SetLayer(WEAPON,		"WEAPON",		WP_LayerTree::MOVING);
+
+	//default collision masks, config file layers replace these
+	m_layerMasks[NON_MOVING]	= s_nonMovingLayerMask;
+	m_layerMasks[MOVING]		= s_movingLayerMask;
+	m_layerMasks[SENSOR]		= s_sensorLayerMask;
+	m_layerMasks[DEBRIES]		= s_debriesLayerMask;
+	m_layerMasks[BULLET]		= s_bulletLayerMask;
+	m_layerMasks[WEAPON]		= s_weaponLayerMask;
+	SetPassive(BULLET);			//pure kinematics, see the header
+	Compile();
+}
+
+void WP_PhysicsLayerMatrix::SetLayer(JPH::ObjectLayer _layer, std::string const& _name, WP_LayerTree _tree)
+{
+	assert(_layer < c_MaxLayers && _tree < WP_LayerTree::NUM_TREES);
+	m_layerNames[_layer] = _name;
+	m_layerTree[_layer] = _tree;
+	m_numLayers = std::max(m_numLayers, static_cast<uint32_t>(_layer) + 1);
+}
+
+void WP_PhysicsLayerMatrix::SetCollide(JPH::ObjectLayer _layer1, JPH::ObjectLayer _layer2, bool _collide)
+{
+	assert(_layer1 < c_MaxLayers && _layer2 < c_MaxLayers);
+	if (_collide)
+	{
+		m_layerMasks[_layer1] |= (1u << _layer2);
+		m_layerMasks[_layer2] |= (1u << _layer1);
+	}
+	else
+	{
+		m_layerMasks[_layer1] &= ~(1u << _layer2);
+		m_layerMasks[_layer2] &= ~(1u << _layer1);
+	}
+}
+
+void WP_PhysicsLayerMatrix::SetPassive(JPH::ObjectLayer _layer, bool _isPassive)
+{
+	assert(_layer < c_MaxLayers);
+	if (_isPassive) { m_passiveLayers |= (1u << _layer); }
+	else { m_passiveLayers &= ~(1u << _layer); }
+}
+
+void WP_PhysicsLayerMatrix::Compile()
+{
+	m_sensorLayers = 0;
+	for (uint32_t layer{}; layer < m_numLayers; ++layer)
+	{
+		if (m_layerTree[layer] == WP_LayerTree::SENSOR) { m_sensorLayers |= (1u << layer); }
+	}
+
+	//a layer checks a tree if it collides with any layer stored in that tree
+	for (uint32_t layer{}; layer < c_MaxLayers; ++layer)
+	{
+		bool const isPassive = (m_passiveLayers >> layer) & 1u;
+		m_treeMasks[layer] = isPassive ? 0 : GetTreeMask(m_layerMasks[layer]);
+	}
+}
+
+WP_PhysicsLayerMatrix::WP_TreeMask WP_PhysicsLayerMatrix::GetTreeMask(WP_LayerMask _layers) const
+{
+	WP_TreeMask treeMask{};
+	for (; _layers; _layers &= _layers - 1)
+	{
+		uint32_t const layer = static_cast<uint32_t>(std::countr_zero(_layers));
+		treeMask |= static_cast<WP_TreeMask>(1u << static_cast<uint32_t>(m_layerTree[layer]));
+	}
+	return treeMask;
+}
+
+JPH::ObjectLayer WP_PhysicsLayerMatrix::GetLayer(std::string const& _name) const
+{
+	for (uint32_t layer{}; layer < m_numLayers; ++layer)
+	{
+		if (m_layerNames[layer] == _name) { return static_cast<JPH::ObjectLayer>(layer); }
+	}
+	return JPH::cObjectLayerInvalid;
+}
+
+const char* WP_PhysicsLayerMatrix::GetTreeName(WP_LayerTree _tree)
+{
+	switch (_tree)
+	{
+	case WP_LayerTree::NON_MOVING:	return "NON_MOVING";
+	case WP_LayerTree::MOVING:		return "MOVING";
+	case WP_LayerTree::DEBRIES:		return "DEBRIES";
+	case WP_LayerTree::SENSOR:		return "SENSOR";
+	case WP_LayerTree::BULLET:		return "BULLET";
+	default:						return "INVALID";
+	}
+}
+
+bool WP_PhysicsLayerMatrix::LoadFromFile(std::string const& _path)
+{
+	std::ifstream file{ _path };
+	if (!file.is_open())
+	{
+		WP_INFO("Physics layer config not found, using default layers. WP_PhysicsLayerMatrix::LoadFromFile()");
+		return false;
+	}
+
+	WP_PhysicsLayerMatrix loaded;	//parse into a copy, only replace this matrix if the whole file is valid
+	loaded.Clear();
+
+	std::string line;
+	uint32_t lineNumber{};
+	while (std::getline(file, line))
+	{
+		++lineNumber;
+		line = line.substr(0, line.find('#'));
+		std::istringstream stream{ line };
+		std::string command;
+		if (!(stream >> command)) { continue; }	//empty or comment line
+
+		bool isValid = false;
+		if (command == "layer")
+		{
+			uint32_t index{};
+			std::string name, treeName;
+			if (stream >> index >> name >> treeName && index < c_MaxLayers)
+			{
+				for (uint32_t tree{}; tree < GetNumBroadPhaseLayers(); ++tree)
+				{
+					if (treeName == GetTreeName(static_cast<WP_LayerTree>(tree)))
+					{
+						loaded.SetLayer(static_cast<JPH::ObjectLayer>(index), name, static_cast<WP_LayerTree>(tree));
+						isValid = true;
+						break;
+					}
+				}
+			}
+		}
+		else if (command == "collide")
+		{
+			std::string name1, name2;
+			if (stream >> name1 >> name2)
+			{
+				JPH::ObjectLayer const layer1 = loaded.GetLayer(name1);
+				JPH::ObjectLayer const layer2 = loaded.GetLayer(name2);
+				isValid = layer1 != JPH::cObjectLayerInvalid && layer2 != JPH::cObjectLayerInvalid;
+				if (isValid) { loaded.SetCollide(layer1, layer2); }
+			}
+		}
+		else if (command == "passive")
+		{
+			std::string name;
+			if (stream >> name)
+			{
+				JPH::ObjectLayer const layer = loaded.GetLayer(name);
+				isValid = layer != JPH::cObjectLayerInvalid;
+				if (isValid) { loaded.SetPassive(layer); }
+			}
+		}
+
+		if (!isValid)
+		{
+			WP_ERROR("Invalid physics layer config line %u, using default layers. WP_PhysicsLayerMatrix::LoadFromFile()", lineNumber);
+			return false;
+		}
+	}
+
+	loaded.Compile();
+	*this = loaded;
+	return true;
+}
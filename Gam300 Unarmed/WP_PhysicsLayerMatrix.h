@@ -0,0 +1,93 @@
+#pragma once
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Collision/ObjectLayer.h>
+#include <Jolt/Physics/Collision/BroadPhase/BroadPhaseLayer.h>
+#include <array>
+#include <string>
+
+//Collision layer matrix. Up to 32 object layers, each assigned to one broadphase tree.
+//Which layers collide is stored as one bit mask per layer, the broadphase masks are derived
+//from it in Compile(), so every filter question is a single table lookup.
+//
+//Config file format, one entry per line, '#' starts a comment:
+//	layer <index> <name> <tree>				tree = NON_MOVING | MOVING | DEBRIES | SENSOR | BULLET
+//	collide <layer name> <layer name>		collision is always symmetric
+//	passive <layer name>					never starts a broadphase query, only found by other layers
+//A layer must be declared before it is used by a collide or passive entry.
+//
+//BULLET is passive by default, the same as the original hand written filters: bullets are pure
+//kinematics that query no tree of their own, WEAPON bodies still find them through their query.
+//
+//Triggers on layers in the SENSOR tree are tracked sensors, reported by WP_PhysicsSystem's sensor tracker.
+//The matrix itself treats them like any other layer, the physics system keeps tracked sensor bodies
+//out of the simulation through their collision group.
+class WP_PhysicsLayerMatrix
+{
+public:
+	static constexpr uint32_t	c_MaxLayers = 32;
+	using WP_LayerMask = uint32_t;
+	using WP_TreeMask = uint8_t;
+
+	//broadphase trees, index is the JPH::BroadPhaseLayer value
+	enum class WP_LayerTree : JPH::BroadPhaseLayer::Type
+	{
+		NON_MOVING,		//static geometry
+		MOVING,			//dynamic and kinematic bodies
+		DEBRIES,		//dynamic bodies that do not collide with MOVING
+		SENSOR,			//triggers, kept out of MOVING so dense trigger fields do not inflate it
+		BULLET,			//fast kinematic bodies
+		NUM_TREES
+	};
+
+	WP_PhysicsLayerMatrix();	//default matrix, matches Layers:: masks
+
+	void						SetDefault();
+	//replaces the matrix with the config file. keeps the current matrix and returns false on error.
+	bool						LoadFromFile(std::string const& _path);
+
+	void						SetLayer(JPH::ObjectLayer _layer, std::string const& _name, WP_LayerTree _tree);
+	void						SetCollide(JPH::ObjectLayer _layer1, JPH::ObjectLayer _layer2, bool _collide = true);
+	void						SetPassive(JPH::ObjectLayer _layer, bool _isPassive = true);
+	void						Compile();	//rebuild broadphase masks, call after changing layers
+
+	//used by the jolt layer filters and the queries
+	bool						ShouldCollide(JPH::ObjectLayer _layer1, JPH::ObjectLayer _layer2) const
+	{
+		JPH_ASSERT(_layer1 < c_MaxLayers && _layer2 < c_MaxLayers);
+		return (m_layerMasks[_layer1] >> _layer2) & 1u;
+	}
+	bool						ShouldCollide(JPH::ObjectLayer _layer, JPH::BroadPhaseLayer _tree) const
+	{
+		JPH_ASSERT(_layer < c_MaxLayers);
+		return (m_treeMasks[_layer] >> static_cast<JPH::BroadPhaseLayer::Type>(_tree)) & 1u;
+	}
+	bool						IsTrackedSensorLayer(JPH::ObjectLayer _layer) const
+	{
+		return _layer < c_MaxLayers && ((m_sensorLayers >> _layer) & 1u);
+	}
+	JPH::BroadPhaseLayer		GetBroadPhaseLayer(JPH::ObjectLayer _layer) const
+	{
+		JPH_ASSERT(_layer < m_numLayers);
+		return JPH::BroadPhaseLayer(static_cast<JPH::BroadPhaseLayer::Type>(m_layerTree[_layer]));
+	}
+
+	uint32_t					GetNumLayers() const { return m_numLayers; }
+	WP_LayerMask				GetCollisionMask(JPH::ObjectLayer _layer) const { return m_layerMasks[_layer]; }
+	WP_TreeMask					GetTreeMask(WP_LayerMask _layers) const;	//trees holding any of _layers, bit n = tree n
+	std::string const&			GetLayerName(JPH::ObjectLayer _layer) const { return m_layerNames[_layer]; }
+	JPH::ObjectLayer			GetLayer(std::string const& _name) const;	//JPH::cObjectLayerInvalid if not found
+
+	static constexpr uint32_t	GetNumBroadPhaseLayers() { return static_cast<uint32_t>(WP_LayerTree::NUM_TREES); }
+	static const char*			GetTreeName(WP_LayerTree _tree);
+
+private:
+	void						Clear();
+
+	std::array<WP_LayerMask, c_MaxLayers>			m_layerMasks{};		//bit n set = collides with layer n
+	std::array<WP_TreeMask, c_MaxLayers>			m_treeMasks{};		//bit n set = collides with tree n
+	WP_LayerMask									m_sensorLayers = 0;	//bit n set = layer n is a tracked sensor
+	WP_LayerMask									m_passiveLayers = 0;	//bit n set = layer n checks no tree
+	std::array<WP_LayerTree, c_MaxLayers>			m_layerTree{};
+	std::array<std::string, c_MaxLayers>			m_layerNames{};
+	uint32_t										m_numLayers = 0;	//highest declared layer + 1
+};
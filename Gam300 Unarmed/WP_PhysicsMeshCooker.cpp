@@ -0,0 +1,283 @@
+#include <WP_EngineSystem/WP_PhysicsMeshCooker.h>
+#include <WP_EngineSystem/WP_PhysicsSystem.h>
+#include <Jolt/Core/StreamWrapper.h>
+#include <Jolt/Physics/Collision/Shape/MeshShape.h>
+#include <Jolt/Physics/Collision/Shape/ConvexHullShape.h>
+#include <cassert>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	//bump when the cooking settings change, old cache files are then ignored
+	constexpr uint64_t c_MeshCookVersion = 1;
+	constexpr char const* c_ManifestFileName = "manifest.txt";
+
+	bool ReadWholeFile(std::string const& _path, std::string& _outData)
+	{
+		std::ifstream file{ _path, std::ios::binary | std::ios::ate };
+		if (!file.is_open()) { return false; }
+		_outData.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		return static_cast<bool>(file.read(_outData.data(), static_cast<std::streamsize>(_outData.size())));
+	}
+
+	uint64_t HashContent(std::string_view _data, uint64_t _hash = 0xCBF29CE484222325ull)
+	{	//FNV-1a
+		for (unsigned char c : _data) { _hash = (_hash ^ c) * 0x100000001B3ull; }
+		return _hash;
+	}
+
+	std::string_view NextToken(std::string_view& _line)
+	{
+		size_t const begin = _line.find_first_not_of(" \t\r");
+		if (begin == std::string_view::npos) { _line = {}; return {}; }
+		size_t const end = _line.find_first_of(" \t\r", begin);
+		std::string_view const token = _line.substr(begin, end - begin);
+		_line = (end == std::string_view::npos) ? std::string_view{} : _line.substr(end);
+		return token;
+	}
+
+	template <typename T>
+	bool ParseNumber(std::string_view _token, T& _out)
+	{
+		return !_token.empty() && std::from_chars(_token.data(), _token.data() + _token.size(), _out).ec == std::errc{};
+	}
+}
+
+bool WP_PhysicsMeshCooker::LoadObj([[maybe_unused]] std::string const& _path, std::string_view _fileData, WP_MeshData& _outMesh)
+{
+	_outMesh.m_vertices.clear();
+	_outMesh.m_indices.clear();
+	std::vector<uint32_t> face;
+	while (!_fileData.empty())
+	{
+		size_t const lineEnd = _fileData.find('\n');
+		std::string_view line = _fileData.substr(0, lineEnd);
+		_fileData = (lineEnd == std::string_view::npos) ? std::string_view{} : _fileData.substr(lineEnd + 1);
+
+		std::string_view const command = NextToken(line);
+		if (command == "v")
+		{
+			JPH::Float3 vertex;
+			if (!ParseNumber(NextToken(line), vertex.x) || !ParseNumber(NextToken(line), vertex.y) || !ParseNumber(NextToken(line), vertex.z))
+			{
+				return false;
+			}
+			_outMesh.m_vertices.push_back(vertex);
+		}
+		else if (command == "f")
+		{	//"f v/vt/vn ...", only the position index is used. polygons are fanned into triangles
+			face.clear();
+			for (std::string_view token = NextToken(line); !token.empty(); token = NextToken(line))
+			{
+				token = token.substr(0, token.find('/'));
+				int index{};
+				if (!ParseNumber(token, index) || index == 0) { return false; }
+				index = (index < 0) ? static_cast<int>(_outMesh.m_vertices.size()) + index : index - 1;	//negative is relative
+				if (index < 0 || index >= static_cast<int>(_outMesh.m_vertices.size())) { return false; }
+				face.push_back(static_cast<uint32_t>(index));
+			}
+			for (size_t i = 2; i < face.size(); ++i)
+			{
+				_outMesh.m_indices.insert(_outMesh.m_indices.end(), { face[0], face[i - 1], face[i] });
+			}
+		}
+	}
+	return !_outMesh.m_vertices.empty();
+}
+
+void WP_PhysicsMeshCooker::SetMeshLoader(WP_MeshLoader _loader, std::string const& _tag)
+{
+	assert(!_tag.empty() && _tag.find_first_of(" \t\r\n") == std::string::npos);	//stored in the manifest
+	m_loader = std::move(_loader);
+	m_loaderTag = _tag;
+	ClearLoadedShapes();	//shapes from the old loader are keyed by its tag
+}
+
+void WP_PhysicsMeshCooker::SetCacheDirectory(std::string const& _directory)
+{
+	m_cacheDirectory = _directory;
+	m_manifest.clear();
+	m_isManifestLoaded = false;
+}
+
+JPH::RefConst<JPH::Shape> WP_PhysicsMeshCooker::GetShape(std::string const& _path, WP_CookType _type)
+{
+	std::string const key = _path + (_type == WP_CookType::MESH ? "#mesh#" : "#hull#") + m_loaderTag;
+	if (auto iter = m_loadedShapes.find(key); iter != m_loadedShapes.end()) { return iter->second; }
+
+	std::error_code error;
+	uint64_t const size = static_cast<uint64_t>(std::filesystem::file_size(_path, error));
+	int64_t const writeTime = error ? 0 : static_cast<int64_t>(std::filesystem::last_write_time(_path, error).time_since_epoch().count());
+	if (error)
+	{
+		WP_ERROR("Failed to read collision mesh %s. WP_PhysicsMeshCooker::GetShape()", _path.c_str());
+		return nullptr;
+	}
+
+	//unchanged since it was hashed, the cooked file is used without reading the source
+	if (!m_isManifestLoaded) { LoadManifest(); }
+	JPH::RefConst<JPH::Shape> shape;
+	uint64_t hash{};
+	if (auto iter = m_manifest.find(key); iter != m_manifest.end() && iter->second.m_size == size && iter->second.m_writeTime == writeTime)
+	{
+		hash = iter->second.m_hash;
+		shape = LoadCooked(GetCachePath(hash));
+	}
+	if (shape)
+	{
+		m_loadedShapes.emplace(key, shape);
+		m_contentHashes[shape.GetPtr()] = hash;
+		return shape;
+	}
+
+	std::string source;
+	if (!ReadWholeFile(_path, source))
+	{
+		WP_ERROR("Failed to read collision mesh %s. WP_PhysicsMeshCooker::GetShape()", _path.c_str());
+		return nullptr;
+	}
+
+	hash = HashContent(source);
+	hash = HashContent(std::string_view{ reinterpret_cast<char const*>(&_type), sizeof(_type) }, hash);
+	hash = HashContent(std::string_view{ reinterpret_cast<char const*>(&c_MeshCookVersion), sizeof(c_MeshCookVersion) }, hash);
+	hash = HashContent(m_loaderTag, hash);
+	std::string const cachePath = GetCachePath(hash);
+
+	//touched but not changed, or cooked under another path
+	shape = LoadCooked(cachePath);
+	if (!shape)
+	{
+		shape = Cook(_path, source, _type);
+		if (!shape) { return nullptr; }
+
+		std::filesystem::create_directories(m_cacheDirectory, error);
+		std::ofstream file{ cachePath, std::ios::binary | std::ios::trunc };
+		JPH::StreamOutWrapper stream{ file };
+		JPH::Shape::ShapeToIDMap shapeMap;
+		JPH::Shape::MaterialToIDMap materialMap;
+		shape->SaveWithChildren(stream, shapeMap, materialMap);
+		if (!file.is_open() || stream.IsFailed())
+		{	//still usable this run, it is just cooked again next time
+			WP_WARN("Failed to write cooked collision mesh for %s. WP_PhysicsMeshCooker::GetShape()", _path.c_str());
+		}
+	}
+	m_manifest[key] = WP_ManifestEntry{ size, writeTime, hash };
+	SaveManifest();
+
+	m_loadedShapes.emplace(key, shape);
+	m_contentHashes[shape.GetPtr()] = hash;
+	return shape;
+}
+
+std::string WP_PhysicsMeshCooker::GetCachePath(uint64_t _hash) const
+{
+	char fileName[32];
+	std::snprintf(fileName, sizeof(fileName), "%016llx.jphshape", static_cast<unsigned long long>(_hash));
+	return (std::filesystem::path{ m_cacheDirectory } / fileName).string();
+}
+
+JPH::RefConst<JPH::Shape> WP_PhysicsMeshCooker::LoadCooked(std::string const& _cachePath) const
+{
+	std::string cooked;
+	if (!ReadWholeFile(_cachePath, cooked)) { return nullptr; }
+	std::istringstream data{ std::move(cooked) };
+	JPH::StreamInWrapper stream{ data };
+	JPH::Shape::IDToShapeMap shapeMap;
+	JPH::Shape::IDToMaterialMap materialMap;
+	JPH::Shape::ShapeResult result = JPH::Shape::sRestoreWithChildren(stream, shapeMap, materialMap);
+	if (!result.IsValid())
+	{
+		WP_WARN("Corrupt cooked collision mesh %s, recooking. WP_PhysicsMeshCooker::LoadCooked()", _cachePath.c_str());
+		return nullptr;
+	}
+	return result.Get();
+}
+
+//one entry per line: <hash> <size> <write time> <key>, the key is last as paths may hold spaces
+void WP_PhysicsMeshCooker::LoadManifest()
+{
+	m_isManifestLoaded = true;
+	m_manifest.clear();
+	std::ifstream file{ std::filesystem::path{ m_cacheDirectory } / c_ManifestFileName };
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream stream{ line };
+		WP_ManifestEntry entry;
+		std::string key;
+		if (!(stream >> std::hex >> entry.m_hash >> std::dec >> entry.m_size >> entry.m_writeTime)) { continue; }
+		stream >> std::ws;
+		if (!std::getline(stream, key) || key.empty()) { continue; }
+		m_manifest[key] = entry;
+	}
+}
+
+void WP_PhysicsMeshCooker::SaveManifest() const
+{
+	std::error_code error;
+	std::filesystem::create_directories(m_cacheDirectory, error);
+	std::ofstream file{ std::filesystem::path{ m_cacheDirectory } / c_ManifestFileName, std::ios::trunc };
+	for (auto const& [key, entry] : m_manifest)
+	{
+		file << std::hex << entry.m_hash << std::dec << ' ' << entry.m_size << ' ' << entry.m_writeTime << ' ' << key << '\n';
+	}
+	if (!file)
+	{	//only costs a source read and hash next run
+		WP_WARN("Failed to write collision mesh manifest. WP_PhysicsMeshCooker::SaveManifest()");
+	}
+}
+
+uint64_t WP_PhysicsMeshCooker::GetContentHash(JPH::Shape const* _shape) const
+{
+	auto iter = m_contentHashes.find(_shape);
+	return (iter != m_contentHashes.end()) ? iter->second : 0;
+}
+
+JPH::RefConst<JPH::Shape> WP_PhysicsMeshCooker::Cook(std::string const& _path, std::string_view _fileData, WP_CookType _type) const
+{
+	WP_MeshData mesh;
+	bool const isLoaded = m_loader ? m_loader(_path, _fileData, mesh) : LoadObj(_path, _fileData, mesh);
+	if (!isLoaded)
+	{
+		WP_ERROR("Failed to load collision mesh %s. WP_PhysicsMeshCooker::Cook()", _path.c_str());
+		return nullptr;
+	}
+
+	JPH::Shape::ShapeResult result;
+	if (_type == WP_CookType::CONVEX_HULL)
+	{
+		JPH::Array<JPH::Vec3> points;
+		points.reserve(mesh.m_vertices.size());
+		for (JPH::Float3 const& vertex : mesh.m_vertices) { points.push_back(JPH::Vec3(vertex)); }
+		result = JPH::ConvexHullShapeSettings{ points }.Create();
+	}
+	else
+	{
+		if (mesh.m_indices.size() < 3 || mesh.m_indices.size() % 3)
+		{
+			WP_ERROR("Collision mesh %s has no triangles. WP_PhysicsMeshCooker::Cook()", _path.c_str());
+			return nullptr;
+		}
+		JPH::VertexList vertices{ mesh.m_vertices.begin(), mesh.m_vertices.end() };
+		JPH::IndexedTriangleList triangles;
+		triangles.reserve(mesh.m_indices.size() / 3);
+		for (size_t i{}; i < mesh.m_indices.size(); i += 3)
+		{
+			triangles.push_back(JPH::IndexedTriangle{ mesh.m_indices[i], mesh.m_indices[i + 1], mesh.m_indices[i + 2] });
+		}
+		result = JPH::MeshShapeSettings{ std::move(vertices), std::move(triangles) }.Create();
+	}
+
+	if (!result.IsValid())
+	{
+		WP_ERROR("Failed to cook collision mesh %s: %s. WP_PhysicsMeshCooker::Cook()", _path.c_str(), result.GetError().c_str());
+		return nullptr;
+	}
+	WP_INFO("Cooked collision mesh %s. WP_PhysicsMeshCooker::Cook()", _path.c_str());
+	return result.Get();
+}
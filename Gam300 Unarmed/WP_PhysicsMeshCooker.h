@@ -0,0 +1,76 @@
+#pragma once
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//cooked collision shapes are stored here, one file per source content hash, plus a manifest
+#ifndef WP_PHYSICS_MESH_CACHE_DIRECTORY
+#define WP_PHYSICS_MESH_CACHE_DIRECTORY "Assets/Cache/Physics"
+#endif
+
+//Cooks render meshes into Jolt MeshShape / ConvexHullShape colliders.
+//A cooked shape is saved with Jolt's binary shape format under the hash of the source file's
+//content, so each asset is cooked once. A manifest in the cache directory remembers the size and
+//write time each source had when it was hashed: while those match, later runs only read the
+//cooked file and never read or hash the source. The loader tag is part of every key, installing
+//a different loader cooks again. Shapes are also kept in memory by path, every collider using an
+//asset shares one shape across scene loads.
+//Main thread only.
+class WP_PhysicsMeshCooker
+{
+public:
+	enum class WP_CookType : uint8_t
+	{
+		MESH,			//exact triangles, static and kinematic bodies only
+		CONVEX_HULL		//hull of the vertices, any motion type
+	};
+
+	struct WP_MeshData
+	{
+		std::vector<JPH::Float3>	m_vertices;
+		std::vector<uint32_t>		m_indices;		//3 per triangle, not used for hulls
+	};
+
+	//parses _fileData (the whole source file) into _outMesh. Wavefront .obj is built in,
+	//the renderer can install a loader for its own mesh formats.
+	using WP_MeshLoader = std::function<bool(std::string const& _path, std::string_view _fileData, WP_MeshData& _outMesh)>;
+
+	//_tag names the loader and its version, change it whenever the loader output changes
+	void						SetMeshLoader(WP_MeshLoader _loader, std::string const& _tag);
+	void						SetCacheDirectory(std::string const& _directory);
+
+	//nullptr if the asset can not be read or cooked
+	JPH::RefConst<JPH::Shape>	GetShape(std::string const& _path, WP_CookType _type);
+	void						ClearLoadedShapes() { m_loadedShapes.clear(); m_contentHashes.clear(); }	//disk cache is kept
+	//hash of the source file a shape from GetShape was cooked from, 0 for any other shape
+	uint64_t					GetContentHash(JPH::Shape const* _shape) const;
+
+	static bool					LoadObj(std::string const& _path, std::string_view _fileData, WP_MeshData& _outMesh);
+
+private:
+	//source file state when its content was hashed
+	struct WP_ManifestEntry
+	{
+		uint64_t	m_size = 0;
+		int64_t		m_writeTime = 0;
+		uint64_t	m_hash = 0;
+	};
+
+	JPH::RefConst<JPH::Shape>	Cook(std::string const& _path, std::string_view _fileData, WP_CookType _type) const;
+	JPH::RefConst<JPH::Shape>	LoadCooked(std::string const& _cachePath) const;	//nullptr if missing or corrupt
+	std::string					GetCachePath(uint64_t _hash) const;
+	void						LoadManifest();
+	void						SaveManifest() const;
+
+	WP_MeshLoader											m_loader;
+	std::string												m_loaderTag{ "obj" };
+	std::string												m_cacheDirectory{ WP_PHYSICS_MESH_CACHE_DIRECTORY };
+	std::unordered_map<std::string, WP_ManifestEntry>		m_manifest;			//path, cook type and loader tag to source state
+	bool													m_isManifestLoaded = false;
+	std::unordered_map<std::string, JPH::RefConst<JPH::Shape>>	m_loadedShapes;		//path and cook type to shape
+	std::unordered_map<JPH::Shape const*, uint64_t>				m_contentHashes;	//loaded shape to its cook hash
+};
@@ -0,0 +1,123 @@
+#include <WP_EngineSystem/WP_PhysicsPairFilter.h>
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+WP_PhysicsPairFilter::WP_PhysicsPairFilter(uint32_t _capacity)
+{
+	Rehash(std::bit_ceil(std::max(_capacity, 16u)));
+}
+
+uint64_t WP_PhysicsPairFilter::MakeKey(JPH::BodyID _body1, JPH::BodyID _body2)
+{	//order independent
+	uint64_t const a = _body1.GetIndexAndSequenceNumber();
+	uint64_t const b = _body2.GetIndexAndSequenceNumber();
+	return (a < b) ? (a << 32 | b) : (b << 32 | a);
+}
+
+uint32_t WP_PhysicsPairFilter::Hash(uint64_t _key)
+{	//splitmix64 finalizer, body ids are sequential so the low bits need mixing
+	_key ^= _key >> 30;
+	_key *= 0xbf58476d1ce4e5b9ull;
+	_key ^= _key >> 27;
+	_key *= 0x94d049bb133111ebull;
+	_key ^= _key >> 31;
+	return static_cast<uint32_t>(_key);
+}
+
+bool WP_PhysicsPairFilter::Contains(JPH::BodyID _body1, JPH::BodyID _body2) const
+{
+	uint64_t const key = MakeKey(_body1, _body2);
+	for (uint32_t slot = Hash(key) & m_mask;; slot = (slot + 1) & m_mask)
+	{
+		uint64_t const value = m_slots[slot].load(std::memory_order_acquire);
+		if (value == key) { return true; }
+		if (value == c_EmptySlot) { return false; }
+	}
+}
+
+bool WP_PhysicsPairFilter::Add(JPH::BodyID _body1, JPH::BodyID _body2)
+{
+	if (_body1.IsInvalid() || _body2.IsInvalid() || _body1 == _body2) { return false; }
+	if (Contains(_body1, _body2)) { return false; }
+	uint32_t const capacity = m_mask + 1;
+	if ((GetSize() + m_numRemoved + 1) * 4 > capacity * 3)
+	{	//grow only if live pairs fill the table, otherwise clearing the tombstones is enough
+		Rehash(((GetSize() + 1) * 2 > capacity) ? capacity * 2 : capacity);
+	}
+	uint64_t const key = MakeKey(_body1, _body2);
+	for (uint32_t slot = Hash(key) & m_mask;; slot = (slot + 1) & m_mask)
+	{
+		uint64_t const value = m_slots[slot].load(std::memory_order_relaxed);
+		if (value != c_EmptySlot && value != c_RemovedSlot) { continue; }
+		if (value == c_RemovedSlot) { --m_numRemoved; }
+		m_slots[slot].store(key, std::memory_order_release);
+		m_size.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+}
+
+bool WP_PhysicsPairFilter::Remove(JPH::BodyID _body1, JPH::BodyID _body2)
+{
+	uint64_t const key = MakeKey(_body1, _body2);
+	for (uint32_t slot = Hash(key) & m_mask;; slot = (slot + 1) & m_mask)
+	{
+		uint64_t const value = m_slots[slot].load(std::memory_order_relaxed);
+		if (value == c_EmptySlot) { return false; }
+		if (value != key) { continue; }
+		m_slots[slot].store(c_RemovedSlot, std::memory_order_release);
+		m_size.fetch_sub(1, std::memory_order_relaxed);
+		++m_numRemoved;
+		return true;
+	}
+}
+
+void WP_PhysicsPairFilter::RemoveBody(JPH::BodyID _body)
+{
+	if (IsEmpty()) { return; }
+	uint64_t const id = _body.GetIndexAndSequenceNumber();
+	for (uint32_t slot{}; slot <= m_mask; ++slot)
+	{
+		uint64_t const value = m_slots[slot].load(std::memory_order_relaxed);
+		if (value == c_EmptySlot || value == c_RemovedSlot) { continue; }
+		if ((value >> 32) != id && (value & 0xffffffffull) != id) { continue; }
+		m_slots[slot].store(c_RemovedSlot, std::memory_order_release);
+		m_size.fetch_sub(1, std::memory_order_relaxed);
+		++m_numRemoved;
+	}
+}
+
+void WP_PhysicsPairFilter::Clear()
+{
+	for (uint32_t slot{}; slot <= m_mask; ++slot)
+	{
+		m_slots[slot].store(c_EmptySlot, std::memory_order_relaxed);
+	}
+	m_size.store(0, std::memory_order_release);
+	m_numRemoved = 0;
+}
+
+void WP_PhysicsPairFilter::Rehash(uint32_t _capacity)
+{
+	assert(std::has_single_bit(_capacity));
+	std::unique_ptr<std::atomic<uint64_t>[]> previous = std::move(m_slots);
+	uint32_t const previousCapacity = previous ? m_mask + 1 : 0;
+	m_slots = std::make_unique<std::atomic<uint64_t>[]>(_capacity);
+	m_mask = _capacity - 1;
+	for (uint32_t slot{}; slot < _capacity; ++slot)
+	{
+		m_slots[slot].store(c_EmptySlot, std::memory_order_relaxed);
+	}
+	m_numRemoved = 0;
+
+	//reinsert the live keys, tombstones are dropped
+	for (uint32_t slot{}; slot < previousCapacity; ++slot)
+	{
+		uint64_t const key = previous[slot].load(std::memory_order_relaxed);
+		if (key == c_EmptySlot || key == c_RemovedSlot) { continue; }
+		uint32_t target = Hash(key) & m_mask;
+		while (m_slots[target].load(std::memory_order_relaxed) != c_EmptySlot) { target = (target + 1) & m_mask; }
+		m_slots[target].store(key, std::memory_order_relaxed);
+	}
+	std::atomic_thread_fence(std::memory_order_release);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Body/BodyID.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+//starting number of slots of the ignored pair set, doubles when three quarters full
+#ifndef WP_PHYSICS_PAIR_FILTER_CAPACITY
+#define WP_PHYSICS_PAIR_FILTER_CAPACITY 1024
+#endif
+
+//Open addressing hash set of body pairs whose contacts are rejected in OnContactValidate.
+//Keys are the two body ids (index and sequence number), so a destroyed body's pairs never match
+//the body that reuses its index. Contains is lock free and is called from the physics jobs,
+//Add / Remove / Clear are main thread only and must not run during a physics update.
+class WP_PhysicsPairFilter
+{
+public:
+	explicit WP_PhysicsPairFilter(uint32_t _capacity = WP_PHYSICS_PAIR_FILTER_CAPACITY);
+
+	WP_PhysicsPairFilter(WP_PhysicsPairFilter const&) = delete;
+	WP_PhysicsPairFilter& operator=(WP_PhysicsPairFilter const&) = delete;
+
+	bool		Add(JPH::BodyID _body1, JPH::BodyID _body2);		//false if already in the set or invalid
+	bool		Remove(JPH::BodyID _body1, JPH::BodyID _body2);		//false if not in the set
+	void		RemoveBody(JPH::BodyID _body);						//every pair of _body, walks the whole table
+	void		Clear();
+	bool		Contains(JPH::BodyID _body1, JPH::BodyID _body2) const;
+
+	uint32_t	GetSize() const { return m_size.load(std::memory_order_relaxed); }
+	bool		IsEmpty() const { return GetSize() == 0; }
+	uint32_t	GetCapacity() const { return m_mask + 1; }
+
+private:
+	static constexpr uint64_t	c_EmptySlot = 0;			//a valid pair key is never 0, the larger id is not 0
+	static constexpr uint64_t	c_RemovedSlot = ~0ull;		//tombstone, probing continues past it
+
+	static uint64_t	MakeKey(JPH::BodyID _body1, JPH::BodyID _body2);
+	static uint32_t	Hash(uint64_t _key);
+	void			Rehash(uint32_t _capacity);
+
+	std::unique_ptr<std::atomic<uint64_t>[]>	m_slots;
+	uint32_t									m_mask = 0;				//capacity - 1, capacity is a power of two
+	std::atomic<uint32_t>						m_size{ 0 };
+	uint32_t									m_numRemoved = 0;		//tombstones, count towards the load
+};
@@ -0,0 +1,321 @@
+#include <WP_EngineSystem/WP_PhysicsPrediction.h>
+#include <WP_EngineSystem/WP_PhysicsSystem.h>
+#include <Jolt/Physics/Body/BodyLock.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	//samples of the ballistic arc used to bound the statics to clone
+	constexpr uint32_t c_NumBoundSamples = 16;
+}
+
+WP_PhysicsPrediction::WP_PhysicsPrediction()
+{/*Empty by Design*/ }
+
+WP_PhysicsPrediction::~WP_PhysicsPrediction()
+{
+	assert(!m_isRunning && "Prediction job still running, call Clear() before the job system stops. WP_PhysicsPrediction::~WP_PhysicsPrediction()");
+}
+
+void WP_PhysicsPrediction::Init(JPH::BroadPhaseLayerInterface const& _bpLayers, JPH::ObjectVsBroadPhaseLayerFilter const& _objectVsBPFilter,
+	JPH::ObjectLayerPairFilter const& _objectPairFilter)
+{
+	m_world = std::make_unique<JPH::PhysicsSystem>();
+	m_world->Init(WP_PHYSICS_PREDICTION_MAX_BODIES, 0, WP_PHYSICS_PREDICTION_MAX_BODIES, WP_PHYSICS_PREDICTION_MAX_BODIES,
+		_bpLayers, _objectVsBPFilter, _objectPairFilter);
+	m_world->SetContactListener(&m_contactListener);
+}
+
+WP_PhysicsPrediction::WP_TrajectoryID WP_PhysicsPrediction::Request(WP_TrajectorySettings const& _settings)
+{
+	assert(m_world && "Prediction world not initialised. WP_PhysicsPrediction::Request()");
+	WP_TrajectoryID const id = m_nextID++;
+	m_requests.emplace_back(id, _settings);
+	WP_TrajectorySettings& settings = m_requests.back().second;
+	settings.m_layer = (settings.m_layer == JPH::cObjectLayerInvalid) ? Layers::MOVING : settings.m_layer;
+	settings.m_stepsPerPoint = std::max(settings.m_stepsPerPoint, 1u);
+	m_pending.insert(id);
+	return id;
+}
+
+WP_PhysicsPrediction::WP_Trajectory const* WP_PhysicsPrediction::GetTrajectory(WP_TrajectoryID _trajectory) const
+{
+	auto iter = m_results.find(_trajectory);
+	return (iter != m_results.end()) ? &iter->second.m_trajectory : nullptr;
+}
+
+bool WP_PhysicsPrediction::GetIsPending(WP_TrajectoryID _trajectory) const
+{
+	return m_pending.contains(_trajectory);
+}
+
+void WP_PhysicsPrediction::Release(WP_TrajectoryID _trajectory)
+{
+	m_results.erase(_trajectory);
+	//a running job still simulates it, Publish drops results that are no longer pending
+	m_pending.erase(_trajectory);
+	std::erase_if(m_requests, [_trajectory](auto const& _request) { return _request.first == _trajectory; });
+}
+
+void WP_PhysicsPrediction::Clear()
+{
+	if (m_isRunning)
+	{
+		WP_JobSystem::GetInstance()->Wait(m_counter);
+		m_isRunning = false;
+	}
+	m_requests.clear();
+	m_pending.clear();
+	m_jobs.clear();
+	m_statics.clear();
+	m_results.clear();
+	DestroyClones();
+}
+
+void WP_PhysicsPrediction::Update(JPH::PhysicsSystem const& _world, float _fixedDeltaTime)
+{
+	++m_frame;
+	std::erase_if(m_results, [this](auto const& _result) { return m_frame - _result.second.m_frame > WP_PHYSICS_PREDICTION_RESULT_FRAMES; });
+
+	if (m_isRunning)
+	{	//never wait, the batch is published by a later update
+		if (!m_counter.IsDone()) { return; }
+		m_isRunning = false;
+		Publish(_world);
+	}
+	if (m_requests.empty()) { return; }
+
+	//the main world is at rest between updates, copy out what the job needs
+	m_deltaTime = _fixedDeltaTime;
+	m_gravity = _world.GetGravity();
+	m_jobs.resize(m_requests.size());
+	m_statics.clear();
+	for (uint32_t i{}; i < m_requests.size(); ++i)
+	{
+		WP_PredictionJob& job = m_jobs[i];
+		job.m_settings = std::move(m_requests[i].second);
+		job.m_result = WP_Trajectory{};
+		job.m_result.m_id = m_requests[i].first;
+		job.m_hitSource = JPH::BodyID{};
+		job.m_hitSubShape = JPH::SubShapeID{};
+		SnapshotStatics(_world, job);
+	}
+	m_requests.clear();
+
+	m_isRunning = true;
+	WP_JobSystem::GetInstance()->Schedule([this]() { RunJobs(); }, WP_JobSystem::WP_JobPriority::LOW, &m_counter);
+}
+
+void WP_PhysicsPrediction::Publish(JPH::PhysicsSystem const& _world)
+{
+	if (m_isWorldFull)
+	{
+		WP_WARN("Prediction world is full, some statics were not cloned. Raise WP_PHYSICS_PREDICTION_MAX_BODIES. WP_PhysicsPrediction::Publish()");
+		m_isWorldFull = false;
+	}
+	WP_PhysicsSystem const* const physicsSystem = WP_PhysicsSystem::GetInstance();
+	for (WP_PredictionJob& job : m_jobs)
+	{
+		WP_TrajectoryID const id = job.m_result.m_id;
+		if (m_pending.erase(id) == 0) { continue; }	//released while running
+		//the static may be gone and its index reused since the snapshot, IsAdded checks the sequence number
+		if (job.m_result.m_landing.m_isHit && _world.GetBodyInterface().IsAdded(job.m_hitSource))
+		{
+			job.m_result.m_landing.m_hitObject = physicsSystem->GetIDfromSubShape(job.m_hitSource, job.m_hitSubShape);
+		}
+		WP_TrajectoryCallback const callback = std::move(job.m_settings.m_callback);
+		auto [iter, isAdded] = m_results.insert_or_assign(id, WP_PublishedTrajectory{ std::move(job.m_result), m_frame });
+		if (callback) { callback(iter->second.m_trajectory); }
+	}
+	m_jobs.clear();
+	m_statics.clear();
+}
+
+void WP_PhysicsPrediction::SnapshotStatics(JPH::PhysicsSystem const& _world, WP_PredictionJob& _job)
+{
+	using namespace WP_Physics;
+	WP_TrajectorySettings const& settings = _job.m_settings;
+
+	//bound the arc the body would fly without hitting anything, the margin covers bounces and rolling
+	float const duration = static_cast<float>(settings.m_numSteps) * m_deltaTime;
+	JPH::Vec3 const start = ToJoltVec3(settings.m_position);
+	JPH::Vec3 const velocity = ToJoltVec3(settings.m_velocity);
+	JPH::Vec3 const acceleration = m_gravity * settings.m_gravityFactor;
+	JPH::AABox bounds{ start, start };
+	for (uint32_t sample = 1; sample <= c_NumBoundSamples; ++sample)
+	{
+		float const time = duration * static_cast<float>(sample) / static_cast<float>(c_NumBoundSamples);
+		bounds.Encapsulate(start + velocity * time + acceleration * (0.5f * time * time));
+	}
+	float const bodyExtent = settings.m_shape ? settings.m_shape->GetLocalBounds().GetExtent().ReduceMax() * 2.f : settings.m_radius;
+	bounds.ExpandBy(JPH::Vec3::sReplicate(bodyExtent + settings.m_searchMargin));
+
+	JPH::AllHitCollisionCollector<JPH::CollideShapeBodyCollector> collector;
+	_world.GetBroadPhaseQuery().CollideAABox(bounds, collector,
+		_world.GetDefaultBroadPhaseLayerFilter(settings.m_layer), _world.GetDefaultLayerFilter(settings.m_layer));
+
+	JPH::BodyLockInterface const& lockInterface = _world.GetBodyLockInterface();
+	for (JPH::BodyID const bID : collector.mHits)
+	{
+		JPH::BodyLockRead lock{ lockInterface, bID };
+		if (!lock.Succeeded()) { continue; }
+		JPH::Body const& body = lock.GetBody();
+		if (!body.IsStatic() || body.IsSensor()) { continue; }	//only level geometry is cloned
+		m_statics.push_back(WP_StaticSnapshot{ bID, body.GetShape(), body.GetPosition(), body.GetRotation(),
+			body.GetObjectLayer(), body.GetFriction(), body.GetRestitution() });
+	}
+}
+
+void WP_PhysicsPrediction::RunJobs()
+{
+	m_world->SetGravity(m_gravity);
+	SyncClones();
+	for (WP_PredictionJob& job : m_jobs)
+	{
+		Simulate(job);
+	}
+}
+
+void WP_PhysicsPrediction::SyncClones()
+{
+	JPH::BodyInterface& bi = m_world->GetBodyInterfaceNoLock();	//only this job touches the prediction world
+	uint32_t const stamp = ++m_cloneStamp;
+	bool isAdded = false;
+	for (WP_StaticSnapshot const& snapshot : m_statics)
+	{
+		uint64_t const key = snapshot.m_source.GetIndexAndSequenceNumber();
+		auto iter = m_clones.find(key);
+		if (iter != m_clones.end())
+		{
+			WP_Clone& clone = iter->second;
+			if (clone.m_stamp == stamp) { continue; }	//already synced for another job of this batch
+			clone.m_stamp = stamp;
+			if (bi.GetShape(clone.m_body) != snapshot.m_shape)
+			{
+				bi.SetShape(clone.m_body, snapshot.m_shape, false, JPH::EActivation::DontActivate);
+			}
+			JPH::RVec3 position;
+			JPH::Quat rotation;
+			bi.GetPositionAndRotation(clone.m_body, position, rotation);
+			if (position != snapshot.m_position || rotation != snapshot.m_rotation)
+			{
+				bi.SetPositionAndRotation(clone.m_body, snapshot.m_position, snapshot.m_rotation, JPH::EActivation::DontActivate);
+			}
+			continue;
+		}
+		JPH::BodyCreationSettings settings{ snapshot.m_shape, snapshot.m_position, snapshot.m_rotation, JPH::EMotionType::Static, snapshot.m_layer };
+		settings.mFriction = snapshot.m_friction;
+		settings.mRestitution = snapshot.m_restitution;
+		settings.mUserData = key;
+		JPH::BodyID const cloneID = bi.CreateAndAddBody(settings, JPH::EActivation::DontActivate);
+		if (cloneID.IsInvalid())
+		{
+			m_isWorldFull = true;
+			continue;
+		}
+		m_clones.emplace(key, WP_Clone{ cloneID, stamp });
+		isAdded = true;
+	}
+
+	//statics that left the area or the main world
+	std::vector<JPH::BodyID> stale;
+	for (auto iter = m_clones.begin(); iter != m_clones.end();)
+	{
+		if (iter->second.m_stamp == stamp) { ++iter; continue; }
+		stale.push_back(iter->second.m_body);
+		iter = m_clones.erase(iter);
+	}
+	if (!stale.empty())
+	{
+		bi.RemoveBodies(stale.data(), static_cast<int>(stale.size()));
+		bi.DestroyBodies(stale.data(), static_cast<int>(stale.size()));
+	}
+	if (isAdded) { m_world->OptimizeBroadPhase(); }
+}
+
+void WP_PhysicsPrediction::Simulate(WP_PredictionJob& _job)
+{
+	using namespace WP_Physics;
+	WP_TrajectorySettings const& settings = _job.m_settings;
+	WP_Trajectory& result = _job.m_result;
+	result.m_points.push_back(settings.m_position);
+
+	JPH::RefConst<JPH::Shape> shape = settings.m_shape;
+	if (!shape) { shape = new JPH::SphereShape(settings.m_radius); }
+	JPH::BodyCreationSettings bodySettings{ shape, ToJoltVec3(settings.m_position), ToJoltQuat(settings.m_rotation), JPH::EMotionType::Dynamic, settings.m_layer };
+	bodySettings.mLinearVelocity = ToJoltVec3(settings.m_velocity);
+	bodySettings.mAngularVelocity = ToJoltVec3(settings.m_angularVelocity);
+	bodySettings.mGravityFactor = settings.m_gravityFactor;
+	bodySettings.mFriction = settings.m_friction;
+	bodySettings.mRestitution = settings.m_restitution;
+	bodySettings.mMotionQuality = JPH::EMotionQuality::LinearCast;	//throws are fast and small
+	bodySettings.mAllowSleeping = false;
+	JPH::BodyInterface& bi = m_world->GetBodyInterfaceNoLock();
+	JPH::BodyID const bID = bi.CreateAndAddBody(bodySettings, JPH::EActivation::Activate);
+	if (bID.IsInvalid())
+	{
+		m_isWorldFull = true;
+		return;
+	}
+
+	m_contactListener.m_predictedBody = bID;
+	m_contactListener.m_isHit = false;
+	for (uint32_t step = 1; step <= settings.m_numSteps; ++step)
+	{
+		m_contactListener.m_time = static_cast<float>(step) * m_deltaTime;
+		m_world->Update(m_deltaTime, 1, &m_tempAllocator, &m_jobSystem);
+		if (m_contactListener.m_isHit && settings.m_isStoppingOnContact)
+		{	//end the line on the surface
+			result.m_points.push_back(m_contactListener.m_position);
+			break;
+		}
+		if (step % settings.m_stepsPerPoint == 0 || step == settings.m_numSteps)
+		{
+			JPH::Vec3 const position = JPH::Vec3(bi.GetPosition(bID));
+			result.m_points.push_back(ToGLMVec3(position));
+		}
+	}
+	if (m_contactListener.m_isHit)
+	{
+		result.m_landing = WP_TrajectoryContact{ true, WP_INVALID_GAMEOBJECTID, m_contactListener.m_position, m_contactListener.m_normal, m_contactListener.m_time };
+		_job.m_hitSource = m_contactListener.m_hitSource;
+		_job.m_hitSubShape = m_contactListener.m_hitSubShape;
+	}
+	m_contactListener.m_predictedBody = JPH::BodyID{};
+	bi.RemoveBody(bID);
+	bi.DestroyBody(bID);
+}
+
+void WP_PhysicsPrediction::DestroyClones()
+{
+	if (!m_world || m_clones.empty()) { return; }
+	std::vector<JPH::BodyID> clones;
+	clones.reserve(m_clones.size());
+	for (auto const& [key, clone] : m_clones) { clones.push_back(clone.m_body); }
+	JPH::BodyInterface& bi = m_world->GetBodyInterfaceNoLock();
+	bi.RemoveBodies(clones.data(), static_cast<int>(clones.size()));
+	bi.DestroyBodies(clones.data(), static_cast<int>(clones.size()));
+	m_clones.clear();
+}
+
+void WP_PhysicsPrediction::WP_PredictionContactListener::OnContactAdded(JPH::Body const& _body1, JPH::Body const& _body2,
+	JPH::ContactManifold const& _manifold, [[maybe_unused]] JPH::ContactSettings& _settings)
+{
+	using namespace WP_Physics;
+	if (m_isHit) { return; }
+	bool const isFirst = _body1.GetID() == m_predictedBody;
+	if (!isFirst && _body2.GetID() != m_predictedBody) { return; }
+	JPH::Body const& clone = isFirst ? _body2 : _body1;
+	m_hitSource = JPH::BodyID{ static_cast<JPH::uint32>(clone.GetUserData()) };
+	m_hitSubShape = isFirst ? _manifold.mSubShapeID2 : _manifold.mSubShapeID1;
+	JPH::Vec3 const position = JPH::Vec3(isFirst ? _manifold.GetWorldSpaceContactPointOn2(0) : _manifold.GetWorldSpaceContactPointOn1(0));
+	//manifold normal points from body 1 to body 2, flip it so it points out of the clone
+	JPH::Vec3 const normal = isFirst ? -_manifold.mWorldSpaceNormal : _manifold.mWorldSpaceNormal;
+	m_position = ToGLMVec3(position);
+	m_normal = ToGLMVec3(normal);
+	m_isHit = true;
+}
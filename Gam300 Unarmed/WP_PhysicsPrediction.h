@@ -0,0 +1,184 @@
+#pragma once
+#include <WP_CoreComponents/WP_Physics.h>
+#include <WP_EngineSystem/WP_JobSystem.h>
+#include <WP_EngineSystem/WP_PhysicsTempAllocator.h>
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/JobSystemSingleThreaded.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Body/BodyID.h>
+#include <Jolt/Physics/Collision/ContactListener.h>
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+#include <Jolt/Physics/Collision/Shape/SubShapeID.h>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//body limit of the prediction world, cloned statics and the predicted body
+#ifndef WP_PHYSICS_PREDICTION_MAX_BODIES
+#define WP_PHYSICS_PREDICTION_MAX_BODIES 1024
+#endif
+
+//arena of the prediction world updates, a handful of bodies need very little
+#ifndef WP_PHYSICS_PREDICTION_TEMP_ALLOCATOR_SIZE
+#define WP_PHYSICS_PREDICTION_TEMP_ALLOCATOR_SIZE (2 * 1024 * 1024)
+#endif
+
+//physics updates a published trajectory stays readable if it is not released
+#ifndef WP_PHYSICS_PREDICTION_RESULT_FRAMES
+#define WP_PHYSICS_PREDICTION_RESULT_FRAMES 4
+#endif
+
+//Background "where will this land" previews for throwables and grenade arcs.
+//Owns a small second JPH::PhysicsSystem that only ever holds clones of the static bodies near the
+//predicted path plus the predicted body itself. Requests are gathered during the frame, the nearby
+//statics are copied out of the main world after its update, then the prediction world is stepped
+//ahead on one LOW priority engine job. Results are published by the next physics update, so a
+//request made this frame is normally readable the next one. The main world is only read on the
+//main thread and nothing waits on the job, so the frame time is not affected.
+//Cloned statics share the main world's shapes and are kept between requests, only the ones that
+//moved, appeared or left the area are touched.
+//Main thread only.
+class WP_PhysicsPrediction
+{
+public:
+	using WP_TrajectoryID = uint32_t;
+	static constexpr WP_TrajectoryID c_InvalidTrajectory = 0;
+
+	struct WP_TrajectoryContact
+	{
+		bool				m_isHit = false;
+		WP_GameObjectID		m_hitObject = WP_INVALID_GAMEOBJECTID;	//also invalid if the static is gone by the time it is published
+		glm::vec3			m_position{};
+		glm::vec3			m_normal{};				//pointing out of the hit static
+		float				m_time = 0.f;			//seconds after the start
+	};
+
+	struct WP_Trajectory
+	{
+		WP_TrajectoryID				m_id = c_InvalidTrajectory;
+		std::vector<glm::vec3>		m_points;		//polyline from the start to the last simulated position
+		WP_TrajectoryContact		m_landing;		//first contact with a static
+	};
+	using WP_TrajectoryCallback = std::function<void(WP_Trajectory const&)>;
+
+	struct WP_TrajectorySettings
+	{
+		JPH::RefConst<JPH::Shape>	m_shape;						//nullptr = sphere of m_radius
+		float						m_radius = 0.1f;
+		glm::vec3					m_position{};
+		glm::quat					m_rotation{ 1.f, 0.f, 0.f, 0.f };
+		glm::vec3					m_velocity{};
+		glm::vec3					m_angularVelocity{};
+		float						m_gravityFactor = 1.f;
+		float						m_friction = 0.5f;
+		float						m_restitution = 0.3f;
+		JPH::ObjectLayer			m_layer = JPH::cObjectLayerInvalid;	//MOVING if invalid
+		uint32_t					m_numSteps = 120;				//fixed physics steps simulated
+		uint32_t					m_stepsPerPoint = 2;			//polyline resolution
+		float						m_searchMargin = 2.f;			//metres around the ballistic arc whose statics are cloned
+		bool						m_isStoppingOnContact = true;	//false keeps bouncing and rolling for m_numSteps
+		WP_TrajectoryCallback		m_callback;						//optional, called on the main thread when published
+	};
+
+	WP_PhysicsPrediction();
+	~WP_PhysicsPrediction();
+
+	WP_PhysicsPrediction(WP_PhysicsPrediction const&) = delete;
+	WP_PhysicsPrediction& operator=(WP_PhysicsPrediction const&) = delete;
+
+	//same layer setup as the main world, the interfaces must outlive this
+	void					Init(JPH::BroadPhaseLayerInterface const& _bpLayers, JPH::ObjectVsBroadPhaseLayerFilter const& _objectVsBPFilter,
+								JPH::ObjectLayerPairFilter const& _objectPairFilter);
+
+	WP_TrajectoryID			Request(WP_TrajectorySettings const& _settings);
+	//nullptr while pending, after release or once expired
+	WP_Trajectory const*	GetTrajectory(WP_TrajectoryID _trajectory) const;
+	bool					GetIsPending(WP_TrajectoryID _trajectory) const;
+	void					Release(WP_TrajectoryID _trajectory);
+	//waits for the running job, drops every request, result and clone
+	void					Clear();
+
+	//called by WP_PhysicsSystem once per frame after the main world update, when it is not locked
+	void					Update(JPH::PhysicsSystem const& _world, float _fixedDeltaTime);
+
+private:
+	//first contact of the predicted body with a clone, the prediction world runs on one thread
+	class WP_PredictionContactListener final : public JPH::ContactListener
+	{
+	public:
+		virtual void		OnContactAdded(JPH::Body const& _body1, JPH::Body const& _body2, JPH::ContactManifold const& _manifold, JPH::ContactSettings& _settings) override;
+
+		JPH::BodyID			m_predictedBody;
+		float				m_time = 0.f;		//of the step being simulated
+		bool				m_isHit = false;
+		JPH::BodyID			m_hitSource;		//main world body the clone was made from
+		JPH::SubShapeID		m_hitSubShape;
+		glm::vec3			m_position{};
+		glm::vec3			m_normal{};
+	};
+
+	//main world static copied out on the main thread
+	struct WP_StaticSnapshot
+	{
+		JPH::BodyID					m_source;
+		JPH::RefConst<JPH::Shape>	m_shape;
+		JPH::RVec3					m_position;
+		JPH::Quat					m_rotation;
+		JPH::ObjectLayer			m_layer;
+		float						m_friction;
+		float						m_restitution;
+	};
+
+	struct WP_PredictionJob
+	{
+		WP_TrajectorySettings		m_settings;
+		WP_Trajectory				m_result;
+		JPH::BodyID					m_hitSource;			//resolved to a gameobject when published
+		JPH::SubShapeID				m_hitSubShape;
+	};
+
+	struct WP_Clone
+	{
+		JPH::BodyID					m_body;
+		uint32_t					m_stamp;				//last request that needed it
+	};
+
+	struct WP_PublishedTrajectory
+	{
+		WP_Trajectory				m_trajectory;
+		uint32_t					m_frame;
+	};
+
+	void					Publish(JPH::PhysicsSystem const& _world);
+	void					SnapshotStatics(JPH::PhysicsSystem const& _world, WP_PredictionJob& _job);
+	void					RunJobs();								//on the worker
+	void					Simulate(WP_PredictionJob& _job);
+	void					SyncClones();							//clones exactly the statics of this batch
+	void					DestroyClones();
+
+	std::unique_ptr<JPH::PhysicsSystem>				m_world;
+	WP_PhysicsTempAllocator							m_tempAllocator{ WP_PHYSICS_PREDICTION_TEMP_ALLOCATOR_SIZE };
+	JPH::JobSystemSingleThreaded					m_jobSystem{ JPH::cMaxPhysicsJobs };
+	WP_PredictionContactListener					m_contactListener;
+
+	//gathered on the main thread, handed to the job when it is free
+	std::vector<std::pair<WP_TrajectoryID, WP_TrajectorySettings>>	m_requests;
+	WP_TrajectoryID									m_nextID = 1;
+	std::unordered_set<WP_TrajectoryID>				m_pending;				//requested or running, not published yet
+
+	//owned by the job while it runs
+	std::vector<WP_PredictionJob>					m_jobs;
+	std::vector<WP_StaticSnapshot>					m_statics;				//of every job in the batch, may repeat
+	std::unordered_map<uint64_t, WP_Clone>			m_clones;				//source body index and sequence to clone
+	uint32_t										m_cloneStamp = 0;
+	JPH::Vec3										m_gravity = JPH::Vec3::sZero();
+	float											m_deltaTime = 0.f;
+	bool											m_isWorldFull = false;	//a clone did not fit, warned when published
+	WP_JobSystem::WP_JobCounter						m_counter;
+	bool											m_isRunning = false;
+
+	std::unordered_map<WP_TrajectoryID, WP_PublishedTrajectory>	m_results;
+	uint32_t										m_frame = 0;
+};
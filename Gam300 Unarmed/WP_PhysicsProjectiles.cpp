@@ -0,0 +1,227 @@
+#include <WP_EngineSystem/WP_PhysicsProjectiles.h>
+#include <WP_EngineSystem/WP_PhysicsSystem.h>
+#include <WP_EngineSystem/WP_JobSystem.h>
+#include <WP_ECS/WP_ComponentSystem.h>
+#include <Jolt/Physics/Body/BodyLock.h>
+#include <Jolt/Physics/Body/BodyFilter.h>
+#include <Jolt/Physics/Collision/RayCast.h>
+#include <Jolt/Physics/Collision/CastResult.h>
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	//trees and layers of one projectile query mask
+	class WP_ProjectileBroadPhaseFilter final : public JPH::BroadPhaseLayerFilter
+	{
+	public:
+		explicit WP_ProjectileBroadPhaseFilter(WP_PhysicsLayerMatrix::WP_TreeMask _treeMask) : m_treeMask{ _treeMask } {/*Empty by Design*/ }
+		virtual bool			ShouldCollide(JPH::BroadPhaseLayer _inLayer) const override
+		{
+			return (m_treeMask >> static_cast<JPH::BroadPhaseLayer::Type>(_inLayer)) & 1u;
+		}
+	private:
+		WP_PhysicsLayerMatrix::WP_TreeMask	m_treeMask;
+	};
+
+	class WP_ProjectileObjectLayerFilter final : public JPH::ObjectLayerFilter
+	{
+	public:
+		explicit WP_ProjectileObjectLayerFilter(WP_PhysicsLayerMatrix::WP_LayerMask _mask) : m_mask{ _mask } {/*Empty by Design*/ }
+		virtual bool			ShouldCollide(JPH::ObjectLayer _inLayer) const override
+		{
+			return _inLayer < WP_PhysicsLayerMatrix::c_MaxLayers && ((m_mask >> _inLayer) & 1u);
+		}
+	private:
+		WP_PhysicsLayerMatrix::WP_LayerMask	m_mask;
+	};
+}
+
+const WP_PhysicsProjectiles::WP_LayerMask WP_PhysicsProjectiles::c_DefaultQueryMask =
+	(1u << Layers::NON_MOVING) | (1u << Layers::MOVING) | (1u << Layers::WEAPON);
+
+bool WP_PhysicsProjectiles::GetIsDefaultQueryValid(WP_PhysicsLayerMatrix const& _layers)
+{
+	using WP_LayerTree = WP_PhysicsLayerMatrix::WP_LayerTree;
+	return (_layers.GetTreeMask(c_DefaultQueryMask) >> static_cast<uint32_t>(WP_LayerTree::NON_MOVING)) & 1u;
+}
+
+WP_PhysicsProjectiles::WP_ProjectileID WP_PhysicsProjectiles::Spawn(WP_ProjectileSettings const& _settings)
+{
+	JPH::BodyID ownerBody;
+	if (_settings.m_owner != WP_INVALID_GAMEOBJECTID)
+	{
+		if (WP_Physics3D const* const pComp = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponent(_settings.m_owner))
+		{
+			ownerBody = pComp->m_bID;
+		}
+	}
+	WP_LayerMask const queryMask = (_settings.m_queryMask == 0) ? c_DefaultQueryMask : _settings.m_queryMask;
+
+	WP_ProjectileID const id = m_nextID++;
+	m_indexOf.emplace(id, static_cast<uint32_t>(m_ids.size()));
+	m_ids.push_back(id);
+	m_posX.push_back(_settings.m_position.x);
+	m_posY.push_back(_settings.m_position.y);
+	m_posZ.push_back(_settings.m_position.z);
+	m_velX.push_back(_settings.m_velocity.x);
+	m_velY.push_back(_settings.m_velocity.y);
+	m_velZ.push_back(_settings.m_velocity.z);
+	m_lifetime.push_back(_settings.m_lifetime);
+	m_gravityFactor.push_back(_settings.m_gravityFactor);
+	m_owner.push_back(_settings.m_owner);
+	m_ownerBody.push_back(ownerBody);
+	m_queryMask.push_back(queryMask);
+	m_userData.push_back(_settings.m_userData);
+	return id;
+}
+
+void WP_PhysicsProjectiles::Despawn(WP_ProjectileID _projectile)
+{
+	auto iter = m_indexOf.find(_projectile);
+	if (iter == m_indexOf.end()) { return; }
+	RemoveAt(iter->second);
+}
+
+void WP_PhysicsProjectiles::Clear()
+{
+	m_posX.clear(); m_posY.clear(); m_posZ.clear();
+	m_velX.clear(); m_velY.clear(); m_velZ.clear();
+	m_lifetime.clear();
+	m_gravityFactor.clear();
+	m_owner.clear();
+	m_ownerBody.clear();
+	m_queryMask.clear();
+	m_userData.clear();
+	m_ids.clear();
+	m_indexOf.clear();
+	m_hits.clear();
+}
+
+void WP_PhysicsProjectiles::RemoveAt(uint32_t _index)
+{
+	uint32_t const last = static_cast<uint32_t>(m_ids.size()) - 1;
+	m_indexOf.erase(m_ids[_index]);
+	if (_index != last)
+	{
+		m_posX[_index] = m_posX[last]; m_posY[_index] = m_posY[last]; m_posZ[_index] = m_posZ[last];
+		m_velX[_index] = m_velX[last]; m_velY[_index] = m_velY[last]; m_velZ[_index] = m_velZ[last];
+		m_lifetime[_index] = m_lifetime[last];
+		m_gravityFactor[_index] = m_gravityFactor[last];
+		m_owner[_index] = m_owner[last];
+		m_ownerBody[_index] = m_ownerBody[last];
+		m_queryMask[_index] = m_queryMask[last];
+		m_userData[_index] = m_userData[last];
+		m_ids[_index] = m_ids[last];
+		m_indexOf[m_ids[_index]] = _index;
+	}
+	m_posX.pop_back(); m_posY.pop_back(); m_posZ.pop_back();
+	m_velX.pop_back(); m_velY.pop_back(); m_velZ.pop_back();
+	m_lifetime.pop_back();
+	m_gravityFactor.pop_back();
+	m_owner.pop_back();
+	m_ownerBody.pop_back();
+	m_queryMask.pop_back();
+	m_userData.pop_back();
+	m_ids.pop_back();
+}
+
+void WP_PhysicsProjectiles::Step(JPH::PhysicsSystem const& _world, WP_PhysicsLayerMatrix const& _layers, float _deltaTime)
+{
+	uint32_t const numProjectiles = static_cast<uint32_t>(m_ids.size());
+	if (numProjectiles == 0) { return; }
+
+	//integrate, branch free loops over the arrays so the compiler can vectorise them
+	JPH::Vec3 const gravity = _world.GetGravity();
+	float const gx = gravity.GetX() * _deltaTime, gy = gravity.GetY() * _deltaTime, gz = gravity.GetZ() * _deltaTime;
+	m_moveX.resize(numProjectiles); m_moveY.resize(numProjectiles); m_moveZ.resize(numProjectiles);
+	for (uint32_t i{}; i < numProjectiles; ++i) { m_velX[i] += gx * m_gravityFactor[i]; }
+	for (uint32_t i{}; i < numProjectiles; ++i) { m_velY[i] += gy * m_gravityFactor[i]; }
+	for (uint32_t i{}; i < numProjectiles; ++i) { m_velZ[i] += gz * m_gravityFactor[i]; }
+	for (uint32_t i{}; i < numProjectiles; ++i) { m_moveX[i] = m_velX[i] * _deltaTime; }
+	for (uint32_t i{}; i < numProjectiles; ++i) { m_moveY[i] = m_velY[i] * _deltaTime; }
+	for (uint32_t i{}; i < numProjectiles; ++i) { m_moveZ[i] = m_velZ[i] * _deltaTime; }
+	for (uint32_t i{}; i < numProjectiles; ++i) { m_lifetime[i] -= _deltaTime; }
+
+	//sweep the segments against the world
+	m_hitFraction.assign(numProjectiles, 1.f);
+	m_hitBody.resize(numProjectiles);
+	m_hitSubShape.resize(numProjectiles);
+	m_hitNormal.resize(numProjectiles);
+	if (numProjectiles <= WP_PHYSICS_PROJECTILE_BATCH_SIZE)
+	{	//not worth a job
+		SweepBatch(_world, _layers, 0, numProjectiles);
+	}
+	else
+	{
+		WP_JobSystem* const jobSystem = WP_JobSystem::GetInstance();
+		WP_JobSystem::WP_JobCounter counter;
+		for (uint32_t begin{}; begin < numProjectiles; begin += WP_PHYSICS_PROJECTILE_BATCH_SIZE)
+		{
+			uint32_t const end = std::min<uint32_t>(begin + WP_PHYSICS_PROJECTILE_BATCH_SIZE, numProjectiles);
+			jobSystem->Schedule([this, &_world, &_layers, begin, end]() { SweepBatch(_world, _layers, begin, end); },
+				WP_JobSystem::WP_JobPriority::HIGH, &counter);
+		}
+		jobSystem->Wait(counter);
+	}
+
+	//advance, record hits and drop dead projectiles. backwards so swap and pop keeps unvisited entries
+	WP_PhysicsSystem const* const physicsSystem = WP_PhysicsSystem::GetInstance();
+	for (uint32_t i = numProjectiles; i-- > 0;)
+	{
+		float const fraction = m_hitFraction[i];
+		m_posX[i] += m_moveX[i] * fraction;
+		m_posY[i] += m_moveY[i] * fraction;
+		m_posZ[i] += m_moveZ[i] * fraction;
+		if (fraction < 1.f)
+		{
+			m_hits.push_back(WP_ProjectileHit{ m_ids[i], m_owner[i], physicsSystem->GetIDfromSubShape(m_hitBody[i], m_hitSubShape[i]),
+				glm::vec3(m_posX[i], m_posY[i], m_posZ[i]), m_hitNormal[i], glm::vec3(m_velX[i], m_velY[i], m_velZ[i]), m_userData[i] });
+			RemoveAt(i);
+		}
+		else if (m_lifetime[i] <= 0.f)
+		{
+			RemoveAt(i);
+		}
+	}
+}
+
+void WP_PhysicsProjectiles::SweepBatch(JPH::PhysicsSystem const& _world, WP_PhysicsLayerMatrix const& _layers, uint32_t _begin, uint32_t _end)
+{
+	JPH::NarrowPhaseQuery const& query = _world.GetNarrowPhaseQuery();
+	JPH::BodyLockInterface const& lockInterface = _world.GetBodyLockInterface();
+	WP_LayerMask queryMask = c_DefaultQueryMask;	//most projectiles share a mask, trees only change with it
+	WP_PhysicsLayerMatrix::WP_TreeMask treeMask = _layers.GetTreeMask(queryMask);
+	for (uint32_t i = _begin; i < _end; ++i)
+	{
+		JPH::Vec3 const move{ m_moveX[i], m_moveY[i], m_moveZ[i] };
+		if (move.IsNearZero()) { continue; }
+		if (m_queryMask[i] != queryMask)
+		{
+			queryMask = m_queryMask[i];
+			treeMask = _layers.GetTreeMask(queryMask);
+		}
+		JPH::RRayCast const ray{ JPH::RVec3(m_posX[i], m_posY[i], m_posZ[i]), move };
+		JPH::RayCastResult hit;
+		if (!query.CastRay(ray, hit, WP_ProjectileBroadPhaseFilter{ treeMask },
+			WP_ProjectileObjectLayerFilter{ queryMask }, JPH::IgnoreSingleBodyFilter{ m_ownerBody[i] }))
+		{
+			continue;
+		}
+		m_hitFraction[i] = hit.mFraction;
+		m_hitBody[i] = hit.mBodyID;
+		m_hitSubShape[i] = hit.mSubShapeID2;
+		m_hitNormal[i] = -glm::normalize(glm::vec3(move.GetX(), move.GetY(), move.GetZ()));	//if the body is gone by now
+		JPH::BodyLockRead lock{ lockInterface, hit.mBodyID };
+		if (lock.Succeeded())
+		{
+			JPH::Vec3 const normal = lock.GetBody().GetWorldSpaceSurfaceNormal(hit.mSubShapeID2, ray.GetPointOnRay(hit.mFraction));
+			m_hitNormal[i] = WP_Physics::ToGLMVec3(normal);
+		}
+	}
+}
+
+void WP_PhysicsProjectiles::DispatchHits()
+{
+	if (m_hitCallback && !m_hits.empty()) { m_hitCallback(m_hits); }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <WP_CoreComponents/WP_Physics.h>
+#include <WP_EngineSystem/WP_PhysicsLayerMatrix.h>
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Body/BodyID.h>
+#include <Jolt/Physics/Collision/Shape/SubShapeID.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+//projectiles swept by one job, small enough to spread 10k projectiles over every worker
+#ifndef WP_PHYSICS_PROJECTILE_BATCH_SIZE
+#define WP_PHYSICS_PROJECTILE_BATCH_SIZE 256
+#endif
+
+//Pooled simulator for bullets and other small fast projectiles that do not need a Jolt body.
+//Projectiles are stored struct-of-arrays, integrated in plain loops over the arrays and swept
+//against the world with one ray per projectile per physics update, cast in batches on the job system.
+//A projectile dies on its first hit or when its lifetime runs out, hits are collected into a
+//stream that stays readable until the next physics update, like the contact streams.
+//Main thread only, the batches are waited on inside Step.
+//Projectiles are not bodies, what they hit is their own query mask and not a row of the layer matrix.
+class WP_PhysicsProjectiles
+{
+public:
+	using WP_ProjectileID = uint32_t;
+	using WP_LayerMask = WP_PhysicsLayerMatrix::WP_LayerMask;
+	static constexpr WP_ProjectileID c_InvalidProjectile = 0;
+	static const WP_LayerMask c_DefaultQueryMask;		//NON_MOVING, MOVING and WEAPON
+
+	struct WP_ProjectileSettings
+	{
+		glm::vec3			m_position{};
+		glm::vec3			m_velocity{};
+		float				m_lifetime = 2.f;				//seconds before it expires without a hit
+		float				m_gravityFactor = 0.f;			//0 flies straight
+		WP_GameObjectID		m_owner = WP_INVALID_GAMEOBJECTID;	//its body is never hit by the projectile
+		WP_LayerMask		m_queryMask = 0;				//bit n set = hits layer n, c_DefaultQueryMask if 0
+		uint64_t			m_userData = 0;					//passed back in the hit, damage id etc
+	};
+
+	struct WP_ProjectileHit
+	{
+		WP_ProjectileID		m_projectile;
+		WP_GameObjectID		m_owner;
+		WP_GameObjectID		m_hitObject;			//WP_INVALID_GAMEOBJECTID for bodies without a gameobject
+		glm::vec3			m_position;
+		glm::vec3			m_normal;
+		glm::vec3			m_velocity;				//at impact
+		uint64_t			m_userData;
+	};
+	using WP_HitSpan = std::span<const WP_ProjectileHit>;
+	using WP_HitCallback = std::function<void(WP_HitSpan)>;
+
+	WP_ProjectileID			Spawn(WP_ProjectileSettings const& _settings);
+	void					Despawn(WP_ProjectileID _projectile);
+	void					Clear();						//every projectile and the hit stream
+	bool					GetIsAlive(WP_ProjectileID _projectile) const { return m_indexOf.contains(_projectile); }
+	uint32_t				GetNumProjectiles() const { return static_cast<uint32_t>(m_ids.size()); }
+
+	//hits of the last physics update, valid until the next one
+	WP_HitSpan				GetHits() const { return m_hits; }
+	//called once per physics update with every hit, after the contact callbacks
+	void					SetHitCallback(WP_HitCallback _callback) { m_hitCallback = std::move(_callback); }
+
+	//called by WP_PhysicsSystem
+	//false if c_DefaultQueryMask would miss static geometry under _layers, checked once the layers are loaded
+	static bool				GetIsDefaultQueryValid(WP_PhysicsLayerMatrix const& _layers);
+	void					ClearHits() { m_hits.clear(); }
+	void					Step(JPH::PhysicsSystem const& _world, WP_PhysicsLayerMatrix const& _layers, float _deltaTime);
+	void					DispatchHits();
+
+private:
+	void					SweepBatch(JPH::PhysicsSystem const& _world, WP_PhysicsLayerMatrix const& _layers, uint32_t _begin, uint32_t _end);
+	void					RemoveAt(uint32_t _index);		//swap with the last projectile and pop
+
+	//one entry per live projectile, same index in every array
+	std::vector<float>					m_posX, m_posY, m_posZ;
+	std::vector<float>					m_velX, m_velY, m_velZ;
+	std::vector<float>					m_lifetime;
+	std::vector<float>					m_gravityFactor;
+	std::vector<WP_GameObjectID>		m_owner;
+	std::vector<JPH::BodyID>			m_ownerBody;
+	std::vector<WP_LayerMask>			m_queryMask;
+	std::vector<uint64_t>				m_userData;
+	std::vector<WP_ProjectileID>		m_ids;
+	std::unordered_map<WP_ProjectileID, uint32_t>	m_indexOf;
+	WP_ProjectileID						m_nextID = 1;
+
+	//per step scratch, written by the sweep jobs, one entry per projectile
+	std::vector<float>					m_moveX, m_moveY, m_moveZ;		//displacement this step
+	std::vector<float>					m_hitFraction;					//1 = no hit
+	std::vector<JPH::BodyID>			m_hitBody;
+	std::vector<JPH::SubShapeID>		m_hitSubShape;
+	std::vector<glm::vec3>				m_hitNormal;
+
+	std::vector<WP_ProjectileHit>		m_hits;
+	WP_HitCallback						m_hitCallback;
+};
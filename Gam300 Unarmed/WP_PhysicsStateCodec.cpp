@@ -0,0 +1,468 @@
+#include <WP_EngineSystem/WP_PhysicsStateCodec.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	//per written body
+	enum WP_BodyFlags : uint8_t
+	{
+		ACTIVE			= 1 << 0,
+		NEW_ID			= 1 << 1,		//slot was empty or held another body, full id follows
+		POSITION		= 1 << 2,		//position changed
+		FULL_POSITION	= 1 << 3,		//cell, bits and offsets instead of offset deltas
+		ROTATION		= 1 << 4,
+		FULL_ROTATION	= 1 << 5,		//largest index and components instead of component deltas
+		VELOCITY		= 1 << 6		//six velocity deltas, absent = unchanged
+	};
+
+	constexpr float c_Sqrt2 = 1.41421356f;
+
+	uint32_t ZigZag(int32_t _value) { return (static_cast<uint32_t>(_value) << 1) ^ static_cast<uint32_t>(_value >> 31); }
+	int32_t UnZigZag(uint32_t _value) { return static_cast<int32_t>(_value >> 1) ^ -static_cast<int32_t>(_value & 1u); }
+
+	void WriteVarint(std::vector<uint8_t>& _out, uint32_t _value)
+	{
+		while (_value >= 0x80u)
+		{
+			_out.push_back(static_cast<uint8_t>(_value | 0x80u));
+			_value >>= 7;
+		}
+		_out.push_back(static_cast<uint8_t>(_value));
+	}
+	void WriteFloat(std::vector<uint8_t>& _out, float _value)
+	{
+		uint8_t bytes[sizeof(float)];
+		std::memcpy(bytes, &_value, sizeof(float));
+		_out.insert(_out.end(), bytes, bytes + sizeof(float));
+	}
+
+	//bounds checked, a failed read sets m_isValid and returns 0 so callers check once at the end
+	struct WP_ByteReader
+	{
+		std::span<const uint8_t>	m_data;
+		size_t						m_cursor = 0;
+		bool						m_isValid = true;
+
+		uint8_t ReadByte()
+		{
+			if (m_cursor >= m_data.size()) { m_isValid = false; return 0; }
+			return m_data[m_cursor++];
+		}
+		uint32_t ReadVarint()
+		{
+			uint32_t value{};
+			for (uint32_t shift{}; shift < 35; shift += 7)
+			{
+				uint8_t const byte = ReadByte();
+				value |= static_cast<uint32_t>(byte & 0x7fu) << shift;
+				if (!(byte & 0x80u)) { return value; }
+			}
+			m_isValid = false;
+			return 0;
+		}
+		float ReadFloat()
+		{
+			if (m_cursor + sizeof(float) > m_data.size()) { m_isValid = false; return 0.f; }
+			float value;
+			std::memcpy(&value, &m_data[m_cursor], sizeof(float));
+			m_cursor += sizeof(float);
+			return value;
+		}
+	};
+
+	int32_t QuantizeSigned(float _value, float _max, uint8_t _bits)
+	{
+		float const range = static_cast<float>((1u << (_bits - 1)) - 1u);
+		return static_cast<int32_t>(std::floor(std::clamp(_value / _max, -1.f, 1.f) * range + 0.5f));
+	}
+	float DequantizeSigned(int32_t _value, float _max, uint8_t _bits)
+	{
+		float const range = static_cast<float>((1u << (_bits - 1)) - 1u);
+		return static_cast<float>(_value) / range * _max;
+	}
+}
+
+WP_PhysicsStateCodec::WP_PhysicsStateCodec(uint32_t _maxBodies)
+	: m_baseline(_maxBodies)
+{
+	m_baselineIndices.reserve(_maxBodies);
+	m_scratchIndices.reserve(_maxBodies);
+}
+
+void WP_PhysicsStateCodec::SetSettings(WP_Settings const& _settings)
+{
+	assert(_settings.m_cellSize > 0.f && _settings.m_positionBits >= 1 && _settings.m_positionBits <= 24);
+	assert(_settings.m_rotationBits >= 1 && _settings.m_rotationBits <= 20);
+	assert(_settings.m_linearVelocityBits >= 2 && _settings.m_linearVelocityBits <= 24);
+	assert(_settings.m_angularVelocityBits >= 2 && _settings.m_angularVelocityBits <= 24);
+	m_settings = _settings;
+	m_isKeyframeForced = true;		//baseline was quantized with the old settings
+}
+
+void WP_PhysicsStateCodec::SetCellPrecision(glm::ivec3 const& _cell, uint8_t _positionBits)
+{
+	assert(_positionBits <= 24);
+	uint64_t const key = CellKey(_cell.x, _cell.y, _cell.z);
+	if (_positionBits == 0) { m_cellPrecisions.erase(key); }
+	else { m_cellPrecisions[key] = _positionBits; }
+	m_isKeyframeForced = true;
+}
+
+void WP_PhysicsStateCodec::ClearCellPrecisions()
+{
+	m_cellPrecisions.clear();
+	m_isKeyframeForced = true;
+}
+
+void WP_PhysicsStateCodec::Reset()
+{
+	for (uint32_t const index : m_baselineIndices) { m_baseline[index].m_bodyID = c_EmptySlot; }
+	m_baselineIndices.clear();
+	m_sequence = 0;
+	m_numSinceKeyframe = 0;
+	m_isKeyframeForced = true;
+}
+
+uint64_t WP_PhysicsStateCodec::CellKey(int32_t _x, int32_t _y, int32_t _z)
+{	//21 bits per axis, a million cells each way
+	return (static_cast<uint64_t>(_x & 0x1fffff) << 42) | (static_cast<uint64_t>(_y & 0x1fffff) << 21) | static_cast<uint64_t>(_z & 0x1fffff);
+}
+
+uint8_t WP_PhysicsStateCodec::GetPositionBits(int32_t const (&_cell)[3]) const
+{
+	if (m_cellPrecisions.empty()) { return m_settings.m_positionBits; }
+	auto iter = m_cellPrecisions.find(CellKey(_cell[0], _cell[1], _cell[2]));
+	return (iter != m_cellPrecisions.end()) ? iter->second : m_settings.m_positionBits;
+}
+
+void WP_PhysicsStateCodec::Quantize(WP_BodyState const& _body, WP_QuantizedBody& _out) const
+{
+	_out.m_bodyID = _body.m_bodyID;
+	_out.m_isActive = _body.m_isActive;
+
+	float const position[3] = { _body.m_position.x, _body.m_position.y, _body.m_position.z };
+	float const inverseCellSize = 1.f / m_settings.m_cellSize;
+	for (uint32_t axis{}; axis < 3; ++axis)
+	{
+		_out.m_cell[axis] = static_cast<int32_t>(std::floor(position[axis] * inverseCellSize));
+	}
+	_out.m_positionBits = GetPositionBits(_out.m_cell);
+	uint32_t const maxOffset = (1u << _out.m_positionBits) - 1u;
+	float const scale = static_cast<float>(1u << _out.m_positionBits) / m_settings.m_cellSize;
+	for (uint32_t axis{}; axis < 3; ++axis)
+	{
+		float const local = position[axis] - static_cast<float>(_out.m_cell[axis]) * m_settings.m_cellSize;
+		_out.m_offset[axis] = std::min(static_cast<uint32_t>(std::max(local * scale, 0.f)), maxOffset);
+	}
+
+	//smallest three, the dropped component is made positive so its sign need not be stored
+	float const rotation[4] = { _body.m_rotation.x, _body.m_rotation.y, _body.m_rotation.z, _body.m_rotation.w };
+	uint8_t largest{};
+	for (uint8_t i = 1; i < 4; ++i)
+	{
+		if (std::abs(rotation[i]) > std::abs(rotation[largest])) { largest = i; }
+	}
+	float const sign = (rotation[largest] < 0.f) ? -1.f : 1.f;
+	float const rotationRange = static_cast<float>((1u << m_settings.m_rotationBits) - 1u);
+	_out.m_largest = largest;
+	for (uint8_t i{}, component{}; i < 4; ++i)
+	{
+		if (i == largest) { continue; }
+		float const unit = std::clamp((rotation[i] * sign * c_Sqrt2 + 1.f) * 0.5f, 0.f, 1.f);	//[-1/sqrt2, 1/sqrt2] to [0, 1]
+		_out.m_rotation[component++] = static_cast<uint32_t>(unit * rotationRange + 0.5f);
+	}
+
+	float const linear[3] = { _body.m_linearVelocity.x, _body.m_linearVelocity.y, _body.m_linearVelocity.z };
+	float const angular[3] = { _body.m_angularVelocity.x, _body.m_angularVelocity.y, _body.m_angularVelocity.z };
+	for (uint32_t axis{}; axis < 3; ++axis)
+	{
+		_out.m_linearVelocity[axis] = QuantizeSigned(linear[axis], m_settings.m_maxLinearVelocity, m_settings.m_linearVelocityBits);
+		_out.m_angularVelocity[axis] = QuantizeSigned(angular[axis], m_settings.m_maxAngularVelocity, m_settings.m_angularVelocityBits);
+	}
+}
+
+void WP_PhysicsStateCodec::Dequantize(WP_QuantizedBody const& _body, WP_BodyState& _out) const
+{
+	_out.m_bodyID = _body.m_bodyID;
+	_out.m_isActive = _body.m_isActive;
+
+	float position[3];
+	float const step = m_settings.m_cellSize / static_cast<float>(1u << _body.m_positionBits);
+	for (uint32_t axis{}; axis < 3; ++axis)
+	{	//centre of the quantization step, half a step of error at most
+		position[axis] = static_cast<float>(_body.m_cell[axis]) * m_settings.m_cellSize + (static_cast<float>(_body.m_offset[axis]) + 0.5f) * step;
+	}
+	_out.m_position = glm::vec3(position[0], position[1], position[2]);
+
+	float rotation[4];
+	float sumSquares{};
+	float const rotationRange = static_cast<float>((1u << m_settings.m_rotationBits) - 1u);
+	for (uint8_t i{}, component{}; i < 4; ++i)
+	{
+		if (i == _body.m_largest) { continue; }
+		float const value = (static_cast<float>(_body.m_rotation[component++]) / rotationRange * 2.f - 1.f) / c_Sqrt2;
+		rotation[i] = value;
+		sumSquares += value * value;
+	}
+	rotation[_body.m_largest] = std::sqrt(std::max(0.f, 1.f - sumSquares));
+	float const length = std::sqrt(sumSquares + rotation[_body.m_largest] * rotation[_body.m_largest]);
+	_out.m_rotation = glm::quat(rotation[3] / length, rotation[0] / length, rotation[1] / length, rotation[2] / length);
+
+	float linear[3], angular[3];
+	for (uint32_t axis{}; axis < 3; ++axis)
+	{
+		linear[axis] = DequantizeSigned(_body.m_linearVelocity[axis], m_settings.m_maxLinearVelocity, m_settings.m_linearVelocityBits);
+		angular[axis] = DequantizeSigned(_body.m_angularVelocity[axis], m_settings.m_maxAngularVelocity, m_settings.m_angularVelocityBits);
+	}
+	_out.m_linearVelocity = glm::vec3(linear[0], linear[1], linear[2]);
+	_out.m_angularVelocity = glm::vec3(angular[0], angular[1], angular[2]);
+}
+
+void WP_PhysicsStateCodec::Encode(std::span<const WP_BodyState> _bodies, std::vector<uint8_t>& _out, bool _isKeyframe)
+{
+	bool const isKeyframe = _isKeyframe || m_isKeyframeForced || m_sequence == 0
+		|| (m_settings.m_keyframeInterval != 0 && m_numSinceKeyframe >= m_settings.m_keyframeInterval);
+	if (isKeyframe) { Reset(); }
+	m_isKeyframeForced = false;
+	uint32_t const baseline = m_sequence;
+	m_sequence = (baseline == 0) ? 1 : baseline + 1;
+	m_numSinceKeyframe = isKeyframe ? 0 : m_numSinceKeyframe + 1;
+
+	//header and settings, the decoder adopts them
+	_out.reserve(_out.size() + 64 + _bodies.size() * 24);
+	_out.push_back(static_cast<uint8_t>(c_Version));
+	WriteVarint(_out, m_sequence);
+	WriteVarint(_out, baseline);
+	WriteFloat(_out, m_settings.m_cellSize);
+	_out.push_back(m_settings.m_positionBits);
+	_out.push_back(m_settings.m_rotationBits);
+	_out.push_back(m_settings.m_linearVelocityBits);
+	_out.push_back(m_settings.m_angularVelocityBits);
+	WriteFloat(_out, m_settings.m_maxLinearVelocity);
+	WriteFloat(_out, m_settings.m_maxAngularVelocity);
+	WriteVarint(_out, static_cast<uint32_t>(m_cellPrecisions.size()));
+	for (auto const& [key, bits] : m_cellPrecisions)
+	{
+		for (uint32_t shift : { 42u, 21u, 0u })
+		{	//sign extend the 21 bit axis
+			int32_t const axis = static_cast<int32_t>(static_cast<uint32_t>(key >> shift) << 11) >> 11;
+			WriteVarint(_out, ZigZag(axis));
+		}
+		_out.push_back(bits);
+	}
+
+	//bodies of the baseline missing from this snapshot. both lists are sorted, one merge pass
+	m_scratchIndices.clear();
+	{
+		size_t current{};
+		for (uint32_t const index : m_baselineIndices)
+		{
+			while (current < _bodies.size() && (_bodies[current].m_bodyID & 0x7fffffu) < index) { ++current; }
+			if (current == _bodies.size() || (_bodies[current].m_bodyID & 0x7fffffu) != index) { m_scratchIndices.push_back(index); }
+		}
+	}
+	WriteVarint(_out, static_cast<uint32_t>(m_scratchIndices.size()));
+	uint32_t previous{};
+	for (uint32_t const index : m_scratchIndices)
+	{
+		WriteVarint(_out, index - previous);
+		previous = index;
+		m_baseline[index].m_bodyID = c_EmptySlot;
+	}
+
+	//count is patched in once known, a fixed five byte varint keeps the patch in place
+	size_t const countAt = _out.size();
+	_out.insert(_out.end(), { 0x80, 0x80, 0x80, 0x80, 0x00 });
+	uint32_t numWritten{};
+	previous = 0;
+	m_baselineIndices.clear();
+	for (WP_BodyState const& body : _bodies)
+	{
+		uint32_t const index = body.m_bodyID & 0x7fffffu;	//JPH::BodyID::cMaxBodyIndex
+		assert(index < m_baseline.size() && "Body index past the codec size. WP_PhysicsStateCodec::Encode()");
+		assert((m_baselineIndices.empty() || m_baselineIndices.back() < index) && "Bodies must be sorted by index. WP_PhysicsStateCodec::Encode()");
+		m_baselineIndices.push_back(index);
+
+		WP_QuantizedBody quantized;
+		Quantize(body, quantized);
+		WP_QuantizedBody& base = m_baseline[index];
+		bool const isNew = base.m_bodyID != body.m_bodyID;
+		bool const isPositionSame = !isNew && base.m_positionBits == quantized.m_positionBits
+			&& std::equal(std::begin(base.m_cell), std::end(base.m_cell), std::begin(quantized.m_cell));
+		bool const isPositionChanged = isNew || !isPositionSame
+			|| !std::equal(std::begin(base.m_offset), std::end(base.m_offset), std::begin(quantized.m_offset));
+		bool const isRotationChanged = isNew || base.m_largest != quantized.m_largest
+			|| !std::equal(std::begin(base.m_rotation), std::end(base.m_rotation), std::begin(quantized.m_rotation));
+		bool const isVelocityChanged = isNew
+			|| !std::equal(std::begin(base.m_linearVelocity), std::end(base.m_linearVelocity), std::begin(quantized.m_linearVelocity))
+			|| !std::equal(std::begin(base.m_angularVelocity), std::end(base.m_angularVelocity), std::begin(quantized.m_angularVelocity));
+		//sleeping and static bodies land here every snapshot after they settle
+		if (!isPositionChanged && !isRotationChanged && !isVelocityChanged && base.m_isActive == quantized.m_isActive) { continue; }
+
+		uint8_t flags = quantized.m_isActive ? ACTIVE : 0;
+		if (isNew) { flags |= NEW_ID; }
+		if (isPositionChanged) { flags |= isPositionSame ? POSITION : (POSITION | FULL_POSITION); }
+		if (isRotationChanged) { flags |= (!isNew && base.m_largest == quantized.m_largest) ? ROTATION : (ROTATION | FULL_ROTATION); }
+		if (isVelocityChanged) { flags |= VELOCITY; }
+
+		WriteVarint(_out, index - previous);
+		previous = index;
+		_out.push_back(flags);
+		if (flags & NEW_ID) { WriteVarint(_out, body.m_bodyID); }
+		if (flags & FULL_POSITION)
+		{
+			for (int32_t const cell : quantized.m_cell) { WriteVarint(_out, ZigZag(cell)); }
+			_out.push_back(quantized.m_positionBits);
+			for (uint32_t const offset : quantized.m_offset) { WriteVarint(_out, offset); }
+		}
+		else if (flags & POSITION)
+		{
+			for (uint32_t axis{}; axis < 3; ++axis) { WriteVarint(_out, ZigZag(static_cast<int32_t>(quantized.m_offset[axis] - base.m_offset[axis]))); }
+		}
+		if (flags & FULL_ROTATION)
+		{
+			_out.push_back(quantized.m_largest);
+			for (uint32_t const component : quantized.m_rotation) { WriteVarint(_out, component); }
+		}
+		else if (flags & ROTATION)
+		{
+			for (uint32_t i{}; i < 3; ++i) { WriteVarint(_out, ZigZag(static_cast<int32_t>(quantized.m_rotation[i] - base.m_rotation[i]))); }
+		}
+		if (flags & VELOCITY)
+		{	//a new body's velocities are relative to zero
+			for (uint32_t axis{}; axis < 3; ++axis) { WriteVarint(_out, ZigZag(quantized.m_linearVelocity[axis] - (isNew ? 0 : base.m_linearVelocity[axis]))); }
+			for (uint32_t axis{}; axis < 3; ++axis) { WriteVarint(_out, ZigZag(quantized.m_angularVelocity[axis] - (isNew ? 0 : base.m_angularVelocity[axis]))); }
+		}
+		base = quantized;
+		++numWritten;
+	}
+	for (uint32_t byte{}; byte < 5; ++byte)
+	{
+		_out[countAt + byte] = static_cast<uint8_t>(((numWritten >> (7 * byte)) & 0x7fu) | (byte < 4 ? 0x80u : 0u));
+	}
+}
+
+bool WP_PhysicsStateCodec::ReadSettings(std::span<const uint8_t> _snapshot, size_t& _cursor)
+{
+	WP_ByteReader reader{ _snapshot, _cursor };
+	WP_Settings settings = m_settings;
+	settings.m_cellSize = reader.ReadFloat();
+	settings.m_positionBits = reader.ReadByte();
+	settings.m_rotationBits = reader.ReadByte();
+	settings.m_linearVelocityBits = reader.ReadByte();
+	settings.m_angularVelocityBits = reader.ReadByte();
+	settings.m_maxLinearVelocity = reader.ReadFloat();
+	settings.m_maxAngularVelocity = reader.ReadFloat();
+	if (!reader.m_isValid || !(settings.m_cellSize > 0.f) || settings.m_positionBits < 1 || settings.m_positionBits > 24
+		|| settings.m_rotationBits < 1 || settings.m_rotationBits > 20
+		|| settings.m_linearVelocityBits < 2 || settings.m_linearVelocityBits > 24
+		|| settings.m_angularVelocityBits < 2 || settings.m_angularVelocityBits > 24)
+	{
+		return false;
+	}
+	m_settings = settings;
+	m_cellPrecisions.clear();
+	uint32_t const numPrecisions = reader.ReadVarint();
+	for (uint32_t i{}; i < numPrecisions && reader.m_isValid; ++i)
+	{
+		int32_t const x = UnZigZag(reader.ReadVarint());
+		int32_t const y = UnZigZag(reader.ReadVarint());
+		int32_t const z = UnZigZag(reader.ReadVarint());
+		uint8_t const bits = reader.ReadByte();
+		if (bits < 1 || bits > 24) { return false; }
+		m_cellPrecisions[CellKey(x, y, z)] = bits;
+	}
+	_cursor = reader.m_cursor;
+	return reader.m_isValid;
+}
+
+bool WP_PhysicsStateCodec::Decode(std::span<const uint8_t> _snapshot, std::vector<WP_BodyState>& _outBodies)
+{
+	WP_ByteReader reader{ _snapshot };
+	if (reader.ReadByte() != c_Version) { return false; }
+	uint32_t const sequence = reader.ReadVarint();
+	uint32_t const baseline = reader.ReadVarint();
+	if (!reader.m_isValid || sequence == 0) { return false; }
+	if (baseline != 0 && baseline != m_sequence) { return false; }	//not the snapshot after ours, keep our baseline
+	if (!ReadSettings(_snapshot, reader.m_cursor)) { return false; }
+	if (baseline == 0) { Reset(); }
+
+	//from here a failure leaves a half applied baseline, drop it so only a keyframe is accepted next
+	auto fail = [this]() { Reset(); return false; };
+
+	uint32_t const numRemoved = reader.ReadVarint();
+	uint32_t index{};
+	for (uint32_t i{}; i < numRemoved && reader.m_isValid; ++i)
+	{
+		index += reader.ReadVarint();
+		if (index >= m_baseline.size()) { return fail(); }
+		m_baseline[index].m_bodyID = c_EmptySlot;
+	}
+
+	uint32_t const numWritten = reader.ReadVarint();
+	m_scratchIndices.clear();	//slots filled by this snapshot that were empty
+	index = 0;
+	for (uint32_t i{}; i < numWritten && reader.m_isValid; ++i)
+	{
+		index += reader.ReadVarint();
+		uint8_t const flags = reader.ReadByte();
+		if (index >= m_baseline.size()) { return fail(); }
+		WP_QuantizedBody& base = m_baseline[index];
+		if (flags & NEW_ID)
+		{
+			if (base.m_bodyID == c_EmptySlot) { m_scratchIndices.push_back(index); }
+			base = WP_QuantizedBody{};
+			base.m_bodyID = reader.ReadVarint();
+			if ((base.m_bodyID & 0x7fffffu) != index) { return fail(); }
+			if (!(flags & FULL_POSITION) || !(flags & FULL_ROTATION)) { return fail(); }
+		}
+		else if (base.m_bodyID == c_EmptySlot) { return fail(); }
+		base.m_isActive = (flags & ACTIVE) != 0;
+
+		if (flags & FULL_POSITION)
+		{
+			for (int32_t& cell : base.m_cell) { cell = UnZigZag(reader.ReadVarint()); }
+			base.m_positionBits = reader.ReadByte();
+			if (base.m_positionBits < 1 || base.m_positionBits > 24) { return fail(); }
+			for (uint32_t& offset : base.m_offset) { offset = reader.ReadVarint(); }
+		}
+		else if (flags & POSITION)
+		{
+			for (uint32_t& offset : base.m_offset) { offset += static_cast<uint32_t>(UnZigZag(reader.ReadVarint())); }
+		}
+		if (flags & FULL_ROTATION)
+		{
+			base.m_largest = reader.ReadByte();
+			if (base.m_largest > 3) { return fail(); }
+			for (uint32_t& component : base.m_rotation) { component = reader.ReadVarint(); }
+		}
+		else if (flags & ROTATION)
+		{
+			for (uint32_t& component : base.m_rotation) { component += static_cast<uint32_t>(UnZigZag(reader.ReadVarint())); }
+		}
+		if (flags & VELOCITY)
+		{
+			for (int32_t& velocity : base.m_linearVelocity) { velocity += UnZigZag(reader.ReadVarint()); }
+			for (int32_t& velocity : base.m_angularVelocity) { velocity += UnZigZag(reader.ReadVarint()); }
+		}
+	}
+	if (!reader.m_isValid) { return fail(); }
+	m_sequence = sequence;
+
+	//surviving baseline slots merged with the new ones, both ascending
+	std::erase_if(m_baselineIndices, [this](uint32_t _index) { return m_baseline[_index].m_bodyID == c_EmptySlot; });
+	std::sort(m_scratchIndices.begin(), m_scratchIndices.end());
+	size_t const numOld = m_baselineIndices.size();
+	m_baselineIndices.insert(m_baselineIndices.end(), m_scratchIndices.begin(), m_scratchIndices.end());
+	std::inplace_merge(m_baselineIndices.begin(), m_baselineIndices.begin() + numOld, m_baselineIndices.end());
+
+	_outBodies.resize(m_baselineIndices.size());
+	for (size_t i{}; i < m_baselineIndices.size(); ++i)
+	{
+		Dequantize(m_baseline[m_baselineIndices[i]], _outBodies[i]);
+	}
+	return true;
+}
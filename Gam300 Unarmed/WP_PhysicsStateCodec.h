@@ -0,0 +1,109 @@
+#pragma once
+#include <WP_CoreComponents/WP_Physics.h>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+//side of a position cell in metres, positions are stored as cell + quantized offset in the cell
+#ifndef WP_PHYSICS_SNAPSHOT_CELL_SIZE
+#define WP_PHYSICS_SNAPSHOT_CELL_SIZE 64.0f
+#endif
+
+//bits per axis of the offset in a cell, 16 bits of a 64 m cell is 1 mm
+#ifndef WP_PHYSICS_SNAPSHOT_POSITION_BITS
+#define WP_PHYSICS_SNAPSHOT_POSITION_BITS 16
+#endif
+
+//a keyframe is written after this many delta snapshots, so a lost or skipped snapshot recovers
+#ifndef WP_PHYSICS_SNAPSHOT_KEYFRAME_INTERVAL
+#define WP_PHYSICS_SNAPSHOT_KEYFRAME_INTERVAL 60
+#endif
+
+//Compact encoding of the physics body state for play/stop, rewind and replays.
+//Positions are quantized to a world cell and a fixed point offset in that cell, the offset
+//precision can be raised or lowered per cell. Rotations use smallest three: the largest quaternion
+//component is dropped and rebuilt from the other three. Velocities are quantized to a fixed range.
+//
+//Every snapshot after a keyframe is a delta against the previous snapshot of the same codec:
+//changed values are written as zig-zag varint differences, sleeping bodies that did not move since
+//the baseline are not written at all and removed bodies are listed by index. Decoding needs the
+//same baseline, so a codec instance encodes one stream and another decodes it, in order.
+//Bodies are identified by their JPH::BodyID index and sequence number and must be passed sorted by index.
+//Not thread safe, one thread per codec.
+class WP_PhysicsStateCodec
+{
+public:
+	struct WP_Settings
+	{
+		float		m_cellSize = WP_PHYSICS_SNAPSHOT_CELL_SIZE;
+		uint8_t		m_positionBits = WP_PHYSICS_SNAPSHOT_POSITION_BITS;		//default per axis, 1 to 24
+		uint8_t		m_rotationBits = 12;									//per smallest three component, 1 to 20
+		uint8_t		m_linearVelocityBits = 14;								//per axis, signed, 2 to 24
+		uint8_t		m_angularVelocityBits = 12;
+		float		m_maxLinearVelocity = 128.f;							//clamped beyond
+		float		m_maxAngularVelocity = 64.f;
+		uint32_t	m_keyframeInterval = WP_PHYSICS_SNAPSHOT_KEYFRAME_INTERVAL;	//0 = only the first snapshot
+	};
+
+	struct WP_BodyState
+	{
+		uint32_t	m_bodyID;				//JPH::BodyID index and sequence number
+		glm::vec3	m_position;
+		glm::quat	m_rotation;
+		glm::vec3	m_linearVelocity;
+		glm::vec3	m_angularVelocity;
+		bool		m_isActive;
+	};
+
+	//_maxBodies bounds the body index, default settings until SetSettings
+	explicit WP_PhysicsStateCodec(uint32_t _maxBodies);
+
+	//settings are written into each snapshot, changing them forces the next snapshot to be a keyframe
+	void					SetSettings(WP_Settings const& _settings);
+	WP_Settings const&		GetSettings() const { return m_settings; }
+	//precision of the cell containing _cell * cell size, 0 restores the default
+	void					SetCellPrecision(glm::ivec3 const& _cell, uint8_t _positionBits);
+	void					ClearCellPrecisions();
+
+	//appends one snapshot of _bodies (sorted by index) to _out
+	void					Encode(std::span<const WP_BodyState> _bodies, std::vector<uint8_t>& _out, bool _isKeyframe = false);
+	//full dequantized state of every body after _snapshot, sorted by index.
+	//false if the snapshot is corrupt or is a delta against a baseline this codec does not hold
+	bool					Decode(std::span<const uint8_t> _snapshot, std::vector<WP_BodyState>& _outBodies);
+	//forget the baseline, the next encode is a keyframe and the next decode must be one
+	void					Reset();
+
+	uint32_t				GetSequence() const { return m_sequence; }	//of the last snapshot encoded or decoded
+
+private:
+	struct WP_QuantizedBody
+	{
+		uint32_t	m_bodyID = c_EmptySlot;
+		int32_t		m_cell[3];
+		uint32_t	m_offset[3];
+		uint8_t		m_positionBits;
+		uint8_t		m_largest;				//smallest three, index of the dropped component
+		uint32_t	m_rotation[3];
+		int32_t		m_linearVelocity[3];
+		int32_t		m_angularVelocity[3];
+		bool		m_isActive;
+	};
+	static constexpr uint32_t	c_EmptySlot = 0xffffffffu;
+	static constexpr uint32_t	c_Version = 1;
+
+	static uint64_t			CellKey(int32_t _x, int32_t _y, int32_t _z);
+	uint8_t					GetPositionBits(int32_t const (&_cell)[3]) const;
+	void					Quantize(WP_BodyState const& _body, WP_QuantizedBody& _out) const;
+	void					Dequantize(WP_QuantizedBody const& _body, WP_BodyState& _out) const;
+	bool					ReadSettings(std::span<const uint8_t> _snapshot, size_t& _cursor);
+
+	WP_Settings										m_settings;
+	std::unordered_map<uint64_t, uint8_t>			m_cellPrecisions;		//cell key to position bits, overrides only
+	std::vector<WP_QuantizedBody>					m_baseline;				//per body index, last snapshot
+	std::vector<uint32_t>							m_baselineIndices;		//filled slots of m_baseline, ascending
+	std::vector<uint32_t>							m_scratchIndices;
+	uint32_t										m_sequence = 0;			//0 = no baseline
+	uint32_t										m_numSinceKeyframe = 0;
+	bool											m_isKeyframeForced = true;
+};
@@ -1,8 +1,18 @@
 
 #include <WP_EngineSystem/WP_PhysicsSystem.h>
+#include <WP_EngineSystem/WP_PhysicsJobSystem.h>
 #include <WP_CoreComponents/WP_Transform3D.h>
 #include <WP_EngineSystem/WP_TimerSystem.h>
 #include <WP_ECS/WP_ComponentSystem.h>
+#include <Jolt/Core/StreamWrapper.h>
+#include <Jolt/Physics/Body/BodyLock.h>
+#include <Jolt/Physics/Collision/CollideShape.h>
+#include <Jolt/Physics/Collision/Shape/DecoratedShape.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <thread>
 
 //#include <HelloWorldJolt.h>
 
@@ -37,6 +47,24 @@ assert(pComp);																						\
 #ifndef MAX_PHYSICS_STEPS	//use this for modulo operations.
 #define MAX_PHYSICS_STEPS (MAX_PHYSICS_UPDATES_PER_FRAME * m_maxPhysicsSteps + 1)
 #endif
+
+//if OnContactAdded / OnContactRemoved should notify on every manifold from the physics threads (old behaviour).
+//added and removed contacts are aggregated per body pair and sent once per frame instead.
+#ifndef WP_PHYSICS_IMMEDIATE_CONTACT_NOTIFY
+#define WP_PHYSICS_IMMEDIATE_CONTACT_NOTIFY 0
+#endif
+
+//if tracked sensors should stay in the simulation and keep sending contact events (old behaviour).
+//off by default, the sensor tracker reports them without contact constraints or manifolds.
+#ifndef WP_PHYSICS_SENSOR_CONTACT_EVENTS
+#define WP_PHYSICS_SENSOR_CONTACT_EVENTS 0
+#endif
+
+//if OnContactPersisted should notify on every collision step from the physics threads (old behaviour).
+//persisted contacts are aggregated per body pair and sent once per frame instead.
+#ifndef WP_PHYSICS_IMMEDIATE_PERSIST_NOTIFY
+#define WP_PHYSICS_IMMEDIATE_PERSIST_NOTIFY 0
+#endif
 }
 
 #ifndef DELAYED_PHYSICS_P1
@@ -407,6 +435,11 @@ namespace WP_Physics
 		//return _quat.Inversed();	//temporaru, until jph inverse function issue is identified. TODO
 	}
 
+	void HashCombine(size_t& _hash, size_t _value)
+	{
+		_hash ^= _value + 0x9e3779b97f4a7c15ull + (_hash << 6) + (_hash >> 2);
+	}
+
 	WP_ContactManifold::WP_ContactManifold(JPH::ContactManifold const& _manifold)
 		: m_penetrationDepth{ _manifold.mPenetrationDepth },
 		m_manifold{ _manifold },
@@ -480,11 +513,37 @@ namespace {
 }
 
 WP_PhysicsSystem::WP_PhysicsSystem()
-	:WP_EngineSystem{ WP_EngineSystem::s_kSystemAllExceptOnPauseStillUpdate, "WP_PhysicsSystem" }
+	:WP_EngineSystem{ WP_EngineSystem::s_kSystemAllExceptOnPauseStillUpdate, "WP_PhysicsSystem" },
+	m_ObjectLayerPairFilter{ m_layerMatrix },
+	m_ObjectVsBroadPhaseLayerFilterImpl{ m_layerMatrix },
+	m_BPLayerInterfaceImpl{ m_layerMatrix },
+	m_snapshotEncoder{ cMaxBodies },
+	m_snapshotDecoder{ cMaxBodies }
 {
 	m_ContactListener.m_ContactAddedList.reserve(1024);
 	m_ContactListener.m_ContactPersistList.reserve(1024);
 	m_ContactListener.m_ContactRemovedList.reserve(1024);
+	m_awakeObjects.reserve(1024);
+	m_awakeObjectIndex.reserve(1024);
+	for (WP_BodyStateBuffer& buffer : m_snapshots)
+	{	//sized once to the body limit so a slot is the body index
+		buffer.m_bodyIDs.assign(cMaxBodies, JPH::BodyID::cInvalidBodyID);
+		buffer.m_positions.resize(cMaxBodies);
+		buffer.m_rotations.resize(cMaxBodies);
+		buffer.m_linearVelocities.resize(cMaxBodies);
+		buffer.m_angularVelocities.resize(cMaxBodies);
+		buffer.m_motionTypes.resize(cMaxBodies);
+		buffer.m_isActive.resize(cMaxBodies);
+		buffer.m_writtenSlots.reserve(cMaxBodies);
+	}
+	m_snapshotDirty.assign(cMaxBodies, 0);
+	m_snapshotBodies.reserve(cMaxBodies);
+	m_bodyScales.resize(cMaxBodies);
+	m_islandParent.resize(cMaxBodies);
+	std::iota(m_islandParent.begin(), m_islandParent.end(), 0u);
+	m_islandNumBodies.assign(cMaxBodies, 0);
+	m_islandNumContacts.assign(cMaxBodies, 0);
+	m_islandTouched.reserve(cMaxBodies);
 
 
 	// Register allocation hook. In this example we'll just let Jolt use malloc / free but you can override these if you want (see Memory.h).
@@ -505,13 +564,11 @@ WP_PhysicsSystem::WP_PhysicsSystem()
 	// If you implement your own default material (PhysicsMaterial::sDefault) make sure to initialize it before this function or else this function will create one for you.
 	JPH::RegisterTypes();
 
-	temp_allocator = std::make_unique<JPH::TempAllocatorImpl>(10 * 1024 * 1024);
+	temp_allocator = std::make_unique<WP_PhysicsTempAllocator>(WP_PHYSICS_TEMP_ALLOCATOR_SIZE);
 
 #if JPH_MULTI_THREAD
-	job_system = std::make_unique<JPH::JobSystemThreadPool>(
-		JPH::cMaxPhysicsJobs, 
-		JPH::cMaxPhysicsBarriers,
-		(int)(thread::hardware_concurrency()) - 1);
+	//physics jobs run on the engine workers, shared with every other system
+	job_system = std::make_unique<WP_PhysicsJobSystem>(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers);
 #else
 	job_system = std::make_unique<JPH::JobSystemSingleThreaded>(JPH::cMaxPhysicsJobs);
 #endif
@@ -519,12 +576,23 @@ WP_PhysicsSystem::WP_PhysicsSystem()
 	//m_physics_system.OptimizeBroadPhase();
 
 
+	//layer matrix must be final before Init, jolt caches the broadphase layer count
+	m_layerMatrix.LoadFromFile(WP_PHYSICS_LAYER_CONFIG_PATH);
+	if (!WP_PhysicsProjectiles::GetIsDefaultQueryValid(m_layerMatrix))
+	{	//a config that moved the static layers would let default projectiles fly through the level
+		WP_ERROR("Default projectiles do not hit the NON_MOVING tree with this layer config. WP_PhysicsSystem::WP_PhysicsSystem()");
+		assert(false);
+	}
+
 	m_physics_system.Init(cMaxBodies, cNumBodyMutexes, cMaxBodyPairs, cMaxContactConstraints,
 		m_BPLayerInterfaceImpl, m_ObjectVsBroadPhaseLayerFilterImpl, m_ObjectLayerPairFilter);
+	m_prediction.Init(m_BPLayerInterfaceImpl, m_ObjectVsBroadPhaseLayerFilterImpl, m_ObjectLayerPairFilter);
 
 	m_physics_system.SetBodyActivationListener(&m_BodyActivationListener);
 
 	m_physics_system.SetContactListener(&m_ContactListener);
+	m_physics_system.AddStepListener(&m_ContactListener);
+	m_physics_system.AddStepListener(&m_forceFieldListener);
 
 	m_physics_system.SetGravity(JPH::Vec3(0, -9.81f, 0));
 
@@ -624,22 +692,66 @@ void WP_PhysicsSystem::OnEngineRun()
 #endif
 	//for ALL components regardless of usage state
 	auto& phyCompVec = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponentVector();
+	std::vector<WP_Physics3D*> staticColliders;
 	for (auto t : phyCompVec)
 	{	//Trans -> Physics
-		t->AddBody();
-		m_bodyToID[t->m_bID.GetIndex()] = t->GetGameObjectID();
+		if ((m_isStreamingEnabled || m_isStaticBakeEnabled) && t->m_isPureStatic && !t->m_isTrigger && !t->m_isNPC)
+		{	//streamed or merged per cell below
+			staticColliders.push_back(t);
+			continue;
+		}
+		AddComponentBody(*t);
+	}
+	if (m_bodyPoolLayers)
+	{	//room for the first burst of debris, one prewarm per distinct key in the scene
+		std::vector<WP_BodyPoolKey> prewarmed;
+		for (auto t : phyCompVec)
+		{
+			if (t->m_bID.IsInvalid() || t->m_isNPC || t->m_isStreamed || !GetIsPooledLayer(GetPhysicsBI().GetObjectLayer(t->m_bID))) { continue; }
+			JPH::BodyCreationSettings settings;
+			{
+				JPH::BodyLockRead lock{ m_physics_system.GetBodyLockInterface(), t->m_bID };
+				if (!lock.Succeeded() || lock.GetBody().IsSensor()) { continue; }
+				settings = lock.GetBody().GetBodyCreationSettings();
+			}
+			WP_BodyPoolKey const key = MakeBodyPoolKey(settings.GetShape(), settings.mObjectLayer, settings.mMotionType);
+			if (std::find(prewarmed.begin(), prewarmed.end(), key) != prewarmed.end()) { continue; }
+			prewarmed.push_back(key);
+			PrewarmBodyPool(settings, WP_PHYSICS_BODY_POOL_PREWARM);
+		}
+		ResetBodyPoolStats();	//scene bodies above were all misses, count from the first spawn
+	}
+	if (m_isStreamingEnabled)
+	{
+		BuildStreamCells(staticColliders);
+		UpdateStreaming(true);	//cells around the focus are loaded before the first step
+	}
+	else
+	{
+		BakeStaticColliders(staticColliders);
 	}
 	m_physics_system.OptimizeBroadPhase();
+	PublishBodySnapshot();
+	m_flightRecorderCooldown = m_flightRecorder.GetCapacity();	//loading frames are not hitches
 }
 
 void WP_PhysicsSystem::OnEngineStop()
 {
 	//for ALL components regardless of usage state
+	ClearStreamCells();		//streamed bodies are freed by their cells, not the components
+	ClearBakedCells();		//before the components, removing a baked one would rebake its cell
 	auto& phyCompVec = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponentVector();
 	for (auto t : phyCompVec)
 	{	//Trans -> Physics
 		t->RemoveBody();
 	}
+	if (m_bodyPoolStats.m_numAcquires)
+	{
+		WP_INFO("Body pool served %u of %u bodies (%.0f%%), %u destroyed on full keys. WP_PhysicsSystem::OnEngineStop()",
+			m_bodyPoolStats.m_numHits, m_bodyPoolStats.m_numAcquires, m_bodyPoolStats.GetHitRate() * 100.f, m_bodyPoolStats.m_numOverflows);
+	}
+	ClearBodyPool();		//after the components, they park their bodies here
+	ResetBodyPoolStats();
 #if USE_TEST_SHAPES
 	RemoveTestShapes();
 #endif
@@ -648,6 +760,24 @@ void WP_PhysicsSystem::OnEngineStop()
 	m_physics_system.Update(0.167f, 1, &*temp_allocator, &*job_system);
 	m_isPhysicsReloaded = false;
 	m_bodyToID.clear();
+	m_bodyLODs.clear();		//bodies are gone, nothing to restore
+	ClearBodyScales();
+	m_lodFrame = 0;
+	InvalidateRayCache();
+	ClearAwakeObjects();
+	ClearSensors();
+	m_ContactListener.ClearContacts();
+	PublishBodySnapshot();	//bodies are gone, publish the empty world
+	//scene is gone, gameobject ids will be reused
+	m_contactSubscribers.clear();
+	m_contactSubscriptionOwner.clear();
+	m_pendingContactSubscribers.clear();
+	m_pendingContactUnsubscribes.clear();
+	ClearForceFields();
+	m_projectiles.Clear();
+	m_prediction.Clear();
+	ClearIgnoredContacts();		//bodies are gone, layer filters stay
+	ResetStateSnapshots();
 }
 
 //void WP_PhysicsSystem::OnEngineRun([[maybe_unused]] EventPayload* const _payload)
@@ -691,905 +821,3566 @@ WP_GameObjectID WP_PhysicsSystem::GetIDfromBodyID(uint32_t _bID)
 
 bool WP_PhysicsSystem::GetIsPhysicsLocked() const { return m_isPhysicsLocked; }
 
-void WP_PhysicsSystem::OnUpdate()
+std::vector<WP_GameObjectID> const& WP_PhysicsSystem::GetAwakeObjects() const { return m_awakeObjects; }
+
+bool WP_PhysicsSystem::GetIsObjectAwake(WP_GameObjectID _id) const
 {
-	static unsigned int s_rollbackFrames = 0;
-	//================================================================
-	//					Actual Physics Update
-	//======================VVVVVVVVVVVVVVV===========================
-	// We simulate the physics world in discrete time steps. 60 Hz is a good rate to update the physics system.
-	const float cDeltaTime = WP_TimerSystem::GetInstance()->GetDT();
+	return m_awakeObjectIndex.find(_id) != m_awakeObjectIndex.end();
+}
 
-	// Now we're ready to simulate the body, keep simulating until it goes to sleep
-	//static JPH::uint step = 0;
-	//if (GetPhysicsBI().IsActive(sphere_id))	//remove before Milestone 1! M1_TODO
+//drain staged activation changes into the dense awake set. main thread only.
+void WP_PhysicsSystem::ApplyActivationChanges()
+{
+	m_BodyActivationListener.SwapStagedChanges(m_activationChanges);
+	for (auto const& change : m_activationChanges)
 	{
-		// Next step
-		//++step;
-
-		// Output current position and velocity of the sphere
-		//{
-			/*RVec3 position = GetPhysicsBI().GetCenterOfMassPosition(sphere_id);
-			Vec3 velocity = GetPhysicsBI().GetLinearVelocity(sphere_id);*/
-			//cout << "Step " << step << ": Position = (" << position.GetX() << ", " << position.GetY() << ", " << position.GetZ() << "), Velocity = (" << velocity.GetX() << ", " << velocity.GetY() << ", " << velocity.GetZ() << ")" << endl;
-		//}
-		// If you take larger steps than 1 / 60th of a second you need to do multiple collision steps in order to keep the simulation stable. Do 1 collision step per 1 / 60th of a second (round up).
-		const int cCollisionSteps = static_cast<int>(std::ceilf(cDeltaTime / (1.0f / 60.0f)));
-		int collisionStepsThisUpdate{cCollisionSteps};
-
-		//if collision steps exceed the max number of rollback frames, 
-		if (cCollisionSteps > (MAX_PHYSICS_UPDATES_PER_FRAME * m_maxPhysicsSteps))
-		{	//rollback all frames above max collision steps into next frame
-			s_rollbackFrames += (cCollisionSteps - MAX_PHYSICS_UPDATES_PER_FRAME * m_maxPhysicsSteps);
-			collisionStepsThisUpdate = MAX_PHYSICS_UPDATES_PER_FRAME * m_maxPhysicsSteps;
-		}
-		//if not max number of collision steps and there are some rollback frames, 
-		if (s_rollbackFrames > 0 && cCollisionSteps < (MAX_PHYSICS_UPDATES_PER_FRAME * m_maxPhysicsSteps))
-		{	//do some rollback frames 
-			int oldRollbackFrames = s_rollbackFrames;	//save old number of rollback frames
-			//make rollback frames the remainder after taking enough frames to make step the max amount of updates this frame
-			s_rollbackFrames = (cCollisionSteps + s_rollbackFrames) % MAX_PHYSICS_STEPS;
-			//make number of collision steps this frame to be the number of collision steps
-			collisionStepsThisUpdate = cCollisionSteps + oldRollbackFrames - s_rollbackFrames;
-		}
-
-		//auto& phyCompVec = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponentVector();
-		auto&& phyCompVec = WP_ComponentSystem::WP_ComponentSystemIterator<WP_Physics3D>();
-		for (WP_Physics3D& t : phyCompVec)
-		{	//Trans -> Physics
-			//TO_TEST: Point of failure, rotation and position offsets
-			using namespace WP_Physics;
-			auto transComp = WP_ComponentList<WP_Transform3D>::GetComponentList()->GetComponent(t.GetGameObjectID());
-
-			//Update with Non direct access to transform member variables. ideally through a function.
-			if (t.m_isNPC && t.m_charPtr)
-			{
-				t.m_charPtr->SetPositionAndRotation(
-					ToJoltVec3(transComp->m_position + WP_Physics::ToGLMVec3(t.m_posOffset)),
-					ToJoltQuat(glm::normalize(transComp->m_angle)) * t.m_rotOffset,
-					WP_ACTIVATION_IS_ACTIVE(GetPhysicsBI().IsActive(t.m_bID)));
-			}
-			else
-			{
-				GetPhysicsBI().SetPositionAndRotationWhenChanged(
-					t.m_bID ,
-					ToJoltVec3(transComp->m_position + WP_Physics::ToGLMVec3(t.m_posOffset)),
-					ToJoltQuat(glm::normalize(transComp->m_angle)) * t.m_rotOffset,
-					WP_ACTIVATION_IS_ACTIVE(GetPhysicsBI().IsActive(t.m_bID)));
-			}
-
-			//GetPhysicsBI().GetShape(t.m_bID)->ScaleShape(WP_Physics::ToJoltVec3(transComp->m_scale));
-#if 0
-			switch (t.m_shapeType)
-			{
-			case WP_PhysicsShape::CUBE:
-				//auto position = WP_Physics::ToJoltVec3(transComp->m_scale);
-				//GetPhysicsBI().GetTransformedShape(t.m_bID).SetShapeScale(WP_Physics::ToJoltVec3(transComp->m_scale));
+		auto bodyIter = m_bodyToID.find(change.m_bodyID.GetIndex());
+		if (bodyIter == m_bodyToID.end() || bodyIter->second == WP_INVALID_GAMEOBJECTID) { continue; }	//test shapes or removed bodies
+		WP_GameObjectID const id = bodyIter->second;
 
-				auto position = GetPhysicsBI().GetTransformedShape(t.m_bID).GetShapeScale();
-				auto scale = WP_Physics::ToJoltVec3(transComp->m_scale / t.m_LastScale);
-
-				if (GetPhysicsBI().GetShape(t.m_bID)->IsValidScale(WP_Physics::ToJoltVec3(transComp->m_scale)))
-				{
-					std::cout << "Valid scale" << std::endl;
-				}
-				{
-					GetPhysicsBI().GetShape(t.m_bID)->ScaleShape(WP_Physics::ToJoltVec3(transComp->m_scale));
-
-					cout << "ID [" << (t.m_bID.GetIndex()) << "]Step " << step << ": Scale = (" << position.GetX() << ", " << position.GetY() << ", " << position.GetZ() << ")" << endl;
-					//std::cout.flush();
-					//WP_Physics::ToJoltVec3(transComp->m_scale);
-					auto a = WP_Physics::ToJoltVec3(transComp->m_scale) / 2;
-					t.m_cubeSetting.mHalfExtent = a;
-					//auto b = t.m_cubeSetting.Create();
-					//GetPhysicsBI().SetShape(t.m_bID, t.m_cubeSetting.Create().Get(), true, WP_ACTIVATION_IS_ACTIVE(GetPhysicsBI().IsActive(t.m_bID)));
-					//GetPhysicsBI().GetTransformedShape(t.m_bID).SetShapeScale(WP_Physics::ToJoltVec3(transComp->m_scale));
-
-
-				}
-
-				break;
-				//Other cases TODO
-			default:
-				break;
-			}
-#endif
-			//t.m_LastScale = transComp->m_scale;
-			//auto a = GetPhysicsBI().GetShape(t.m_bID);
-			//RVec3 position = GetPhysicsBI().GetPosition(t.m_bID);
-			//Vec3 velocity = GetPhysicsBI().GetLinearVelocity(t.m_bID);
-			//cout << "ID [" << (t.m_bID.GetIndex()) << "]Step " << step << ": Position = (" << position.GetX() << ", " << position.GetY() << ", " << position.GetZ() << "), Velocity = (" << velocity.GetX() << ", " << velocity.GetY() << ", " << velocity.GetZ() << ")" << endl;
-		}
-		m_isPhysicsLocked = true;	//locked physics, all calls to setting functions are delayed
-		
-		while (cCollisionSteps && collisionStepsThisUpdate != 0)	//MAX_PHYSICS_UPDATES_PER_FRAME number of physics update loops
+		auto indexIter = m_awakeObjectIndex.find(id);
+		if (change.m_isActivated)
 		{
-			//find number of steps this update. must be less than hardware concurrency -1.
-			int steps = (collisionStepsThisUpdate % (m_maxPhysicsSteps + 1));
-			steps = (steps) ? steps: m_maxPhysicsSteps;
-			//find DT fraction to complete these steps
-			float thisUpdateDT = WP_TimerSystem::GetInstance()->GetFixedDT() * steps;
-			//remove these steps from the number of steps we need this frame.
-			collisionStepsThisUpdate -= steps;
-		// Step the world
-		if (steps)	//if no collisions this frame, skip update
-			m_physics_system.Update(thisUpdateDT, steps, &*temp_allocator, &*job_system);
+			if (indexIter != m_awakeObjectIndex.end()) { continue; }	//already awake
+			m_awakeObjectIndex.emplace(id, static_cast<uint32_t>(m_awakeObjects.size()));
+			m_awakeObjects.push_back(id);
+			continue;
 		}
 
-		
-		
-		m_isPhysicsLocked = false;	//unlocked physics
-		//run contact callback
-		m_ContactListener.CallbackAllContacts();
-		//remove contact event
-		m_ContactListener.ClearContacts();
-
-		for (auto& t : phyCompVec)
-		{//Physics -> Trans
-		// VVV this optimization is to be implemented TODO:
-		 //if (GetPhysicsBI().GetMotionType(t.m_bID) == JPH::EMotionType::Static) { continue; }	//if static object, skip updating the transforms cus no movement
-			//otherwise, update transform
-			auto transComp = WP_ComponentList<WP_Transform3D>::GetComponentList()->GetComponent(t.GetGameObjectID());
-//TO_TEST: Point of failure, rotation and position offsets
-			using namespace WP_Physics;
-			//Update with Non direct access to transform member variables. ideally through a function.
-			transComp->m_position = ToGLMVec3(GetPhysicsBI().GetPosition(t.m_bID)) - ToGLMVec3((t.m_posOffset));	//to be confirmed.
-			transComp->m_angle = ToGLMQuat(GetPhysicsBI().GetRotation(t.m_bID)) * inverse(ToGLMQuat(t.m_rotOffset));		//to be confirmed.
-
-			if (t.m_isNPC && t.m_charPtr)
-			{
-				t.m_charPtr->PostSimulation(t.m_maxSeperationDistance);
-			}
-		}
+		if (indexIter == m_awakeObjectIndex.end()) { continue; }		//already asleep
+		//swap and pop to keep the set dense
+		uint32_t const index = indexIter->second;
+		WP_GameObjectID const last = m_awakeObjects.back();
+		m_awakeObjects[index] = last;
+		m_awakeObjectIndex[last] = index;
+		m_awakeObjects.pop_back();
+		m_awakeObjectIndex.erase(id);
 	}
 }
 
+void WP_PhysicsSystem::ClearAwakeObjects()
+{
+	m_BodyActivationListener.ClearStagedChanges();
+	m_activationChanges.clear();
+	m_awakeObjects.clear();
+	m_awakeObjectIndex.clear();
+}
 
 //================================================================================
-//					JPH::Body Property retrieval functions
+//						Body state snapshot
 //================================================================================
-//Shape and factors settings
 
-WP_PhysicsShape		WP_PhysicsSystem::GetBodyPhysicsShape(WP_GameObjectID _id) const
+//Seqlock style double buffer. The main thread writes the unpublished buffer, its version is odd
+//while writing. A reader copies a slot and keeps it only if the version did not change meanwhile.
+void WP_PhysicsSystem::PublishBodySnapshot()
 {
+	uint32_t const target = 1u - m_publishedSnapshot.load(std::memory_order_relaxed);
+	WP_BodyStateBuffer& buffer = m_snapshots[target];
+	buffer.m_version.fetch_add(1, std::memory_order_relaxed);	//odd, readers of this buffer retry
+	std::atomic_thread_fence(std::memory_order_release);
+
+	//only clear the slots this buffer filled last time instead of the whole array
+	for (uint32_t slot : buffer.m_writtenSlots) { buffer.m_bodyIDs[slot] = JPH::BodyID::cInvalidBodyID; }
+	buffer.m_writtenSlots.clear();
+
+	//not stepping, so the bodies can be read without the body mutexes
+	m_physics_system.GetBodies(m_snapshotBodies);
+	JPH::BodyLockInterfaceNoLock const& lockInterface = m_physics_system.GetBodyLockInterfaceNoLock();
+	for (JPH::BodyID const& bodyID : m_snapshotBodies)
+	{
+		JPH::Body const* body = lockInterface.TryGetBody(bodyID);
+		if (!body) { continue; }
+		uint32_t const slot = bodyID.GetIndex();
+		buffer.m_bodyIDs[slot]				= bodyID.GetIndexAndSequenceNumber();
+		buffer.m_positions[slot]			= WP_Physics::ToGLMVec3(body->GetPosition());
+		buffer.m_rotations[slot]			= WP_Physics::ToGLMQuat(body->GetRotation());
+		buffer.m_linearVelocities[slot]		= WP_Physics::ToGLMVec3(body->GetLinearVelocity());
+		buffer.m_angularVelocities[slot]	= WP_Physics::ToGLMVec3(body->GetAngularVelocity());
+		buffer.m_motionTypes[slot]			= body->GetMotionType();
+		buffer.m_isActive[slot]				= body->IsActive();
+		buffer.m_writtenSlots.push_back(slot);
+	}
 
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		switch (GetPhysicsBI().GetShape(pComp->m_bID)->GetSubType()) {
-		case JPH::EShapeSubType::Box:
-			return WP_PhysicsShape::CUBE;
-		case JPH::EShapeSubType::Sphere:
-			return WP_PhysicsShape::SPHERE;
-		case JPH::EShapeSubType::Capsule:
-			return WP_PhysicsShape::CAPSULE;
-		case JPH::EShapeSubType::Cylinder:
-			return WP_PhysicsShape::CYLINDER;
-		default:
-			return WP_PhysicsShape::EMPTY;
-		}
+	buffer.m_version.fetch_add(1, std::memory_order_release);	//even, done
+	m_publishedSnapshot.store(target, std::memory_order_release);
+	m_snapshotFrame.fetch_add(1, std::memory_order_release);
+	std::fill(m_snapshotDirty.begin(), m_snapshotDirty.end(), uint8_t{ 0 });
 }
 
-float				WP_PhysicsSystem::GetBodyFriction(WP_GameObjectID _id) const
+void WP_PhysicsSystem::MarkSnapshotDirty(JPH::BodyID _bodyID)
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return GetPhysicsBI().GetFriction(pComp->m_bID);
+	if (_bodyID.IsInvalid()) { return; }
+	m_snapshotDirty[_bodyID.GetIndex()] = 1;
 }
 
-float				WP_PhysicsSystem::GetBodyRestitution(WP_GameObjectID _id) const
+//safe from any thread
+bool WP_PhysicsSystem::ReadBodySnapshot(JPH::BodyID _bodyID, WP_BodyState& _outState) const
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return GetPhysicsBI().GetRestitution(pComp->m_bID);
-}
+	if (_bodyID.IsInvalid() || _bodyID.GetIndex() >= cMaxBodies) { return false; }
+	uint32_t const slot = _bodyID.GetIndex();
+	//a retry only happens if the writer lapped the reader, which takes a full physics update
+	for (uint32_t attempt{}; attempt < 4; ++attempt)
+	{
+		WP_BodyStateBuffer const& buffer = m_snapshots[m_publishedSnapshot.load(std::memory_order_acquire)];
+		uint64_t const version = buffer.m_version.load(std::memory_order_acquire);
+		if (version & 1u) { continue; }	//being rewritten, the other buffer is published by now
 
-float				WP_PhysicsSystem::GetBodyGravityFactor(WP_GameObjectID _id) const
-{
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return GetPhysicsBI().GetGravityFactor(pComp->m_bID);
+		bool const isFound = buffer.m_bodyIDs[slot] == _bodyID.GetIndexAndSequenceNumber();
+		if (isFound)
+		{
+			_outState.m_position		= buffer.m_positions[slot];
+			_outState.m_rotation		= buffer.m_rotations[slot];
+			_outState.m_linearVelocity	= buffer.m_linearVelocities[slot];
+			_outState.m_angularVelocity	= buffer.m_angularVelocities[slot];
+			_outState.m_motionType		= buffer.m_motionTypes[slot];
+			_outState.m_isActive		= buffer.m_isActive[slot];
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (buffer.m_version.load(std::memory_order_relaxed) == version) { return isFound; }
+	}
+	return false;
 }
 
-bool				WP_PhysicsSystem::GetBodyActive(WP_GameObjectID _id) const
+//main thread getters only use the snapshot while it still matches the bodies
+bool WP_PhysicsSystem::TryReadSnapshot(JPH::BodyID _bodyID, WP_BodyState& _outState) const
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return GetPhysicsBI().IsActive(pComp->m_bID);
+	if (m_isPhysicsLocked || _bodyID.IsInvalid() || m_snapshotDirty[_bodyID.GetIndex()]) { return false; }
+	return ReadBodySnapshot(_bodyID, _outState);
 }
 
-//Other settings
-
-JPH::EMotionQuality WP_PhysicsSystem::GetBodyMotionQuality(WP_GameObjectID _id) const
-{
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return GetPhysicsBI().GetMotionQuality(pComp->m_bID);
-}
-JPH::EMotionType	WP_PhysicsSystem::GetBodyMotionType(WP_GameObjectID _id) const
-{
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return GetPhysicsBI().GetMotionType(pComp->m_bID);
-}
-JPH::ObjectLayer	WP_PhysicsSystem::GetBodyObjectLayer(WP_GameObjectID _id) const
-{
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return GetPhysicsBI().GetObjectLayer(pComp->m_bID);
-}
+uint64_t WP_PhysicsSystem::GetSnapshotFrame() const { return m_snapshotFrame.load(std::memory_order_acquire); }
 
-//Transform settings
+//================================================================================
+//						Static geometry bake
+//================================================================================
 
-glm::vec3			WP_PhysicsSystem::GetBodyPosition(WP_GameObjectID _id) const
+namespace
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		//return WP_Physics::ToGLMVec3(GetPhysicsBI().GetPosition(pComp->m_bID) + GetPhysicsBI().GetCenterOfMassPosition(pComp->m_bID));
-		return WP_Physics::ToGLMVec3(GetPhysicsBI().GetPosition(pComp->m_bID));
-}
+	constexpr uint32_t c_StaticBakeCacheVersion = 2;
 
-glm::vec3			WP_PhysicsSystem::GetBodyCenterMass(WP_GameObjectID _id) const
-{
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return WP_Physics::ToGLMVec3(GetPhysicsBI().GetCenterOfMassPosition(pComp->m_bID));
+	//colliders are only merged if they share all of the key, the body holds layer and surface
+	struct WP_StaticBakeKey
+	{
+		std::array<int32_t, 3>	m_cell;
+		JPH::ObjectLayer		m_layer;
+		float					m_friction;
+		float					m_restitution;
+		auto operator<=>(WP_StaticBakeKey const&) const = default;
+	};
+
+	struct WP_StaticBakeInput
+	{
+		WP_Physics3D*	m_comp;
+		JPH::ShapeRefC	m_shape;
+		JPH::Vec3		m_position;		//relative to the cell origin
+		JPH::Quat		m_rotation;
+	};
+
+	//FNV-1a, only used to tell if the static colliders changed since the cache was written
+	template <typename T>
+	void HashStaticBake(uint64_t& _hash, T const& _value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		unsigned char const* bytes = reinterpret_cast<unsigned char const*>(&_value);
+		for (size_t i{}; i < sizeof(T); ++i)
+		{
+			_hash = (_hash ^ bytes[i]) * 0x100000001B3ull;
+		}
+	}
 }
 
-//TODO: QUAT?
-glm::vec4			WP_PhysicsSystem::GetBodyRotation(WP_GameObjectID _id) const
+WP_GameObjectID WP_PhysicsSystem::GetIDfromSubShape(JPH::BodyID _bID, JPH::SubShapeID const& _subShapeID) const
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return WP_Physics::ToGLMVec4(GetPhysicsBI().GetRotation(pComp->m_bID));
+	if (auto cellIter = m_bakedCells.find(_bID.GetIndex()); cellIter != m_bakedCells.end())
+	{
+		WP_BakedCell const& cell = cellIter->second;
+		JPH::SubShapeID remainder;
+		uint32_t const subShape = cell.m_shape->GetSubShapeIndexFromID(_subShapeID, remainder);
+		return cell.m_subShapeToID[cell.m_shape->GetCompoundUserData(subShape)];
+	}
+	auto bodyIter = m_bodyToID.find(_bID.GetIndex());
+	return (bodyIter != m_bodyToID.end()) ? bodyIter->second : WP_INVALID_GAMEOBJECTID;
 }
 
-void				WP_PhysicsSystem::GetBodyPositionAndRotation(WP_GameObjectID _id, glm::vec3& _outPos, glm::vec4& _outRot) const
+void WP_PhysicsSystem::RefreshTransformBindings()
 {
-	_outPos = GetBodyPosition(_id);
-	_outRot = GetBodyRotation(_id);
+	size_t const numTransforms = WP_ComponentList<WP_Transform3D>::GetComponentList()->GetComponentVector().size();
+	size_t const numPhysics = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponentVector().size();
+	if (!m_isTransformBindingsDirty && numTransforms == m_numBoundTransforms && numPhysics == m_numBoundPhysics) { return; }
+	m_isTransformBindingsDirty = false;
+	m_numBoundTransforms = numTransforms;
+	m_numBoundPhysics = numPhysics;
+
+	m_transformBindings.clear();
+	auto&& phyCompVec = WP_ComponentSystem::WP_ComponentSystemIterator<WP_Physics3D>();
+	for (WP_Physics3D& t : phyCompVec)
+	{
+		if (t.m_isBaked || t.m_isStreamed || t.m_bID.IsInvalid()) { continue; }
+		WP_Transform3D* const transComp = WP_ComponentList<WP_Transform3D>::GetComponentList()->GetComponent(t.GetGameObjectID());
+		if (!transComp) { continue; }
+		m_transformBindings.push_back(WP_TransformBinding{ t.m_bID, t.GetGameObjectID(), &t, t.m_posOffset, t.m_rotOffset,
+			t.m_rotOffset.Conjugated(), t.m_isNPC && t.m_charPtr != nullptr, t.m_useTransformScale && !t.m_isNPC });
+	}
+	//same order as jolt's body array
+	std::sort(m_transformBindings.begin(), m_transformBindings.end(), [](WP_TransformBinding const& _lhs, WP_TransformBinding const& _rhs)
+		{
+			return _lhs.m_bID.GetIndex() < _rhs.m_bID.GetIndex();
+		});
 }
 
-glm::mat4x4			WP_PhysicsSystem::GetBodyWorldTransform(WP_GameObjectID _id) const
+size_t WP_PhysicsSystem::WP_ScaledShapeKeyHash::operator()(WP_ScaledShapeKey const& _key) const
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return WP_Physics::ToGLMMat4x4(GetPhysicsBI().GetWorldTransform(pComp->m_bID));
+	size_t hash = std::hash<JPH::Shape const*>{}(_key.m_baseShape);
+	for (int axis{}; axis < 3; ++axis) { WP_Physics::HashCombine(hash, std::hash<int>{}(_key.m_scale[axis])); }
+	return hash;
 }
 
-glm::mat4x4			WP_PhysicsSystem::GetBodyInverseInertia(WP_GameObjectID _id) const
+void WP_PhysicsSystem::SyncBodyScale(WP_TransformBinding const& _binding, WP_Transform3D const& _transform)
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return WP_Physics::ToGLMMat4x4(GetPhysicsBI().GetInverseInertia(pComp->m_bID));
-}
+	glm::vec3 const& scale = _transform.m_globalScale;
+	glm::ivec3 const quantized{ glm::round(scale / WP_PHYSICS_SCALE_QUANTUM) };
+	WP_BodyScale& bodyScale = m_bodyScales[_binding.m_bID.GetIndex()];
+	if (bodyScale.m_bID != _binding.m_bID)
+	{	//first sync of this body, its current shape was built for the current scale
+		JPH::RefConst<JPH::Shape> shape = GetPhysicsBI().GetShape(_binding.m_bID);
+		bodyScale.m_bID = _binding.m_bID;
+		bodyScale.m_baseShape = shape;
+		bodyScale.m_referenceScale = scale;
+		bodyScale.m_appliedScale = quantized;
+		bodyScale.m_massSettleFrames = 0;
+		if (shape->GetSubType() == JPH::EShapeSubType::Scaled)
+		{	//cooked meshes are already wrapped, scale their shared inner shape instead of nesting wrappers
+			JPH::ScaledShape const* const scaled = static_cast<JPH::ScaledShape const*>(shape.GetPtr());
+			glm::vec3 const created = WP_Physics::ToGLMVec3(scaled->GetScale());
+			if (glm::all(glm::greaterThan(glm::abs(created), glm::vec3{ WP_PHYSICS_SCALE_QUANTUM })))
+			{
+				bodyScale.m_baseShape = scaled->GetInnerShape();
+				bodyScale.m_referenceScale = scale / created;
+			}
+		}
+		return;
+	}
+	if (quantized == bodyScale.m_appliedScale) { return; }
+	//a zero axis can not be scaled back from, keep the last shape
+	if (glm::any(glm::lessThan(glm::abs(bodyScale.m_referenceScale), glm::vec3{ WP_PHYSICS_SCALE_QUANTUM }))
+		|| glm::any(glm::equal(quantized, glm::ivec3{ 0 })))
+	{
+		return;
+	}
+	bodyScale.m_appliedScale = quantized;
 
-//Velocity settings
+	JPH::Vec3 relative = WP_Physics::ToJoltVec3(glm::vec3{ quantized } * WP_PHYSICS_SCALE_QUANTUM / bodyScale.m_referenceScale);
+	if (!bodyScale.m_baseShape->IsValidScale(relative))
+	{	//spheres and capsules only scale uniformly, cover the largest axis
+		relative = JPH::Vec3::sReplicate(relative.Abs().ReduceMax());
+	}
+	JPH::RefConst<JPH::Shape> const shape = GetScaledShape(bodyScale.m_baseShape, relative);
+	if (!shape) { return; }
+	GetPhysicsBI().SetShape(_binding.m_bID, shape, false, JPH::EActivation::Activate);
+	if (m_isRayCacheEnabled) { InvalidateRayCache(); }
+
+	if (GetPhysicsBI().GetMotionType(_binding.m_bID) != JPH::EMotionType::Dynamic) { return; }
+	if (bodyScale.m_massSettleFrames == 0) { m_pendingMassBodies.push_back(_binding.m_bID); }
+	bodyScale.m_massSettleFrames = WP_PHYSICS_SCALE_MASS_SETTLE_FRAMES;
+}
 
-glm::vec3			WP_PhysicsSystem::GetBodyLinearVelocity(WP_GameObjectID _id) const
+JPH::RefConst<JPH::Shape> WP_PhysicsSystem::GetScaledShape(JPH::Shape const* _baseShape, JPH::Vec3Arg _scale)
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return WP_Physics::ToGLMVec3(GetPhysicsBI().GetLinearVelocity(pComp->m_bID));
+	WP_ScaledShapeKey const key{ _baseShape, glm::ivec3{ glm::round(WP_Physics::ToGLMVec3(_scale) / WP_PHYSICS_SCALE_QUANTUM) } };
+	if (key.m_scale == glm::ivec3{ static_cast<int>(std::round(1.f / WP_PHYSICS_SCALE_QUANTUM)) }) { return _baseShape; }	//back to the creation scale
+	if (auto iter = m_scaledShapes.find(key); iter != m_scaledShapes.end()) { return iter->second; }
+
+	if (m_scaledShapes.size() >= WP_PHYSICS_SCALED_SHAPE_CACHE_SIZE)
+	{	//animated scales leave a trail of one off wrappers, drop the ones only the cache holds
+		std::erase_if(m_scaledShapes, [](auto const& _entry) { return _entry.second->GetRefCount() == 1; });
+	}
+	JPH::ShapeSettings::ShapeResult const result = JPH::ScaledShapeSettings(_baseShape, _scale).Create();
+	if (!result.IsValid())
+	{
+		WP_WARN("Failed to scale shape: %s. WP_PhysicsSystem::GetScaledShape()", result.GetError().c_str());
+		return nullptr;
+	}
+	return m_scaledShapes.emplace(key, result.Get()).first->second;
 }
 
-glm::vec3			WP_PhysicsSystem::GetBodyPointVelocity(WP_GameObjectID _id, glm::vec3 _point) const
+void WP_PhysicsSystem::UpdatePendingMass()
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return WP_Physics::ToGLMVec3(GetPhysicsBI().GetPointVelocity(pComp->m_bID, WP_Physics::ToJoltVec3(_point)));
+	for (size_t i{}; i < m_pendingMassBodies.size();)
+	{
+		JPH::BodyID const bID = m_pendingMassBodies[i];
+		WP_BodyScale& bodyScale = m_bodyScales[bID.GetIndex()];
+		if (bodyScale.m_bID == bID && --bodyScale.m_massSettleFrames > 0) { ++i; continue; }
+		if (bodyScale.m_bID == bID)
+		{	//scale held long enough, mass and inertia follow the scaled shape
+			JPH::BodyLockWrite lock{ m_physics_system.GetBodyLockInterface(), bID };
+			if (lock.Succeeded() && lock.GetBody().IsDynamic())
+			{
+				JPH::Body& body = lock.GetBody();
+				JPH::MotionProperties* const motion = body.GetMotionProperties();
+				motion->SetMassProperties(motion->GetAllowedDOFs(), body.GetShape()->GetMassProperties());
+			}
+		}
+		m_pendingMassBodies[i] = m_pendingMassBodies.back();	//order does not matter
+		m_pendingMassBodies.pop_back();
+	}
 }
 
-glm::vec3			WP_PhysicsSystem::GetBodyAngularVelocity(WP_GameObjectID _id) const
+void WP_PhysicsSystem::ClearBodyScales()
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		return WP_Physics::ToGLMVec3(GetPhysicsBI().GetAngularVelocity(pComp->m_bID));
+	for (WP_BodyScale& bodyScale : m_bodyScales)
+	{
+		bodyScale.m_bID = JPH::BodyID{};
+		bodyScale.m_baseShape = nullptr;
+	}
+	m_pendingMassBodies.clear();
+	m_scaledShapes.clear();
 }
 
-void				WP_PhysicsSystem::GetBodyLinearAndAngularVelocity(WP_GameObjectID _id, glm::vec3& _outLinearVel, glm::vec3& _outAngularVel) const
+void WP_PhysicsSystem::AddComponentBody(WP_Physics3D& _comp)
 {
-	_outLinearVel = GetBodyLinearVelocity(_id);
-	_outAngularVel = GetBodyAngularVelocity(_id);
+	_comp.AddBody();
+	m_bodyToID[_comp.m_bID.GetIndex()] = _comp.GetGameObjectID();
+	if (m_isRayCacheEnabled) { InvalidateRayCache(); }	//new body, cached misses may now hit
+	if (!_comp.m_bID.IsInvalid()) { m_bodyScales[_comp.m_bID.GetIndex()].m_bID = JPH::BodyID{}; }	//pooled bodies keep their id, recapture the base
 }
 
+void WP_PhysicsSystem::BakeStaticColliders(std::vector<WP_Physics3D*> const& _colliders, bool _isCacheUsed)
+{
+	using namespace WP_Physics;
+	constexpr float cellSize = WP_PHYSICS_STATIC_BAKE_CELL_SIZE;
 
-//================================================================================
-//					JPH::Body Property mutator functions
-//================================================================================
+	//group by cell, same placement as the transform -> physics sync in OnUpdate
+	std::map<WP_StaticBakeKey, std::vector<WP_StaticBakeInput>> groups;
+	for (WP_Physics3D* comp : _colliders)
+	{
+		auto* transComp = WP_ComponentList<WP_Transform3D>::GetComponentList()->GetComponent(comp->GetGameObjectID());
+		JPH::ShapeSettings::ShapeResult shapeResult = comp->CreateShape();
+		if (!transComp || !shapeResult.IsValid())
+		{
+			AddComponentBody(*comp);
+			continue;
+		}
+		glm::vec3 const position = transComp->m_position + ToGLMVec3(comp->m_posOffset);
+		WP_StaticBakeKey key{};
+		for (int axis{}; axis < 3; ++axis)
+		{
+			key.m_cell[axis] = static_cast<int32_t>(std::floor(position[axis] / cellSize));
+		}
+		key.m_layer = comp->m_objectLayer;
+		key.m_friction = comp->m_friction;
+		key.m_restitution = comp->m_restitution;
+
+		glm::vec3 const cellOrigin = glm::vec3(key.m_cell[0], key.m_cell[1], key.m_cell[2]) * cellSize;
+		groups[key].push_back(WP_StaticBakeInput{ comp, shapeResult.Get(),
+			ToJoltVec3(position - cellOrigin),
+			ToJoltQuat(glm::normalize(transComp->m_angle)) * comp->m_rotOffset });
+	}
+
+	//small groups are not worth a compound, hash the rest to validate the cache
+	uint64_t inputHash = 0xCBF29CE484222325ull;
+	uint32_t numBakedGroups{};
+	for (auto& [key, inputs] : groups)
+	{
+		if (inputs.size() < WP_PHYSICS_STATIC_BAKE_MIN_COLLIDERS)
+		{
+			for (auto const& input : inputs) { AddComponentBody(*input.m_comp); }
+			inputs.clear();
+			continue;
+		}
+		++numBakedGroups;
+		HashStaticBake(inputHash, key.m_cell);
+		HashStaticBake(inputHash, key.m_layer);
+		HashStaticBake(inputHash, key.m_friction);
+		HashStaticBake(inputHash, key.m_restitution);
+		for (auto const& input : inputs)
+		{
+			JPH::AABox const bounds = input.m_shape->GetLocalBounds();
+			HashStaticBake(inputHash, input.m_comp->GetGameObjectID());
+			HashStaticBake(inputHash, input.m_shape->GetSubType());
+			JPH::Shape const* cooked = input.m_shape;
+			if (cooked->GetSubType() == JPH::EShapeSubType::Scaled) { cooked = static_cast<JPH::ScaledShape const*>(cooked)->GetInnerShape(); }
+			HashStaticBake(inputHash, m_meshCooker.GetContentHash(cooked));		//an edited mesh can keep its bounds
+			HashStaticBake(inputHash, ToGLMVec3(bounds.mMin));
+			HashStaticBake(inputHash, ToGLMVec3(bounds.mMax));
+			HashStaticBake(inputHash, ToGLMVec3(input.m_position));
+			HashStaticBake(inputHash, ToGLMQuat(input.m_rotation));
+		}
+	}
+	if (!numBakedGroups) { return; }
+
+	//load baked shapes, in group order
+	std::vector<JPH::RefConst<JPH::StaticCompoundShape>> cachedShapes;
+	if (_isCacheUsed && !m_staticBakeCachePath.empty())
+	{
+		std::ifstream file{ m_staticBakeCachePath, std::ios::binary };
+		JPH::StreamInWrapper stream{ file };
+		uint32_t version{}, numCells{};
+		uint64_t hash{};
+		stream.Read(version);
+		stream.Read(hash);
+		stream.Read(numCells);
+		if (file.is_open() && !stream.IsFailed() && version == c_StaticBakeCacheVersion && hash == inputHash && numCells == numBakedGroups)
+		{
+			JPH::Shape::IDToShapeMap shapeMap;
+			JPH::Shape::IDToMaterialMap materialMap;
+			for (uint32_t i{}; i < numCells; ++i)
+			{
+				JPH::Shape::ShapeResult result = JPH::Shape::sRestoreWithChildren(stream, shapeMap, materialMap);
+				if (!result.IsValid() || result.Get()->GetSubType() != JPH::EShapeSubType::StaticCompound) { break; }
+				cachedShapes.push_back(static_cast<JPH::StaticCompoundShape const*>(result.Get().GetPtr()));
+			}
+			if (cachedShapes.size() != numCells)
+			{
+				WP_WARN("Static bake cache is corrupt, rebaking. WP_PhysicsSystem::BakeStaticColliders()");
+				cachedShapes.clear();
+			}
+		}
+	}
+
+	std::vector<JPH::RefConst<JPH::StaticCompoundShape>> bakedShapes;	//group order, written to the cache
+	bool isBakeComplete = true;
+	uint32_t groupIndex{};
+	for (auto const& [key, inputs] : groups)
+	{
+		if (inputs.empty()) { continue; }
+
+		WP_BakedCell cell;
+		cell.m_subShapeToID.reserve(inputs.size());
+		if (!cachedShapes.empty())
+		{
+			cell.m_shape = cachedShapes[groupIndex];
+			for (auto const& input : inputs) { cell.m_subShapeToID.push_back(input.m_comp->GetGameObjectID()); }
+		}
+		else
+		{
+			JPH::StaticCompoundShapeSettings settings;
+			for (auto const& input : inputs)
+			{	//sub shapes get reordered by the build, user data maps them back to the gameobject
+				settings.AddShape(input.m_position, input.m_rotation, input.m_shape, static_cast<uint32_t>(cell.m_subShapeToID.size()));
+				cell.m_subShapeToID.push_back(input.m_comp->GetGameObjectID());
+			}
+			JPH::Shape::ShapeResult result = settings.Create();
+			if (result.IsValid())
+			{
+				cell.m_shape = static_cast<JPH::StaticCompoundShape const*>(result.Get().GetPtr());
+			}
+		}
+		++groupIndex;
+		bakedShapes.push_back(cell.m_shape);
+
+		if (cell.m_shape)
+		{
+			glm::vec3 const cellOrigin = glm::vec3(key.m_cell[0], key.m_cell[1], key.m_cell[2]) * cellSize;
+			JPH::BodyCreationSettings bodySettings{ cell.m_shape.GetPtr(), ToJoltVec3(cellOrigin), JPH::Quat::sIdentity(),
+				JPH::EMotionType::Static, key.m_layer };
+			bodySettings.mFriction = key.m_friction;
+			bodySettings.mRestitution = key.m_restitution;
+			cell.m_bID = GetPhysicsBI().CreateAndAddBody(bodySettings, JPH::EActivation::DontActivate);
+		}
+		if (cell.m_bID.IsInvalid())
+		{
+			WP_ERROR("Failed to bake static cell, using separate bodies. WP_PhysicsSystem::BakeStaticColliders()");
+			for (auto const& input : inputs) { AddComponentBody(*input.m_comp); }
+			isBakeComplete = false;
+			continue;
+		}
+
+		for (auto const& input : inputs) { input.m_comp->m_isBaked = true; }
+		m_bodyToID[cell.m_bID.GetIndex()] = WP_INVALID_GAMEOBJECTID;	//sub shapes resolve through GetIDfromSubShape
+		m_bakedCells.emplace(cell.m_bID.GetIndex(), std::move(cell));
+	}
+
+	//write the cache only after a complete fresh bake, a partial cache would never match
+	if (_isCacheUsed && !m_staticBakeCachePath.empty() && cachedShapes.empty() && isBakeComplete)
+	{
+		std::ofstream file{ m_staticBakeCachePath, std::ios::binary | std::ios::trunc };
+		JPH::StreamOutWrapper stream{ file };
+		stream.Write(c_StaticBakeCacheVersion);
+		stream.Write(inputHash);
+		stream.Write(numBakedGroups);
+		JPH::Shape::ShapeToIDMap shapeMap;
+		JPH::Shape::MaterialToIDMap materialMap;
+		for (auto const& shape : bakedShapes) { shape->SaveWithChildren(stream, shapeMap, materialMap); }
+		if (stream.IsFailed())
+		{
+			WP_WARN("Failed to write static bake cache. WP_PhysicsSystem::BakeStaticColliders()");
+			file.close();
+			std::remove(m_staticBakeCachePath.c_str());
+		}
+	}
+	WP_INFO("Baked %u static colliders into %u cells. WP_PhysicsSystem::BakeStaticColliders()",
+		static_cast<uint32_t>(_colliders.size()), static_cast<uint32_t>(m_bakedCells.size()));
+}
+
+void WP_PhysicsSystem::UnbakeCollider(WP_Physics3D& _comp, bool _isKeptAsBody)
+{
+	WP_GameObjectID const id = _comp.GetGameObjectID();
+	_comp.m_isBaked = false;
+	auto cellIter = std::find_if(m_bakedCells.begin(), m_bakedCells.end(), [id](auto const& _entry)
+		{
+			std::vector<WP_GameObjectID> const& members = _entry.second.m_subShapeToID;
+			return std::find(members.begin(), members.end(), id) != members.end();
+		});
+	if (cellIter != m_bakedCells.end())
+	{	//a compound can not drop a sub shape, take the cell apart and bake the rest again
+		WP_BakedCell const cell = std::move(cellIter->second);
+		m_bakedCells.erase(cellIter);
+		GetPhysicsBI().RemoveBody(cell.m_bID);
+		GetPhysicsBI().DestroyBody(cell.m_bID);
+		m_bodyToID.erase(cell.m_bID.GetIndex());
+		MarkSnapshotDirty(cell.m_bID);
+
+		auto* const list = WP_ComponentList<WP_Physics3D>::GetComponentList();
+		std::vector<WP_Physics3D*> others;
+		others.reserve(cell.m_subShapeToID.size());
+		for (WP_GameObjectID memberID : cell.m_subShapeToID)
+		{
+			WP_Physics3D* const member = (memberID != id) ? list->GetComponent(memberID) : nullptr;
+			if (!member) { continue; }
+			member->m_isBaked = false;
+			others.push_back(member);
+		}
+		//too few left for a compound become separate bodies, the scene cache stays for the next run
+		if (!others.empty()) { BakeStaticColliders(others, false); }
+	}
+	if (_isKeptAsBody) { AddComponentBody(_comp); }
+	MarkTransformBindingsDirty();
+	if (m_isRayCacheEnabled) { InvalidateRayCache(); }
+}
+
+void WP_PhysicsSystem::ClearBakedCells()
+{
+	auto* const list = WP_ComponentList<WP_Physics3D>::GetComponentList();
+	for (auto& [bodyIndex, cell] : m_bakedCells)
+	{
+		GetPhysicsBI().RemoveBody(cell.m_bID);
+		GetPhysicsBI().DestroyBody(cell.m_bID);
+		for (WP_GameObjectID id : cell.m_subShapeToID)
+		{
+			if (WP_Physics3D* pComp = list->GetComponent(id)) { pComp->m_isBaked = false; }
+		}
+	}
+	m_bakedCells.clear();
+}
+
+void WP_PhysicsSystem::BuildStreamCells(std::vector<WP_Physics3D*> const& _colliders)
+{
+	using namespace WP_Physics;
+	constexpr float cellSize = WP_PHYSICS_STREAMING_CELL_SIZE;
+
+	std::map<std::array<int32_t, 3>, std::vector<WP_GameObjectID>> groups;
+	for (WP_Physics3D* comp : _colliders)
+	{
+		auto* transComp = WP_ComponentList<WP_Transform3D>::GetComponentList()->GetComponent(comp->GetGameObjectID());
+		if (!transComp)
+		{
+			AddComponentBody(*comp);
+			continue;
+		}
+		glm::vec3 const position = transComp->m_position + ToGLMVec3(comp->m_posOffset);
+		std::array<int32_t, 3> cell{};
+		for (int axis{}; axis < 3; ++axis)
+		{
+			cell[axis] = static_cast<int32_t>(std::floor(position[axis] / cellSize));
+		}
+		groups[cell].push_back(comp->GetGameObjectID());
+		comp->m_isStreamed = true;
+	}
+
+	for (auto& [cell, ids] : groups)
+	{
+		WP_StreamCell& streamCell = m_streamCells.emplace_back();
+		streamCell.m_min = glm::vec3(cell[0], cell[1], cell[2]) * cellSize;
+		streamCell.m_max = streamCell.m_min + glm::vec3(cellSize);
+		streamCell.m_ids = std::move(ids);
+	}
+	WP_INFO("Split %u static colliders into %u streaming cells. WP_PhysicsSystem::BuildStreamCells()",
+		static_cast<uint32_t>(_colliders.size()), static_cast<uint32_t>(m_streamCells.size()));
+}
+
+void WP_PhysicsSystem::UpdateStreaming(bool _isBlocking)
+{
+	assert(!m_isPhysicsLocked);		//bodies can only be added and removed between steps
+	float const loadRadiusSq = WP_PHYSICS_STREAMING_LOAD_RADIUS * WP_PHYSICS_STREAMING_LOAD_RADIUS;
+	float const unloadRadiusSq = WP_PHYSICS_STREAMING_UNLOAD_RADIUS * WP_PHYSICS_STREAMING_UNLOAD_RADIUS;
+	bool isChanged = false;
+	for (WP_StreamCell& cell : m_streamCells)
+	{	//distance from the focus to the closest point of the cell
+		glm::vec3 const offset = glm::clamp(m_physicsFocus, cell.m_min, cell.m_max) - m_physicsFocus;
+		float const distanceSq = glm::dot(offset, offset);
+		switch (cell.m_state)
+		{
+		case WP_StreamCellState::UNLOADED:
+			if (distanceSq <= loadRadiusSq) { PrepareStreamCell(cell); }
+			break;
+		case WP_StreamCellState::LOADED:
+			if (distanceSq > unloadRadiusSq)
+			{
+				UnloadStreamCell(cell);
+				isChanged = true;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	//second pass so blocking loads also pick up cells queued above
+	for (WP_StreamCell& cell : m_streamCells)
+	{
+		if (cell.m_state != WP_StreamCellState::PREPARING) { continue; }
+		if (_isBlocking)
+		{
+			WP_JobSystem::GetInstance()->Wait(cell.m_jobCounter);
+		}
+		else if (!cell.m_jobCounter.IsDone())
+		{
+			continue;	//still creating bodies, try again next update
+		}
+		FinalizeStreamCell(cell);
+		isChanged = true;
+	}
+	if (isChanged && m_isRayCacheEnabled) { InvalidateRayCache(); }
+}
+
+void WP_PhysicsSystem::PrepareStreamCell(WP_StreamCell& _cell)
+{
+	using namespace WP_Physics;
+	if (_cell.m_settings.empty())
+	{	//shapes are created once on the main thread, the mesh cooker is not thread safe
+		auto* const list = WP_ComponentList<WP_Physics3D>::GetComponentList();
+		_cell.m_settings.reserve(_cell.m_ids.size());
+		for (WP_GameObjectID id : _cell.m_ids)
+		{
+			WP_Physics3D* pComp = list->GetComponent(id);
+			if (!pComp) { continue; }
+			JPH::ShapeSettings::ShapeResult shapeResult = pComp->CreateShape();
+			if (!shapeResult.IsValid()) { continue; }
+			JPH::BodyCreationSettings& settings = _cell.m_settings.emplace_back(pComp->CreateBodySettings(shapeResult));
+			settings.mUserData = id;
+		}
+	}
+	//placement is refreshed every load, same as the transform -> physics sync in OnUpdate.
+	//colliders whose component went away while unloaded are dropped instead of streamed back in
+	std::erase_if(_cell.m_settings, [](JPH::BodyCreationSettings& _settings)
+		{
+			WP_GameObjectID const id = static_cast<WP_GameObjectID>(_settings.mUserData);
+			auto* pComp = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponent(id);
+			auto* transComp = WP_ComponentList<WP_Transform3D>::GetComponentList()->GetComponent(id);
+			if (!pComp || !pComp->m_isStreamed || !transComp) { return true; }
+			_settings.mPosition = ToJoltVec3(transComp->m_position + ToGLMVec3(pComp->m_posOffset));
+			_settings.mRotation = ToJoltQuat(glm::normalize(transComp->m_angle)) * pComp->m_rotOffset;
+			return false;
+		});
+	std::erase_if(_cell.m_ids, [&_cell](WP_GameObjectID _id)
+		{
+			return std::none_of(_cell.m_settings.begin(), _cell.m_settings.end(),
+				[_id](JPH::BodyCreationSettings const& _settings) { return static_cast<WP_GameObjectID>(_settings.mUserData) == _id; });
+		});
+	if (_cell.m_settings.empty()) { return; }
+
+	_cell.m_state = WP_StreamCellState::PREPARING;
+	WP_StreamCell* const cell = &_cell;		//m_streamCells never moves its cells
+	WP_JobSystem::GetInstance()->Schedule([this, cell]()
+		{	//body creation and the broadphase batch build do not touch the simulation, safe during a step
+			JPH::BodyInterface& bodyInterface = m_physics_system.GetBodyInterface();
+			cell->m_bodies.clear();
+			cell->m_bodies.reserve(cell->m_settings.size());
+			for (JPH::BodyCreationSettings const& settings : cell->m_settings)
+			{
+				JPH::Body* body = bodyInterface.CreateBody(settings);
+				if (!body) { break; }	//out of bodies, reported on finalize
+				cell->m_bodies.push_back(body->GetID());
+			}
+			cell->m_addState = cell->m_bodies.empty() ? nullptr
+				: bodyInterface.AddBodiesPrepare(cell->m_bodies.data(), static_cast<int>(cell->m_bodies.size()));
+		}, WP_JobSystem::WP_JobPriority::LOW, &_cell.m_jobCounter);
+}
+
+void WP_PhysicsSystem::FinalizeStreamCell(WP_StreamCell& _cell)
+{
+	if (_cell.m_bodies.size() < _cell.m_settings.size())
+	{
+		WP_WARN("Out of physics bodies, streamed in %u of %u colliders. WP_PhysicsSystem::FinalizeStreamCell()",
+			static_cast<uint32_t>(_cell.m_bodies.size()), static_cast<uint32_t>(_cell.m_settings.size()));
+	}
+	if (_cell.m_bodies.empty())
+	{
+		_cell.m_state = WP_StreamCellState::LOADED;
+		++m_numLoadedStreamCells;
+		return;
+	}
+
+	JPH::BodyInterface& bodyInterface = GetPhysicsBI();
+	bodyInterface.AddBodiesFinalize(_cell.m_bodies.data(), static_cast<int>(_cell.m_bodies.size()), _cell.m_addState, JPH::EActivation::DontActivate);
+	_cell.m_addState = nullptr;
+
+	auto* const list = WP_ComponentList<WP_Physics3D>::GetComponentList();
+	for (JPH::BodyID bID : _cell.m_bodies)
+	{	//AddBodiesPrepare may reorder the ids, the gameobject comes from the user data
+		WP_GameObjectID const id = static_cast<WP_GameObjectID>(bodyInterface.GetUserData(bID));
+		m_bodyToID[bID.GetIndex()] = id;
+		MarkSnapshotDirty(bID);
+		if (WP_Physics3D* pComp = list->GetComponent(id))
+		{
+			pComp->m_bID = bID;
+			pComp->m_isInPhysicsSystem = true;
+		}
+	}
+	_cell.m_state = WP_StreamCellState::LOADED;
+	++m_numLoadedStreamCells;
+}
+
+void WP_PhysicsSystem::UnloadStreamCell(WP_StreamCell& _cell)
+{
+	assert(_cell.m_state == WP_StreamCellState::LOADED);
+	if (!_cell.m_bodies.empty())
+	{
+		JPH::BodyInterface& bodyInterface = GetPhysicsBI();
+		auto* const list = WP_ComponentList<WP_Physics3D>::GetComponentList();
+		for (JPH::BodyID bID : _cell.m_bodies)
+		{
+			WP_GameObjectID const id = static_cast<WP_GameObjectID>(bodyInterface.GetUserData(bID));
+			m_bodyToID.erase(bID.GetIndex());
+			MarkSnapshotDirty(bID);
+			if (WP_Physics3D* pComp = list->GetComponent(id))
+			{
+				pComp->m_bID = (JPH::BodyID)JPH::BodyID::cInvalidBodyID;
+				pComp->m_isInPhysicsSystem = false;
+			}
+		}
+		bodyInterface.RemoveBodies(_cell.m_bodies.data(), static_cast<int>(_cell.m_bodies.size()));
+		bodyInterface.DestroyBodies(_cell.m_bodies.data(), static_cast<int>(_cell.m_bodies.size()));
+		_cell.m_bodies.clear();
+	}
+	_cell.m_state = WP_StreamCellState::UNLOADED;
+	--m_numLoadedStreamCells;
+}
+
+void WP_PhysicsSystem::UnstreamCollider(WP_Physics3D& _comp, bool _isKeptAsBody)
+{
+	WP_GameObjectID const id = _comp.GetGameObjectID();
+	_comp.m_isStreamed = false;
+	auto cellIter = std::find_if(m_streamCells.begin(), m_streamCells.end(), [id](WP_StreamCell const& _cell)
+		{
+			return std::find(_cell.m_ids.begin(), _cell.m_ids.end(), id) != _cell.m_ids.end();
+		});
+	if (cellIter != m_streamCells.end())
+	{
+		WP_StreamCell& cell = *cellIter;
+		if (cell.m_state == WP_StreamCellState::PREPARING)
+		{	//the job writes m_bodies, finish the load so the body can be taken out below
+			WP_JobSystem::GetInstance()->Wait(cell.m_jobCounter);
+			FinalizeStreamCell(cell);
+		}
+		std::erase(cell.m_ids, id);
+		std::erase_if(cell.m_settings, [id](JPH::BodyCreationSettings const& _settings)
+			{
+				return static_cast<WP_GameObjectID>(_settings.mUserData) == id;
+			});
+
+		JPH::BodyInterface& bodyInterface = GetPhysicsBI();
+		auto bodyIter = std::find_if(cell.m_bodies.begin(), cell.m_bodies.end(), [&bodyInterface, id](JPH::BodyID _bID)
+			{
+				return static_cast<WP_GameObjectID>(bodyInterface.GetUserData(_bID)) == id;
+			});
+		if (bodyIter != cell.m_bodies.end())
+		{	//loaded, free its body the same way the cell unload does
+			JPH::BodyID const bID = *bodyIter;
+			cell.m_bodies.erase(bodyIter);
+			bodyInterface.RemoveBody(bID);
+			bodyInterface.DestroyBody(bID);
+			m_bodyToID.erase(bID.GetIndex());
+			MarkSnapshotDirty(bID);
+		}
+	}
+	_comp.m_bID = (JPH::BodyID)JPH::BodyID::cInvalidBodyID;
+	_comp.m_isInPhysicsSystem = false;
+	if (_isKeptAsBody) { AddComponentBody(_comp); }
+	MarkTransformBindingsDirty();
+	if (m_isRayCacheEnabled) { InvalidateRayCache(); }
+}
+
+void WP_PhysicsSystem::ClearStreamCells()
+{
+	auto* const list = WP_ComponentList<WP_Physics3D>::GetComponentList();
+	for (WP_StreamCell& cell : m_streamCells)
+	{
+		if (cell.m_state == WP_StreamCellState::PREPARING)
+		{	//never added, only the created bodies need freeing
+			WP_JobSystem::GetInstance()->Wait(cell.m_jobCounter);
+			if (!cell.m_bodies.empty())
+			{
+				GetPhysicsBI().AddBodiesAbort(cell.m_bodies.data(), static_cast<int>(cell.m_bodies.size()), cell.m_addState);
+				GetPhysicsBI().DestroyBodies(cell.m_bodies.data(), static_cast<int>(cell.m_bodies.size()));
+			}
+			cell.m_bodies.clear();
+			cell.m_addState = nullptr;
+		}
+		else if (cell.m_state == WP_StreamCellState::LOADED)
+		{
+			UnloadStreamCell(cell);
+		}
+		for (WP_GameObjectID id : cell.m_ids)
+		{
+			if (WP_Physics3D* pComp = list->GetComponent(id)) { pComp->m_isStreamed = false; }
+		}
+	}
+	m_streamCells.clear();
+	m_numLoadedStreamCells = 0;
+}
+
+void WP_PhysicsSystem::UpdateTelemetry(uint32_t _numBodyPairs, uint32_t _numContactConstraints)
+{
+	m_telemetry.m_tempAllocatorCapacity = temp_allocator->GetCapacity();
+	m_telemetry.m_tempAllocatorHighWaterMark = temp_allocator->GetHighWaterMark();
+	m_telemetry.m_tempAllocatorOverflows = temp_allocator->GetNumOverflows();
+	m_telemetry.m_numBodies = m_physics_system.GetNumBodies();
+	m_telemetry.m_maxBodies = cMaxBodies;
+	m_telemetry.m_numBodyPairs = _numBodyPairs;
+	m_telemetry.m_maxBodyPairs = cMaxBodyPairs;
+	m_telemetry.m_numContactConstraints = _numContactConstraints;
+	m_telemetry.m_maxContactConstraints = cMaxContactConstraints;
+
+	auto checkLimit = [this](uint32_t _bit, uint32_t _used, uint32_t _capacity, const char* _name)
+		{
+			bool const isNear = m_telemetryWarningRatio > 0.f && _used >= m_telemetryWarningRatio * _capacity;
+			if (isNear && !(m_telemetryWarnings & _bit))
+			{
+				WP_WARN("Physics %s at %u of %u. WP_PhysicsSystem::UpdateTelemetry()", _name, _used, _capacity);
+			}
+			m_telemetryWarnings = isNear ? (m_telemetryWarnings | _bit) : (m_telemetryWarnings & ~_bit);
+		};
+	checkLimit(1u << 0, m_telemetry.m_tempAllocatorHighWaterMark, m_telemetry.m_tempAllocatorCapacity, "temp allocator bytes");
+	checkLimit(1u << 1, m_telemetry.m_numBodies, m_telemetry.m_maxBodies, "bodies");
+	checkLimit(1u << 2, m_telemetry.m_numBodyPairs, m_telemetry.m_maxBodyPairs, "body pairs");
+	checkLimit(1u << 3, m_telemetry.m_numContactConstraints, m_telemetry.m_maxContactConstraints, "contact constraints");
+
+	if (!m_isTempAllocatorAdaptive) { return; }
+	uint64_t capacity = m_telemetry.m_tempAllocatorCapacity;
+	while (m_telemetry.m_tempAllocatorHighWaterMark >= WP_PHYSICS_TEMP_ALLOCATOR_GROW_RATIO * capacity
+		&& capacity < WP_PHYSICS_TEMP_ALLOCATOR_MAX_SIZE)
+	{
+		capacity = std::min<uint64_t>(capacity * 2, WP_PHYSICS_TEMP_ALLOCATOR_MAX_SIZE);
+	}
+	if (capacity != m_telemetry.m_tempAllocatorCapacity && temp_allocator->Resize(static_cast<uint32_t>(capacity)))
+	{
+		WP_INFO("Physics temp allocator grown to %u bytes. WP_PhysicsSystem::UpdateTelemetry()", static_cast<uint32_t>(capacity));
+	}
+}
+
+void WP_PhysicsSystem::SetFlightRecorderEnabled(bool _isEnabled)
+{
+	m_isFlightRecorderEnabled = _isEnabled;
+	m_ContactListener.m_isRecordingIslands = _isEnabled;
+}
+
+bool WP_PhysicsSystem::DumpFlightRecorder()
+{
+	return DumpFlightRecorder(WP_PhysicsFlightRecorder::WP_DumpTrigger::MANUAL);
+}
+
+bool WP_PhysicsSystem::DumpFlightRecorder(WP_PhysicsFlightRecorder::WP_DumpTrigger _trigger)
+{
+	WP_PhysicsFlightRecorder::WP_FrameRecord const* const latest = m_flightRecorder.GetLatest();
+	char fileName[48];
+	if (_trigger == WP_PhysicsFlightRecorder::WP_DumpTrigger::HITCH)
+	{	//fixed set of files, a game that hitches often does not fill the disk
+		std::snprintf(fileName, sizeof(fileName), "PhysicsFlight_Hitch%u.wpfr", m_numHitchDumps++ % WP_PHYSICS_FLIGHT_RECORDER_MAX_HITCH_DUMPS);
+	}
+	else
+	{
+		std::snprintf(fileName, sizeof(fileName), "PhysicsFlight_%u.wpfr", latest ? latest->m_frame : 0u);
+	}
+	std::filesystem::path const path = std::filesystem::path{ m_flightRecorderDirectory } / fileName;
+
+	std::error_code error;
+	std::filesystem::create_directories(m_flightRecorderDirectory, error);
+	if (!m_flightRecorder.Dump(path.string(), _trigger, m_flightRecorderHitchThreshold))
+	{
+		WP_WARN("Failed to write physics flight recorder to %s. WP_PhysicsSystem::DumpFlightRecorder()", path.string().c_str());
+		return false;
+	}
+	WP_INFO("Physics flight recorder written to %s. WP_PhysicsSystem::DumpFlightRecorder()", path.string().c_str());
+	return true;
+}
+
+void WP_PhysicsSystem::RecordFlightFrame(WP_PhysicsPhaseTimes const& _phaseTimes, float _frameTime,
+	uint32_t _numCollisionSteps, uint32_t _numDelayedCommands, uint32_t _numBodyPairs, uint32_t _numContactConstraints)
+{
+	WP_PhysicsFlightRecorder::WP_FrameRecord& record = m_flightRecorder.BeginRecord();
+	record.m_frameTime = _frameTime;
+	record.m_numCollisionSteps = _numCollisionSteps;
+	record.m_numBodies = m_physics_system.GetNumBodies();
+	record.m_numActiveBodies = m_physics_system.GetNumActiveBodies(JPH::EBodyType::RigidBody);
+	record.m_numBodyPairs = _numBodyPairs;
+	record.m_numContactConstraints = _numContactConstraints;
+	record.m_numContactsAdded = static_cast<uint32_t>(m_ContactListener.m_ContactAddedList.size());
+	record.m_numContactsPersisted = static_cast<uint32_t>(m_ContactListener.m_ContactPersistList.size());
+	record.m_numContactsRemoved = static_cast<uint32_t>(m_ContactListener.m_ContactRemovedList.size());
+	record.m_numDelayedCommands = _numDelayedCommands;
+	record.m_tempAllocatorHighWaterMark = temp_allocator->GetHighWaterMark();
+	record.m_phaseTimes = _phaseTimes;
+	RecordIslands(record);
+
+	//a long stall spikes several frames in a row, one dump covers them
+	if (m_flightRecorderCooldown > 0) { --m_flightRecorderCooldown; return; }
+	float const threshold = m_flightRecorderHitchThreshold;
+	if (threshold <= 0.f || (_frameTime * 1000.f <= threshold && record.GetTotalTime() <= threshold)) { return; }
+	WP_WARN("Physics hitch, frame %.2f ms, physics %.2f ms. WP_PhysicsSystem::RecordFlightFrame()", _frameTime * 1000.f, record.GetTotalTime());
+	DumpFlightRecorder(WP_PhysicsFlightRecorder::WP_DumpTrigger::HITCH);
+	m_flightRecorderCooldown = m_flightRecorder.GetCapacity();
+}
+
+void WP_PhysicsSystem::RecordIslands(WP_PhysicsFlightRecorder::WP_FrameRecord& _record)
+{
+	auto const& links = m_ContactListener.m_islandLinks;
+	if (links.empty()) { return; }
+	auto findRoot = [this](uint32_t _body)
+		{
+			while (m_islandParent[_body] != _body)
+			{	//path halving
+				m_islandParent[_body] = m_islandParent[m_islandParent[_body]];
+				_body = m_islandParent[_body];
+			}
+			return _body;
+		};
+	auto touch = [this](uint32_t _body)
+		{
+			if (m_islandNumBodies[_body] != 0) { return; }
+			m_islandNumBodies[_body] = 1;
+			m_islandTouched.push_back(_body);
+		};
+
+	//union by size, a static side was replaced by the dynamic body so it links to itself
+	for (auto const [body1, body2] : links)
+	{
+		touch(body1);
+		touch(body2);
+		uint32_t root1 = findRoot(body1), root2 = findRoot(body2);
+		if (root1 == root2) { continue; }
+		if (m_islandNumBodies[root1] < m_islandNumBodies[root2]) { std::swap(root1, root2); }
+		m_islandParent[root2] = root1;
+		m_islandNumBodies[root1] += m_islandNumBodies[root2];
+	}
+	for (auto const [body1, body2] : links)
+	{
+		++m_islandNumContacts[findRoot(body1)];
+	}
+
+	//keep the islands with the most contacts, insertion into the small sorted array
+	auto& top = _record.m_topIslands;
+	for (uint32_t const body : m_islandTouched)
+	{
+		if (findRoot(body) != body) { continue; }
+		WP_PhysicsFlightRecorder::WP_IslandRecord island{ m_islandNumBodies[body], m_islandNumContacts[body], body };
+		for (auto& slot : top)
+		{
+			if (island.m_numContacts > slot.m_numContacts) { std::swap(island, slot); }
+		}
+	}
+
+	for (uint32_t const body : m_islandTouched)
+	{
+		m_islandParent[body] = body;
+		m_islandNumBodies[body] = 0;
+		m_islandNumContacts[body] = 0;
+	}
+	m_islandTouched.clear();
+}
+
+void WP_PhysicsSystem::CaptureStateSnapshot(std::vector<uint8_t>& _out, bool _isKeyframe)
+{
+	assert(!m_isPhysicsLocked && "State snapshots are taken between physics updates. WP_PhysicsSystem::CaptureStateSnapshot()");
+	//not stepping, so the bodies can be read without the body mutexes
+	m_physics_system.GetBodies(m_snapshotBodies);
+	std::sort(m_snapshotBodies.begin(), m_snapshotBodies.end(),
+		[](JPH::BodyID _lhs, JPH::BodyID _rhs) { return _lhs.GetIndex() < _rhs.GetIndex(); });
+	JPH::BodyLockInterfaceNoLock const& lockInterface = m_physics_system.GetBodyLockInterfaceNoLock();
+	m_snapshotStates.clear();
+	for (JPH::BodyID const& bodyID : m_snapshotBodies)
+	{
+		JPH::Body const* body = lockInterface.TryGetBody(bodyID);
+		if (!body) { continue; }
+		m_snapshotStates.push_back({ bodyID.GetIndexAndSequenceNumber(),
+			WP_Physics::ToGLMVec3(body->GetPosition()), WP_Physics::ToGLMQuat(body->GetRotation()),
+			WP_Physics::ToGLMVec3(body->GetLinearVelocity()), WP_Physics::ToGLMVec3(body->GetAngularVelocity()),
+			body->IsActive() });
+	}
+	m_snapshotEncoder.Encode(m_snapshotStates, _out, _isKeyframe);
+}
+
+bool WP_PhysicsSystem::RestoreStateSnapshot(std::span<const uint8_t> _snapshot)
+{
+	assert(!m_isPhysicsLocked && "State snapshots are restored between physics updates. WP_PhysicsSystem::RestoreStateSnapshot()");
+	if (!m_snapshotDecoder.Decode(_snapshot, m_snapshotStates))
+	{
+		WP_WARN("State snapshot is corrupt or not the next one of its stream, restore from a keyframe. WP_PhysicsSystem::RestoreStateSnapshot()");
+		return false;
+	}
+	JPH::BodyInterface& bodyInterface = GetPhysicsBI();
+	JPH::BodyLockInterfaceNoLock const& lockInterface = m_physics_system.GetBodyLockInterfaceNoLock();
+	for (WP_PhysicsStateCodec::WP_BodyState const& state : m_snapshotStates)
+	{
+		JPH::BodyID const bodyID{ state.m_bodyID };
+		JPH::Body const* body = lockInterface.TryGetBody(bodyID);	//null if the body was removed or its slot reused
+		if (!body || body->IsStatic()) { continue; }
+		bodyInterface.SetPositionAndRotation(bodyID, WP_Physics::ToJoltVec3(state.m_position),
+			WP_Physics::ToJoltQuat(state.m_rotation), JPH::EActivation::DontActivate);
+		if (state.m_isActive)
+		{
+			bodyInterface.SetLinearAndAngularVelocity(bodyID, WP_Physics::ToJoltVec3(state.m_linearVelocity), WP_Physics::ToJoltVec3(state.m_angularVelocity));
+			bodyInterface.ActivateBody(bodyID);
+		}
+		else
+		{
+			bodyInterface.DeactivateBody(bodyID);	//also zeroes the velocities
+		}
+		MarkSnapshotDirty(bodyID);
+	}
+	if (m_isRayCacheEnabled) { InvalidateRayCache(); }	//teleports invalidate cached rays
+
+	//the next Trans -> Physics sync would push the old pose back, move the transforms along.
+	//bindings and states are both in body index order, one merge pass
+	RefreshTransformBindings();
+	auto* const transforms = WP_ComponentList<WP_Transform3D>::GetComponentList();
+	auto state = m_snapshotStates.begin();
+	for (WP_TransformBinding const& binding : m_transformBindings)
+	{
+		uint32_t const bodyID = binding.m_bID.GetIndexAndSequenceNumber();
+		while (state != m_snapshotStates.end() && JPH::BodyID{ state->m_bodyID }.GetIndex() < binding.m_bID.GetIndex()) { ++state; }
+		if (state == m_snapshotStates.end()) { break; }
+		if (state->m_bodyID != bodyID) { continue; }
+		WP_Transform3D* const transComp = transforms->GetComponent(binding.m_id);
+		if (!transComp) { continue; }
+		using namespace WP_Physics;
+		JPH::RVec3 position;
+		JPH::Quat rotation;
+		GetPhysicsBI().GetPositionAndRotation(binding.m_bID, position, rotation);
+		transComp->m_position = ToGLMVec3(JPH::Vec3(position) - binding.m_posOffset);
+		transComp->m_angle = ToGLMQuat(rotation * binding.m_invRotOffset);
+	}
+	return true;
+}
+
+void WP_PhysicsSystem::ResetStateSnapshots()
+{
+	m_snapshotEncoder.Reset();
+	m_snapshotDecoder.Reset();
+}
+
+WP_PhysicsSystem::WP_PhysicsLOD WP_PhysicsSystem::GetBodyLOD(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		auto iter = m_bodyLODs.find(pComp->m_bID.GetIndex());
+		return (iter != m_bodyLODs.end()) ? iter->second.m_lod : WP_PhysicsLOD::FULL;
+}
+
+void WP_PhysicsSystem::UpdateLOD()
+{
+	if (++m_lodFrame < WP_PHYSICS_LOD_INTERVAL) { return; }
+	m_lodFrame = 0;
+
+	constexpr float thresholds[] = { WP_PHYSICS_LOD_DISCRETE_DISTANCE, WP_PHYSICS_LOD_PROXY_DISTANCE, WP_PHYSICS_LOD_SLEEP_DISTANCE };
+	constexpr float hysteresis = 1.f - WP_PHYSICS_LOD_HYSTERESIS;
+	auto&& phyCompVec = WP_ComponentSystem::WP_ComponentSystemIterator<WP_Physics3D>();
+	for (WP_Physics3D& t : phyCompVec)
+	{
+		if (!t.m_isInPhysicsSystem || t.m_bID.IsInvalid() || t.m_isNPC || t.m_isTrigger || t.m_isPureStatic) { continue; }
+		auto* transComp = WP_ComponentList<WP_Transform3D>::GetComponentList()->GetComponent(t.GetGameObjectID());
+		if (!transComp) { continue; }
+
+		auto iter = m_bodyLODs.find(t.m_bID.GetIndex());
+		if (iter != m_bodyLODs.end() && iter->second.m_bID != t.m_bID)
+		{	//index reused by a new body
+			m_bodyLODs.erase(iter);
+			iter = m_bodyLODs.end();
+		}
+		WP_PhysicsLOD const current = (iter != m_bodyLODs.end()) ? iter->second.m_lod : WP_PhysicsLOD::FULL;
+		if (current == WP_PhysicsLOD::FULL && GetPhysicsBI().GetMotionType(t.m_bID) != JPH::EMotionType::Dynamic) { continue; }
+
+		float const distance = glm::length(transComp->m_position - m_physicsFocus);
+		uint8_t lod{};
+		for (; lod < std::size(thresholds); ++lod)
+		{	//boundaries nearer than the current level are shrunk, so bodies on an edge do not flip every evaluation
+			float const threshold = thresholds[lod] * ((lod < static_cast<uint8_t>(current)) ? hysteresis : 1.f);
+			if (distance < threshold) { break; }
+		}
+		SetLOD(t.m_bID, static_cast<WP_PhysicsLOD>(lod));
+	}
+}
+
+namespace
+{
+	//0 falls back to the step counts of the physics settings
+	void SetSolverSteps(JPH::PhysicsSystem& _system, JPH::BodyID _bID, uint32_t _velocitySteps, uint32_t _positionSteps)
+	{
+		JPH::BodyLockWrite lock{ _system.GetBodyLockInterface(), _bID };
+		if (!lock.Succeeded() || !lock.GetBody().IsDynamic()) { return; }
+		JPH::MotionProperties* const motion = lock.GetBody().GetMotionProperties();
+		motion->SetNumVelocityStepsOverride(_velocitySteps);
+		motion->SetNumPositionStepsOverride(_positionSteps);
+	}
+}
+
+void WP_PhysicsSystem::SetLOD(JPH::BodyID _bodyID, WP_PhysicsLOD _lod)
+{
+	assert(!m_isPhysicsLocked);
+	JPH::BodyInterface& bodyInterface = GetPhysicsBI();
+	auto iter = m_bodyLODs.find(_bodyID.GetIndex());
+	if (iter == m_bodyLODs.end())
+	{
+		if (_lod == WP_PhysicsLOD::FULL) { return; }
+		WP_BodyLODState state;
+		state.m_bID = _bodyID;
+		state.m_fullQuality = bodyInterface.GetMotionQuality(_bodyID);
+		{
+			JPH::BodyLockRead lock{ m_physics_system.GetBodyLockInterface(), _bodyID };
+			if (lock.Succeeded() && lock.GetBody().IsDynamic())
+			{
+				JPH::MotionProperties const* const motion = lock.GetBody().GetMotionProperties();
+				state.m_fullVelocitySteps = motion->GetNumVelocityStepsOverride();
+				state.m_fullPositionSteps = motion->GetNumPositionStepsOverride();
+			}
+		}
+		iter = m_bodyLODs.emplace(_bodyID.GetIndex(), state).first;
+	}
+	WP_BodyLODState& state = iter->second;
+	WP_PhysicsLOD const previous = state.m_lod;
+
+	if (previous == _lod)
+	{	//keep the level enforced
+		if (_lod == WP_PhysicsLOD::SLEEP && bodyInterface.IsActive(_bodyID))
+		{	//woken by a contact or impulse while still far away
+			bodyInterface.DeactivateBody(_bodyID);
+			MarkSnapshotDirty(_bodyID);
+		}
+		return;
+	}
+	MarkSnapshotDirty(_bodyID);
+
+	//leave the previous level
+	if (previous == WP_PhysicsLOD::PROXY)
+	{
+		SetSolverSteps(m_physics_system, _bodyID, state.m_fullVelocitySteps, state.m_fullPositionSteps);
+	}
+	else if (previous == WP_PhysicsLOD::SLEEP && state.m_isSleepActive)
+	{
+		bodyInterface.ActivateBody(_bodyID);
+		bodyInterface.SetLinearAndAngularVelocity(_bodyID, state.m_sleepLinearVelocity, state.m_sleepAngularVelocity);
+	}
+
+	//enter the new level
+	if (_lod == WP_PhysicsLOD::PROXY)
+	{	//stays dynamic, forces and contacts still move it
+		SetSolverSteps(m_physics_system, _bodyID, WP_PHYSICS_LOD_PROXY_VELOCITY_STEPS, WP_PHYSICS_LOD_PROXY_POSITION_STEPS);
+	}
+	else if (_lod == WP_PhysicsLOD::SLEEP)
+	{
+		state.m_isSleepActive = bodyInterface.IsActive(_bodyID);
+		if (state.m_isSleepActive)
+		{
+			bodyInterface.GetLinearAndAngularVelocity(_bodyID, state.m_sleepLinearVelocity, state.m_sleepAngularVelocity);
+			bodyInterface.DeactivateBody(_bodyID);
+		}
+	}
+	bodyInterface.SetMotionQuality(_bodyID, (_lod == WP_PhysicsLOD::FULL) ? state.m_fullQuality : JPH::EMotionQuality::Discrete);
+
+	if (_lod == WP_PhysicsLOD::FULL) { m_bodyLODs.erase(iter); }
+	else { state.m_lod = _lod; }
+}
+
+void WP_PhysicsSystem::RestoreLODs()
+{
+	std::vector<JPH::BodyID> bodies;
+	bodies.reserve(m_bodyLODs.size());
+	for (auto const& [bodyIndex, state] : m_bodyLODs) { bodies.push_back(state.m_bID); }
+	for (JPH::BodyID bID : bodies)
+	{
+		if (GetPhysicsBI().IsAdded(bID)) { SetLOD(bID, WP_PhysicsLOD::FULL); }
+		else { m_bodyLODs.erase(bID.GetIndex()); }	//removed or destroyed since it was demoted
+	}
+	m_lodFrame = 0;
+}
+
+namespace
+{
+	//milliseconds since _lap, then restarts it
+	float LapMilliseconds(WP_TimerSystem::clock::time_point& _lap)
+	{
+		WP_TimerSystem::clock::time_point const now = WP_TimerSystem::clock::now();
+		float const elapsed = std::chrono::duration<float, std::milli>(now - _lap).count();
+		_lap = now;
+		return elapsed;
+	}
+}
+
+void WP_PhysicsSystem::OnUpdate()
+{
+	static unsigned int s_rollbackFrames = 0;
+	//================================================================
+	//					Actual Physics Update
+	//======================VVVVVVVVVVVVVVV===========================
+	// We simulate the physics world in discrete time steps. 60 Hz is a good rate to update the physics system.
+	const float cDeltaTime = WP_TimerSystem::GetInstance()->GetDT();
+
+	// Now we're ready to simulate the body, keep simulating until it goes to sleep
+	//static JPH::uint step = 0;
+	//if (GetPhysicsBI().IsActive(sphere_id))	//remove before Milestone 1! M1_TODO
+	{
+		// Next step
+		//++step;
+
+		// Output current position and velocity of the sphere
+		//{
+			/*RVec3 position = GetPhysicsBI().GetCenterOfMassPosition(sphere_id);
+			Vec3 velocity = GetPhysicsBI().GetLinearVelocity(sphere_id);*/
+			//cout << "Step " << step << ": Position = (" << position.GetX() << ", " << position.GetY() << ", " << position.GetZ() << "), Velocity = (" << velocity.GetX() << ", " << velocity.GetY() << ", " << velocity.GetZ() << ")" << endl;
+		//}
+		// If you take larger steps than 1 / 60th of a second you need to do multiple collision steps in order to keep the simulation stable. Do 1 collision step per 1 / 60th of a second (round up).
+		const int cCollisionSteps = static_cast<int>(std::ceilf(cDeltaTime / (1.0f / 60.0f)));
+		int collisionStepsThisUpdate{cCollisionSteps};
+
+		//if collision steps exceed the max number of rollback frames, 
+		if (cCollisionSteps > (MAX_PHYSICS_UPDATES_PER_FRAME * m_maxPhysicsSteps))
+		{	//rollback all frames above max collision steps into next frame
+			s_rollbackFrames += (cCollisionSteps - MAX_PHYSICS_UPDATES_PER_FRAME * m_maxPhysicsSteps);
+			collisionStepsThisUpdate = MAX_PHYSICS_UPDATES_PER_FRAME * m_maxPhysicsSteps;
+		}
+		//if not max number of collision steps and there are some rollback frames, 
+		if (s_rollbackFrames > 0 && cCollisionSteps < (MAX_PHYSICS_UPDATES_PER_FRAME * m_maxPhysicsSteps))
+		{	//do some rollback frames 
+			int oldRollbackFrames = s_rollbackFrames;	//save old number of rollback frames
+			//make rollback frames the remainder after taking enough frames to make step the max amount of updates this frame
+			s_rollbackFrames = (cCollisionSteps + s_rollbackFrames) % MAX_PHYSICS_STEPS;
+			//make number of collision steps this frame to be the number of collision steps
+			collisionStepsThisUpdate = cCollisionSteps + oldRollbackFrames - s_rollbackFrames;
+		}
+
+		//flight recorder phase timing, each call adds the time since the previous one to _phase
+		using WP_Phase = WP_PhysicsFlightRecorder::WP_PhysicsPhase;
+		WP_PhysicsPhaseTimes phaseTimes{};
+		WP_TimerSystem::clock::time_point lap = WP_TimerSystem::clock::now();
+		auto endPhase = [&phaseTimes, &lap](WP_Phase _phase) { phaseTimes[static_cast<size_t>(_phase)] += LapMilliseconds(lap); };
+
+		//stream cells in and out around the focus, cells prepared since last update join the world here
+		if (m_isStreamingEnabled) { UpdateStreaming(); }
+		//bucket dynamic bodies by distance before the transform sync
+		if (m_isLODEnabled) { UpdateLOD(); }
+		else if (!m_bodyLODs.empty()) { RestoreLODs(); }
+
+		//baked and streamed statics never move, they are not bound
+		RefreshTransformBindings();
+		auto* const transforms = WP_ComponentList<WP_Transform3D>::GetComponentList();
+		for (WP_TransformBinding const& binding : m_transformBindings)
+		{	//Trans -> Physics
+			//TO_TEST: Point of failure, rotation and position offsets
+			using namespace WP_Physics;
+			WP_Transform3D const* const transComp = transforms->GetComponent(binding.m_id);
+			if (!transComp)
+			{	//transform removed since the rebuild
+				MarkTransformBindingsDirty();
+				continue;
+			}
+			JPH::Vec3 const position = ToJoltVec3(transComp->m_position) + binding.m_posOffset;
+			JPH::Quat const rotation = ToJoltQuat(glm::normalize(transComp->m_angle)) * binding.m_rotOffset;
+
+			//Update with Non direct access to transform member variables. ideally through a function.
+			if (binding.m_isCharacter)
+			{
+				binding.m_physics->m_charPtr->SetPositionAndRotation(position, rotation,
+					WP_ACTIVATION_IS_ACTIVE(GetPhysicsBI().IsActive(binding.m_bID)));
+			}
+			else
+			{
+				GetPhysicsBI().SetPositionAndRotationWhenChanged(binding.m_bID, position, rotation,
+					WP_ACTIVATION_IS_ACTIVE(GetPhysicsBI().IsActive(binding.m_bID)));
+			}
+
+			//scale only reaches jolt when it changes, through a cached wrapper of the base shape
+			if (binding.m_isScaled) { SyncBodyScale(binding, *transComp); }
+		}
+		if (!m_pendingMassBodies.empty()) { UpdatePendingMass(); }
+		//remove last update's contact events, contact stream stays readable until here
+		m_ContactListener.ClearContacts();
+		m_projectiles.ClearHits();
+		m_isPhysicsLocked = true;	//locked physics, all calls to setting functions are delayed
+		
+		uint32_t collisionStepsDone{};	//collision steps simulated so far this frame
+		uint32_t peakBodyPairs{}, peakContactConstraints{};	//per collision step, for telemetry
+		temp_allocator->ResetStats();
+		endPhase(WP_Phase::PREPARE);
+		while (cCollisionSteps && collisionStepsThisUpdate != 0)	//MAX_PHYSICS_UPDATES_PER_FRAME number of physics update loops
+		{
+			//find number of steps this update. must be less than hardware concurrency -1.
+			int steps = (collisionStepsThisUpdate % (m_maxPhysicsSteps + 1));
+			steps = (steps) ? steps: m_maxPhysicsSteps;
+			//find DT fraction to complete these steps
+			float thisUpdateDT = WP_TimerSystem::GetInstance()->GetFixedDT() * steps;
+			//remove these steps from the number of steps we need this frame.
+			collisionStepsThisUpdate -= steps;
+		// Step the world
+		if (steps)	//if no collisions this frame, skip update
+		{
+			m_ContactListener.m_numValidatedPairs.store(0, std::memory_order_relaxed);
+			m_ContactListener.m_numManifolds.store(0, std::memory_order_relaxed);
+			m_forceFieldMilliseconds = 0.f;
+			m_physics_system.Update(thisUpdateDT, steps, &*temp_allocator, &*job_system);
+			endPhase(WP_Phase::SIMULATION);
+			//force fields run inside the update from m_forceFieldListener, report them on their own
+			phaseTimes[static_cast<size_t>(WP_Phase::FORCE_FIELDS)] += m_forceFieldMilliseconds;
+			phaseTimes[static_cast<size_t>(WP_Phase::SIMULATION)] -= m_forceFieldMilliseconds;
+			collisionStepsDone += steps;
+			//counts cover all collision steps of this update, average them per step
+			peakBodyPairs = std::max(peakBodyPairs, m_ContactListener.m_numValidatedPairs.load(std::memory_order_relaxed) / static_cast<uint32_t>(steps));
+			peakContactConstraints = std::max(peakContactConstraints, m_ContactListener.m_numManifolds.load(std::memory_order_relaxed) / static_cast<uint32_t>(steps));
+			if (m_isRayCacheEnabled) { InvalidateRayCache(); }	//world moved, cached answers are stale
+			//swept against the world as it is after the update
+			m_projectiles.Step(m_physics_system, m_layerMatrix, thisUpdateDT);
+			endPhase(WP_Phase::PROJECTILES);
+		}
+		}
+
+		
+		
+		m_ContactListener.GatherContacts();
+		uint32_t const numDelayedCommands = static_cast<uint32_t>(m_DelayedPhysicsList.size());	//queued while locked, run with the callbacks
+		m_isPhysicsLocked = false;	//unlocked physics
+		//limits report, and the adaptive arena grows while nothing is allocated from it
+		UpdateTelemetry(peakBodyPairs, peakContactConstraints);
+		//publish before any callback can read body state
+		PublishBodySnapshot();
+		//update awake set before any callbacks query it
+		ApplyActivationChanges();
+		//sensor enter/exit sets, reported with the contact streams
+		UpdateSensors();
+		endPhase(WP_Phase::PUBLISH);
+		//run contact callback
+		m_ContactListener.CallbackAllContacts();
+		m_projectiles.DispatchHits();
+		//publish last frame's previews and start this frame's, the world is at rest until the next update
+		m_prediction.Update(m_physics_system, static_cast<float>(WP_TimerSystem::GetInstance()->GetFixedDT()));
+		endPhase(WP_Phase::CALLBACKS);
+
+		//callbacks may have added or removed components
+		RefreshTransformBindings();
+		for (WP_TransformBinding const& binding : m_transformBindings)
+		{//Physics -> Trans
+			WP_Transform3D* const transComp = transforms->GetComponent(binding.m_id);
+			if (!transComp)
+			{
+				MarkTransformBindingsDirty();
+				continue;
+			}
+		// VVV this optimization is to be implemented TODO:
+		 //if (GetPhysicsBI().GetMotionType(t.m_bID) == JPH::EMotionType::Static) { continue; }	//if static object, skip updating the transforms cus no movement
+			//otherwise, update transform
+//TO_TEST: Point of failure, rotation and position offsets
+			using namespace WP_Physics;
+			JPH::RVec3 position;
+			JPH::Quat rotation;
+			GetPhysicsBI().GetPositionAndRotation(binding.m_bID, position, rotation);	//one body lock for both
+			//Update with Non direct access to transform member variables. ideally through a function.
+			JPH::Vec3 const bodyPosition = JPH::Vec3(position) - binding.m_posOffset;
+			transComp->m_position = ToGLMVec3(bodyPosition);
+			transComp->m_angle = ToGLMQuat(rotation * binding.m_invRotOffset);
+
+			if (binding.m_isCharacter)
+			{
+				binding.m_physics->m_charPtr->PostSimulation(binding.m_physics->m_maxSeperationDistance);
+			}
+		}
+		endPhase(WP_Phase::WRITEBACK);
+		if (m_isFlightRecorderEnabled)
+		{
+			RecordFlightFrame(phaseTimes, cDeltaTime, collisionStepsDone, numDelayedCommands, peakBodyPairs, peakContactConstraints);
+		}
+	}
+}
+
+
+//================================================================================
+//					JPH::Body Property retrieval functions
+//================================================================================
+//Shape and factors settings
+
+WP_PhysicsShape		WP_PhysicsSystem::GetBodyPhysicsShape(WP_GameObjectID _id) const
+{
+
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		switch (GetPhysicsBI().GetShape(pComp->m_bID)->GetSubType()) {
+		case JPH::EShapeSubType::Box:
+			return WP_PhysicsShape::CUBE;
+		case JPH::EShapeSubType::Sphere:
+			return WP_PhysicsShape::SPHERE;
+		case JPH::EShapeSubType::Capsule:
+			return WP_PhysicsShape::CAPSULE;
+		case JPH::EShapeSubType::Cylinder:
+			return WP_PhysicsShape::CYLINDER;
+		case JPH::EShapeSubType::Mesh:
+			return WP_PhysicsShape::MESH;
+		case JPH::EShapeSubType::ConvexHull:
+			return WP_PhysicsShape::CONVEX_HULL;
+		case JPH::EShapeSubType::Scaled:	//cooked shapes are wrapped for per collider scale
+			return pComp->m_shapeType;
+		default:
+			return WP_PhysicsShape::EMPTY;
+		}
+}
+
+float				WP_PhysicsSystem::GetBodyFriction(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		return GetPhysicsBI().GetFriction(pComp->m_bID);
+}
+
+float				WP_PhysicsSystem::GetBodyRestitution(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		return GetPhysicsBI().GetRestitution(pComp->m_bID);
+}
+
+float				WP_PhysicsSystem::GetBodyGravityFactor(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		return GetPhysicsBI().GetGravityFactor(pComp->m_bID);
+}
+
+bool				WP_PhysicsSystem::GetBodyActive(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		if (WP_BodyState state; TryReadSnapshot(pComp->m_bID, state)) { return state.m_isActive; }
+		return GetPhysicsBI().IsActive(pComp->m_bID);
+}
+
+//Other settings
+
+JPH::EMotionQuality WP_PhysicsSystem::GetBodyMotionQuality(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		return GetPhysicsBI().GetMotionQuality(pComp->m_bID);
+}
+JPH::EMotionType	WP_PhysicsSystem::GetBodyMotionType(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		if (WP_BodyState state; TryReadSnapshot(pComp->m_bID, state)) { return state.m_motionType; }
+		return GetPhysicsBI().GetMotionType(pComp->m_bID);
+}
+JPH::ObjectLayer	WP_PhysicsSystem::GetBodyObjectLayer(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		return GetPhysicsBI().GetObjectLayer(pComp->m_bID);
+}
+
+//Transform settings
+
+glm::vec3			WP_PhysicsSystem::GetBodyPosition(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		//return WP_Physics::ToGLMVec3(GetPhysicsBI().GetPosition(pComp->m_bID) + GetPhysicsBI().GetCenterOfMassPosition(pComp->m_bID));
+		if (WP_BodyState state; TryReadSnapshot(pComp->m_bID, state)) { return state.m_position; }
+		return WP_Physics::ToGLMVec3(GetPhysicsBI().GetPosition(pComp->m_bID));
+}
+
+glm::vec3			WP_PhysicsSystem::GetBodyCenterMass(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		return WP_Physics::ToGLMVec3(GetPhysicsBI().GetCenterOfMassPosition(pComp->m_bID));
+}
+
+//TODO: QUAT?
+glm::vec4			WP_PhysicsSystem::GetBodyRotation(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		if (WP_BodyState state; TryReadSnapshot(pComp->m_bID, state)) { return glm::vec4(state.m_rotation.x, state.m_rotation.y, state.m_rotation.z, state.m_rotation.w); }
+		return WP_Physics::ToGLMVec4(GetPhysicsBI().GetRotation(pComp->m_bID));
+}
+
+void				WP_PhysicsSystem::GetBodyPositionAndRotation(WP_GameObjectID _id, glm::vec3& _outPos, glm::vec4& _outRot) const
+{
+	_outPos = GetBodyPosition(_id);
+	_outRot = GetBodyRotation(_id);
+}
+
+glm::mat4x4			WP_PhysicsSystem::GetBodyWorldTransform(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		if (WP_BodyState state; TryReadSnapshot(pComp->m_bID, state)) { return WP_Physics::ToGLMMat4x4(JPH::Mat44::sRotationTranslation(WP_Physics::ToJoltQuat(state.m_rotation), WP_Physics::ToJoltVec3(state.m_position))); }
+		return WP_Physics::ToGLMMat4x4(GetPhysicsBI().GetWorldTransform(pComp->m_bID));
+}
+
+glm::mat4x4			WP_PhysicsSystem::GetBodyInverseInertia(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		return WP_Physics::ToGLMMat4x4(GetPhysicsBI().GetInverseInertia(pComp->m_bID));
+}
+
+//Velocity settings
+
+glm::vec3			WP_PhysicsSystem::GetBodyLinearVelocity(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		if (WP_BodyState state; TryReadSnapshot(pComp->m_bID, state)) { return state.m_linearVelocity; }
+		return WP_Physics::ToGLMVec3(GetPhysicsBI().GetLinearVelocity(pComp->m_bID));
+}
+
+glm::vec3			WP_PhysicsSystem::GetBodyPointVelocity(WP_GameObjectID _id, glm::vec3 _point) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		return WP_Physics::ToGLMVec3(GetPhysicsBI().GetPointVelocity(pComp->m_bID, WP_Physics::ToJoltVec3(_point)));
+}
+
+glm::vec3			WP_PhysicsSystem::GetBodyAngularVelocity(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		if (WP_BodyState state; TryReadSnapshot(pComp->m_bID, state)) { return state.m_angularVelocity; }
+		return WP_Physics::ToGLMVec3(GetPhysicsBI().GetAngularVelocity(pComp->m_bID));
+}
+
+void				WP_PhysicsSystem::GetBodyLinearAndAngularVelocity(WP_GameObjectID _id, glm::vec3& _outLinearVel, glm::vec3& _outAngularVel) const
+{
+	_outLinearVel = GetBodyLinearVelocity(_id);
+	_outAngularVel = GetBodyAngularVelocity(_id);
+}
+
+
+//================================================================================
+//					JPH::Body Property mutator functions
+//================================================================================
+
+namespace
+{
+	//shared by SetBodyPosition and BulkSetPosition, so a body lands in the same place through either.
+	//_position is where the center of mass goes, only its offset from the body origin is taken off
+	JPH::RVec3 ToBodySetPosition(JPH::BodyInterface const& _bi, JPH::BodyID _bID, glm::vec3 const& _position)
+	{
+		JPH::RefConst<JPH::Shape> const shape = _bi.GetShape(_bID);
+		JPH::Vec3 const comOffset = shape ? _bi.GetRotation(_bID) * shape->GetCenterOfMass() : JPH::Vec3::sZero();
+		return WP_Physics::ToJoltVec3(_position) - comOffset;
+	}
+}
+
+void				WP_PhysicsSystem::SetBodyPhysicsShape(WP_GameObjectID _id, WP_PhysicsShape _newShapeType,
+	JPH::Shape& _newShape, bool _updateMassProperties, bool _isActive)
+{
+	if (m_isPhysicsLocked) { return; }
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		pComp->m_shapeType = _newShapeType;
+	MarkSnapshotDirty(pComp->m_bID);
+	GetPhysicsBI().SetShape(pComp->m_bID, &_newShape, _updateMassProperties, WP_ACTIVATION_IS_ACTIVE(_isActive));
+	if (!pComp->m_bID.IsInvalid()) { m_bodyScales[pComp->m_bID.GetIndex()].m_bID = JPH::BodyID{}; }	//new base shape at the current scale
+	if (m_isRayCacheEnabled) { InvalidateRayCache(); }
+}
+
+void				WP_PhysicsSystem::SetBodyFriction(WP_GameObjectID _id, float _newFriction)
+{
+	DELAYED_PHYSICS_P1(_id, SetBodyFriction, float, _newFriction);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		GetPhysicsBI().SetFriction(pComp->m_bID, _newFriction);
+}
+void				WP_PhysicsSystem::SetBodyRestitution(WP_GameObjectID _id, float _newCOR)
+{
+	DELAYED_PHYSICS_P1(_id,SetBodyRestitution,float,_newCOR);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		GetPhysicsBI().SetRestitution(pComp->m_bID, _newCOR);
+}
+void				WP_PhysicsSystem::SetBodyGravityFactor(WP_GameObjectID _id, float _newGravityFactor)
+{
+	DELAYED_PHYSICS_P1(_id, SetBodyGravityFactor,float , _newGravityFactor);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		GetPhysicsBI().SetGravityFactor(pComp->m_bID, _newGravityFactor);
+}
+
+void				WP_PhysicsSystem::SetBodyMotionQuality(WP_GameObjectID _id, JPH::EMotionQuality _newMotionQuality)
+{
+	DELAYED_PHYSICS_P1(_id, SetBodyMotionQuality, JPH::EMotionQuality, _newMotionQuality);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		if (auto iter = m_bodyLODs.find(pComp->m_bID.GetIndex()); iter != m_bodyLODs.end())
+		{
+			iter->second.m_fullQuality = _newMotionQuality;	//applied when the body is back at full lod
+			return;
+		}
+		GetPhysicsBI().SetMotionQuality(pComp->m_bID, _newMotionQuality);
+}
+void				WP_PhysicsSystem::SetBodyMotionType(WP_GameObjectID _id, JPH::EMotionType _newMotionType)
+{
+	DELAYED_PHYSICS_P1(_id, SetBodyMotionType, JPH::EMotionType, _newMotionType);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		SetLOD(pComp->m_bID, WP_PhysicsLOD::FULL);	//gameplay takes the body back from physics lod
+		MarkSnapshotDirty(pComp->m_bID);
+		GetPhysicsBI().SetMotionType(pComp->m_bID, _newMotionType, WP_ACTIVATION_IS_ACTIVE(GetBodyActive(_id)));
+}
+void				WP_PhysicsSystem::SetBodyObjectLayer(WP_GameObjectID _id, JPH::ObjectLayer _newMotionLayer)
+{
+	DELAYED_PHYSICS_P1(_id, SetBodyObjectLayer, JPH::ObjectLayer, _newMotionLayer);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		if (m_isRayCacheEnabled) { InvalidateRayCache(); }	//cached answers were filtered by the old layer
+		GetPhysicsBI().SetObjectLayer(pComp->m_bID, _newMotionLayer);
+		UpdateSensorTracking(*pComp);
+}
+
+void				WP_PhysicsSystem::SetBodyPosition(WP_GameObjectID _id, glm::vec3 const& _newPos)
+{
+	DELAYED_PHYSICS_P1(_id, SetBodyPosition, glm::vec3 const&, _newPos);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		if (m_isRayCacheEnabled) { InvalidateRayCache(); }	//teleports invalidate cached rays
+		GetPhysicsBI().SetPosition(pComp->m_bID, ToBodySetPosition(GetPhysicsBI(), pComp->m_bID, _newPos)
+			, WP_ACTIVATION_IS_ACTIVE(GetBodyActive(_id)));
+}
+void				WP_PhysicsSystem::SetBodyRotation(WP_GameObjectID _id, glm::quat const& _newRot)
+{
+	DELAYED_PHYSICS_P1(_id, SetBodyRotation, glm::quat const&, _newRot);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		if (m_isRayCacheEnabled) { InvalidateRayCache(); }	//teleports invalidate cached rays
+		GetPhysicsBI().SetRotation(pComp->m_bID, WP_Physics::ToJoltQuat(_newRot), WP_ACTIVATION_IS_ACTIVE(GetBodyActive(_id)));
+}
+void				WP_PhysicsSystem::SetBodyRotation(WP_GameObjectID _id, glm::vec3 const& _newRot)
+{
+	DELAYED_PHYSICS_P1(_id, SetBodyRotation, glm::vec3 const&, _newRot);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		if (m_isRayCacheEnabled) { InvalidateRayCache(); }	//teleports invalidate cached rays
+		GetPhysicsBI().SetRotation(pComp->m_bID,
+			JPH::Quat::sEulerAngles(WP_Physics::ToJoltVec3(GetRadianFromDegreesVector(_newRot))),
+			WP_ACTIVATION_IS_ACTIVE(GetBodyActive(_id)));
+}
+
+void				WP_PhysicsSystem::SetBodyLinearVelocity(WP_GameObjectID _id, glm::vec3 const& _newLinearVelocity)
+{
+	DELAYED_PHYSICS_P1(_id, SetBodyLinearVelocity, glm::vec3 const&, _newLinearVelocity);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		GetPhysicsBI().SetLinearVelocity(pComp->m_bID, WP_Physics::ToJoltVec3(_newLinearVelocity));
+}
+void				WP_PhysicsSystem::SetBodyAngularVelocity(WP_GameObjectID _id, glm::vec3 const& _newAngularVelocity)
+{
+	DELAYED_PHYSICS_P1(_id, SetBodyAngularVelocity, glm::vec3 const&, _newAngularVelocity);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		GetPhysicsBI().SetLinearVelocity(pComp->m_bID, WP_Physics::ToJoltVec3(_newAngularVelocity));
+}
+
+//================================================================================
+//					JPH::Body Property Add Force functions
+//================================================================================
+
+void				WP_PhysicsSystem::AddForceToBody(WP_GameObjectID _id, glm::vec3 const& _force, bool _isActive)
+{
+	DELAYED_PHYSICS_P2(_id, AddForceToBody, glm::vec3 const&, bool, _force, _isActive);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		GetPhysicsBI().AddForce(pComp->m_bID, WP_Physics::ToJoltVec3(_force), WP_ACTIVATION_IS_ACTIVE(_isActive));
+}
+void				WP_PhysicsSystem::AddForceToPoint(WP_GameObjectID _id, glm::vec3 const& _force, glm::vec3 const& _point, bool _isActive)
+{
+	DELAYED_PHYSICS_P3(_id, AddForceToPoint, glm::vec3 const&, glm::vec3 const&, bool, _force, _point, _isActive);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		GetPhysicsBI().AddForce(pComp->m_bID, WP_Physics::ToJoltVec3(_force), WP_Physics::ToJoltVec3(_point), WP_ACTIVATION_IS_ACTIVE(_isActive));
+}
+void				WP_PhysicsSystem::AddTorqueToBody(WP_GameObjectID _id, glm::vec3 const& _torque, bool _isActive)
+{
+	DELAYED_PHYSICS_P2(_id, AddTorqueToBody, glm::vec3 const&, bool, _torque, _isActive);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		GetPhysicsBI().AddTorque(pComp->m_bID, WP_Physics::ToJoltVec3(_torque), WP_ACTIVATION_IS_ACTIVE(_isActive));
+}
+void				WP_PhysicsSystem::AddForceAndTorqueToBody(WP_GameObjectID _id, glm::vec3 const& _force, glm::vec3 const& _torque, bool _isActive)
+{
+	DELAYED_PHYSICS_P3(_id, AddForceAndTorqueToBody, glm::vec3 const&, glm::vec3 const&, bool, _force, _torque, _isActive);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		GetPhysicsBI().AddForceAndTorque(pComp->m_bID, WP_Physics::ToJoltVec3(_force), WP_Physics::ToJoltVec3(_torque), WP_ACTIVATION_IS_ACTIVE(_isActive));
+}
+
+void				WP_PhysicsSystem::AddImpulseToBody(WP_GameObjectID _id, glm::vec3 const& _impulse)
+{
+	DELAYED_PHYSICS_P1(_id, AddImpulseToBody, glm::vec3 const&, _impulse);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		GetPhysicsBI().AddImpulse(pComp->m_bID, WP_Physics::ToJoltVec3(_impulse));
+}
+void				WP_PhysicsSystem::AddImpulseToPoint(WP_GameObjectID _id, glm::vec3 const& _impulse, glm::vec3 const& _point)
+{
+	DELAYED_PHYSICS_P2(_id, AddImpulseToPoint, glm::vec3 const&, glm::vec3 const&, _impulse, _point);
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		GetPhysicsBI().AddImpulse(pComp->m_bID, WP_Physics::ToJoltVec3(_impulse), WP_Physics::ToJoltVec3(_point));
+}
+void				WP_PhysicsSystem::AddAngularImpulseToBody(WP_GameObjectID _id, glm::vec3 const& _angularImpulse)
+{
+	DELAYED_PHYSICS_P1(_id, AddAngularImpulseToBody, glm::vec3 const&, _angularImpulse);
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
+		MarkSnapshotDirty(pComp->m_bID);
+		GetPhysicsBI().AddAngularImpulse(pComp->m_bID, WP_Physics::ToJoltVec3(_angularImpulse));
+}
+
+// JPH has a function for buoyancy impulse, but wont be implemented unless needed.
+//bool 	ApplyBuoyancyImpulse (const BodyID &inBodyID, RVec3Arg inSurfacePosition, Vec3Arg inSurfaceNormal, float inBuoyancy, float inLinearDrag, float inAngularDrag, Vec3Arg inFluidVelocity, Vec3Arg inGravity, float inDeltaTime)
+
+//================================================================================
+//						Create Body functions for ECS Component
+//================================================================================
+// create a shape setting for
+#ifdef ILL_DO_THIS_PROPERLY_LATER_PLS
+physicsIdType WP_PhysicsSystem::AddBody(const JPH::ShapeSettings* inShape, glm::vec3 inPosition, glm::vec4 inRotation,
+	JPH::EMotionType inMotionType, JPH::ObjectLayer inObjectLayer);			//add body
+
+physicsIdType WP_PhysicsSystem::AddBody(WP_Physics3D& _comp);			//add body
+
+#endif
+
+WP_PhysicsSystem::physicsIdType WP_PhysicsSystem::AddBody(WP_GameObjectID _id)		//Depriecated?
+{
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		JPH::BodyCreationSettings temp{};
+	return pComp->m_bID = WP_PhysicsSystem::GetInstance()->GetPhysicsBI().CreateBody(temp)->GetID();
+}			//add body
+void				WP_PhysicsSystem::SuspendBody(WP_GameObjectID _id)				//Depriecated?
+{
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		WP_PhysicsSystem::GetInstance()->GetPhysicsBI().RemoveBody(pComp->m_bID);
+}	//suspend body
+void				WP_PhysicsSystem::ResumeBody(WP_GameObjectID _id)				//Depriecated?
+{
+	if (m_isPhysicsLocked) { return; }
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		WP_PhysicsSystem::GetInstance()->GetPhysicsBI().AddBody(pComp->m_bID, JPH::EActivation::Activate);
+}	//re-add body
+void				WP_PhysicsSystem::RemoveBody(WP_GameObjectID _id)				//Depriecated?
+{
+	if (m_isPhysicsLocked) { return; }
+	OBTAIN_PHYSIC_COMPONENT(_id)
+		WP_PhysicsSystem::GetInstance()->GetPhysicsBI().RemoveBody(pComp->m_bID);
+	WP_PhysicsSystem::GetInstance()->GetPhysicsBI().DestroyBody(pComp->m_bID);
+	if (m_isRayCacheEnabled) { InvalidateRayCache(); }
+}	//suspend and remove.
+
+
+void WP_PhysicsSystem::CharacterSetLinearVelocity(WP_GameObjectID _id, glm::vec3 const& _vel)
+{
+	DELAYED_PHYSICS_P1(_id, CharacterSetLinearVelocity, glm::vec3 const&, _vel);
+	OBTAIN_PHYSIC_COMPONENT(_id);
+	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
+	MarkSnapshotDirty(pComp->m_bID);
+	pComp->m_charPtr->SetLinearVelocity(WP_Physics::ToJoltVec3(_vel));
+
+}
+void WP_PhysicsSystem::CharacterAddVelocity(WP_GameObjectID _id, glm::vec3 const& _vel)
+{
+	DELAYED_PHYSICS_P1(_id, CharacterAddVelocity, glm::vec3 const&, _vel);
+	OBTAIN_PHYSIC_COMPONENT(_id);
+	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
+	MarkSnapshotDirty(pComp->m_bID);
+	pComp->m_charPtr->AddLinearVelocity(WP_Physics::ToJoltVec3(_vel));
+}
+glm::vec3 WP_PhysicsSystem::CharacterGetLinearVelocity(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id);
+	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return glm::vec3(0, 0, 0); }
+	return WP_Physics::ToGLMVec3(pComp->m_charPtr->GetLinearVelocity());
+}
+void WP_PhysicsSystem::CharacterAddImpulse(WP_GameObjectID _id, glm::vec3 const& _imp)
+{
+	DELAYED_PHYSICS_P1(_id, CharacterAddImpulse, glm::vec3 const&, _imp);
+	OBTAIN_PHYSIC_COMPONENT(_id);
+	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
+	MarkSnapshotDirty(pComp->m_bID);
+	pComp->m_charPtr->AddImpulse(WP_Physics::ToJoltVec3(_imp));
+}
+
+//rotation in degrees for each axis for the 3D Gimbal
+void WP_PhysicsSystem::CharacterSetRotation(WP_GameObjectID _id, glm::vec3 const& _rotInDegrees)
+{
+	DELAYED_PHYSICS_P1(_id, CharacterSetRotation, glm::vec3 const&, _rotInDegrees);
+	OBTAIN_PHYSIC_COMPONENT(_id);
+	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
+	MarkSnapshotDirty(pComp->m_bID);
+	pComp->m_charPtr->SetRotation(JPH::Quat::sEulerAngles(WP_Physics::ToJoltVec3(GetRadianFromDegreesVector(_rotInDegrees))));
+}
+void WP_PhysicsSystem::CharacterRotate(WP_GameObjectID _id, glm::vec3 const& _addRot)
+{
+	DELAYED_PHYSICS_P1(_id, CharacterRotate, glm::vec3 const&, _addRot);
+	OBTAIN_PHYSIC_COMPONENT(_id);
+	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
+	MarkSnapshotDirty(pComp->m_bID);
+	auto rot = pComp->m_charPtr->GetRotation().GetEulerAngles() + WP_Physics::ToJoltVec3(GetRadianFromDegreesVector(_addRot));
+	pComp->m_charPtr->SetRotation(JPH::Quat::sEulerAngles(rot));
+}
+//rotation for y axis only
+void WP_PhysicsSystem::CharacterRotate(WP_GameObjectID _id, float _angle)
+{
+	DELAYED_PHYSICS_P1(_id, CharacterRotate, float, _angle);
+	OBTAIN_PHYSIC_COMPONENT(_id);
+	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
+	MarkSnapshotDirty(pComp->m_bID);
+	auto rot = pComp->m_charPtr->GetRotation().GetEulerAngles() + WP_Physics::ToJoltVec3(glm::vec3(0, JPH::DegreesToRadians(_angle), 0));
+	pComp->m_charPtr->SetRotation(JPH::Quat::sEulerAngles(rot));
+}
+glm::vec3 WP_PhysicsSystem::CharacterGetRotattion(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id);
+	if (pComp->m_bID.IsInvalid() || !pComp->m_isNPC|| !pComp->m_charPtr)
+	{
+		assert(0 && "no Physics body or is not a Physics Character! WP_Physics3D::CharacterGetRotattion()");
+		return glm::vec3(0, 0, 0);
+	}
+	return GetDegreesFromRadianVector(WP_Physics::ToGLMVec3(pComp->m_charPtr->GetRotation().GetEulerAngles()));
+}
+
+bool WP_PhysicsSystem::CharacterGetIsGrounded(WP_GameObjectID _id) const
+{
+	OBTAIN_CONST_PHYSIC_COMPONENT(_id);
+	if (pComp->m_bID.IsInvalid() || !pComp->m_isNPC || !pComp->m_charPtr)
+	{
+		assert(0 && "no Physics body or is not a Physics Character! WP_Physics3D::CharacterGetIsGrounded()");
+		return false;
+	}
+	switch (pComp->m_charPtr->GetGroundState())
+	{
+	case JPH::Character::EGroundState::InAir :
+	case JPH::Character::EGroundState::NotSupported :
+		return false;
+	case JPH::Character::EGroundState::OnGround :
+	case JPH::Character::EGroundState::OnSteepGround :
+		return true;
+	default:
+		assert(0 && "unknown ground state! WP_Physics3D::CharacterGetIsGrounded()");
+		break;
+	}
+	return true;
+}
+
+
+//================================================================================
+//						Ray Cast Functions for Physics
+//================================================================================
+
+
+//Use this function if trying to raycast and collect result for the closest object.
+//Use CastRayAgainstObject() if attempting to raycast against specific objects.
+bool WP_PhysicsSystem::CastRay(
+	glm::vec3 const&							_origin,
+	glm::vec3 const&							_dirVector,
+	WP_PhysicsSystem::WP_RayResult&				_hit,					//out variable
+	CastBPEnum									_BroadPhaseLayerMask,
+	CastLayerEnum								_ObjectLayerMask,
+	WP_PhysicsSystem::CastIDMask const&			_GameObjectIDMask ) const
+{
+	using namespace WP_Physics;
 
-void				WP_PhysicsSystem::SetBodyPhysicsShape(WP_GameObjectID _id, WP_PhysicsShape _newShapeType,
-	JPH::Shape& _newShape, bool _updateMassProperties, bool _isActive)
+	WP_RayCacheKey cacheKey{};
+	if (m_isRayCacheEnabled)
+	{
+		cacheKey = MakeRayCacheKey(_origin, _dirVector, _BroadPhaseLayerMask, _ObjectLayerMask, _GameObjectIDMask, false);
+		std::lock_guard<std::mutex> lock{ m_rayCacheMutex };
+		if (auto iter = m_rayCache.find(cacheKey); iter != m_rayCache.end())
+		{
+			++m_rayCacheHits;
+			_hit = iter->second.m_hit;
+			return iter->second.m_isHit;
+		}
+		++m_rayCacheMisses;
+	}
+
+	JPH::RRayCast ray { ToJoltVec3(_origin),ToJoltVec3(_dirVector) };
+	JPH::RayCastResult results;
+
+	GetPhysicsNPQ().CastRay(
+		JPH::RRayCast{ ToJoltVec3(_origin),ToJoltVec3(_dirVector) },
+		results,
+		WP_PhysicsSystem::CastBPMask(_BroadPhaseLayerMask),
+		WP_PhysicsSystem::CastLayerMask(_ObjectLayerMask),
+		WP_PhysicsSystem::CastIDFilter(_GameObjectIDMask));
+
+	bool const isHit = !results.mBodyID.IsInvalid();
+	assert( !isHit || m_bodyToID.contains(results.mBodyID.GetIndex()) );
+	if (!isHit)
+	{
+		_hit.first = WP_INVALID_GAMEOBJECTID;
+	}
+	else
+	{
+		_hit.first = GetIDfromSubShape(results.mBodyID, results.mSubShapeID2);
+		_hit.second = results.mFraction;
+	}
+
+	if (m_isRayCacheEnabled)
+	{
+		std::lock_guard<std::mutex> lock{ m_rayCacheMutex };
+		m_rayCache.insert_or_assign(std::move(cacheKey), WP_RayCacheEntry{ isHit, _hit, {} });
+	}
+	return isHit;
+}
+/*
+	WP_RayResult a;
+
+	// CastRay( origin of ray(start),
+	//			direction of ray(vector description of ray if ray starts at origin) ,
+	//			result collector);
+
+	if (CastRay(glm::vec3(0, 1, 0), glm::vec3(0, -2, 0), a))
+	{
+		std::cout << "hit id:[" << a.first << "] \n";
+	}
+	else
+	{
+		std::cout << "NO hit \n";
+	}
+*/
+
+//default collector. when writing custom collector, shift to new function
+//Use this function if trying to raycast and collect result for multiple objects.
+//Use CastRayAgainstObject() if attempting to raycast against specific objects.
+bool WP_PhysicsSystem::CastRay(
+	glm::vec3 const&							_origin,
+	glm::vec3 const&							_dirVector,
+	WP_PhysicsSystem::WP_RayResultCollector&	_hits,		//out all hits variable
+	CastBPEnum									_BroadPhaseLayerMask,
+	CastLayerEnum								_ObjectLayerMask,
+	WP_PhysicsSystem::CastIDMask const&			_GameObjectIDMask) const
 {
-	if (m_isPhysicsLocked) { return; }
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		pComp->m_shapeType = _newShapeType;
-	GetPhysicsBI().SetShape(pComp->m_bID, &_newShape, _updateMassProperties, WP_ACTIVATION_IS_ACTIVE(_isActive));
+	using namespace WP_Physics;
+
+	_hits.clear();
+
+	WP_RayCacheKey cacheKey{};
+	if (m_isRayCacheEnabled)
+	{
+		cacheKey = MakeRayCacheKey(_origin, _dirVector, _BroadPhaseLayerMask, _ObjectLayerMask, _GameObjectIDMask, true);
+		std::lock_guard<std::mutex> lock{ m_rayCacheMutex };
+		if (auto iter = m_rayCache.find(cacheKey); iter != m_rayCache.end())
+		{
+			++m_rayCacheHits;
+			_hits = iter->second.m_hits;
+			return iter->second.m_isHit;
+		}
+		++m_rayCacheMisses;
+	}
+
+	JPH::RRayCast ray{ ToJoltVec3(_origin),ToJoltVec3(_dirVector) };
+	JPH::RayCastSettings raySettings{};
+
+	JPH::AllHitCollisionCollector<JPH::CastRayCollector> results;
+
+	GetPhysicsNPQ().CastRay(
+		JPH::RRayCast{ ToJoltVec3(_origin),ToJoltVec3(_dirVector) },
+		raySettings,
+		results,
+		WP_PhysicsSystem::CastBPMask(_BroadPhaseLayerMask),
+		WP_PhysicsSystem::CastLayerMask(_ObjectLayerMask),
+		WP_PhysicsSystem::CastIDFilter(_GameObjectIDMask));
+
+	if (!results.mHits.size())
+	{
+		if (m_isRayCacheEnabled)
+		{
+			std::lock_guard<std::mutex> lock{ m_rayCacheMutex };
+			m_rayCache.insert_or_assign(std::move(cacheKey), WP_RayCacheEntry{ false, {}, {} });
+		}
+		return false;
+	}
+
+	for (auto& result : results.mHits) //move results to out variable
+	{
+		_hits.push_back(std::make_pair(GetIDfromSubShape(result.mBodyID, result.mSubShapeID2),result.mFraction));
+
+#if 0	//debug code
+		//brute force
+		for (auto& t : WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponentVector())
+		{
+			if (t->m_bID == result.mBodyID)
+			{
+				if (_hits.back().first != t->GetGameObjectID())
+				{
+
+					WP_INFO("OH WOE IS TO BE ME ");
+					std::cout << "storedID [" << m_bodyToID.find(result.mBodyID.GetIndex())->second << "]";
+					std::cout << "storedID [" << _hits.back().first << "]";
+				}
+				else
+				{
+					std::cout << "happy raycast ids stored internally are same [" << m_bodyToID.find(result.mBodyID.GetIndex())->second << "]";
+				}
+
+			}
+		}
+#endif
+	}
+
+	if (m_isRayCacheEnabled)
+	{
+		std::lock_guard<std::mutex> lock{ m_rayCacheMutex };
+		m_rayCache.insert_or_assign(std::move(cacheKey), WP_RayCacheEntry{ true, {}, _hits });
+	}
+	return true;
 }
+//some sample ray cast code for this function ^^
+/*
+	WP_RayResultCollector a;
 
-void				WP_PhysicsSystem::SetBodyFriction(WP_GameObjectID _id, float _newFriction)
+	// CastRay( origin of ray(start),
+	//			direction of ray(vector description of ray if ray starts at origin) ,
+	//			results collector);
+
+	if (CastRay(glm::vec3(0, 1, 0), glm::vec3(0, -2, 0), a))
+	{
+		std::cout << "hits collected:["<< a.size()<<"] \n";
+	}
+	else
+	{
+		std::cout << "NO hit \n";
+	}
+*/
+
+
+
+//Use this function if trying to raycast against a specific gameobject.
+//please refrain from using gameobjects ids that do not have corresponding physics component.
+//Use CastRay if hit check against any object is required.
+bool WP_PhysicsSystem::CastRayAgainstObject(
+	WP_GameObjectID _objectToCheck,
+	glm::vec3 const& _origin,
+	glm::vec3 const& _dirVector) const
 {
-	DELAYED_PHYSICS_P1(_id, SetBodyFriction, float, _newFriction);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetFriction(pComp->m_bID, _newFriction);
+	using namespace WP_Physics;
+	OBTAIN_CONST_PHYSIC_COMPONENT(_objectToCheck);
+	if (!pComp) return false;
+
+	JPH::RayCastResult results;
+	return GetPhysicsBI().GetTransformedShape(pComp->m_bID).CastRay(
+		JPH::RRayCast{ ToJoltVec3(_origin),ToJoltVec3(_dirVector) },
+		results
+	);
 }
-void				WP_PhysicsSystem::SetBodyRestitution(WP_GameObjectID _id, float _newCOR)
+/*
+
+			// CastRay( GameObjectID,
+			//			origin of ray(start),
+			//			direction/length of ray(vector description of ray if ray was moved to origin) );
+
+			if (CastRayAgainstObject(2,glm::vec3(0, 1, 0), glm::vec3(0, -2, 0)))
+			{
+				std::cout << "hit id:[" << 2 << "] \n";
+			}
+			else
+			{
+				std::cout << "NO hit \n";
+			}
+*/
+
+//================================================================================
+//						Radius and nearest queries
+//================================================================================
+
+void WP_PhysicsSystem::CollectWithinRadius(glm::vec3 const& _center, float _radius, WP_GameObjectID _ignored,
+	CastBPEnum _BroadPhaseLayerMask, CastLayerEnum _ObjectLayerMask,
+	WP_PhysicsSystem::CastIDMask const& _GameObjectIDMask, WP_DistanceResultCollector& _hits) const
 {
-	DELAYED_PHYSICS_P1(_id,SetBodyRestitution,float,_newCOR);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetRestitution(pComp->m_bID, _newCOR);
+	using namespace WP_Physics;
+	_hits.clear();
+	JPH::Vec3 const center = ToJoltVec3(_center);
+	JPH::AllHitCollisionCollector<JPH::CollideShapeBodyCollector> collector;
+	m_physics_system.GetBroadPhaseQuery().CollideSphere(center, _radius, collector,
+		WP_PhysicsSystem::CastBPMask(_BroadPhaseLayerMask), WP_PhysicsSystem::CastLayerMask(_ObjectLayerMask));
+
+	//the broadphase only tested bounds, keep bodies whose position is in range
+	float const radiusSq = _radius * _radius;
+	JPH::BodyLockInterface const& lockInterface = m_physics_system.GetBodyLockInterface();
+	for (JPH::BodyID const bID : collector.mHits)
+	{
+		if (m_bakedCells.contains(bID.GetIndex())) { continue; }
+		auto idIter = m_bodyToID.find(bID.GetIndex());
+		if (idIter == m_bodyToID.end()) { continue; }
+		WP_GameObjectID const id = idIter->second;
+		if (id == WP_INVALID_GAMEOBJECTID || id == _ignored || _GameObjectIDMask.find(id) != _GameObjectIDMask.end()) { continue; }
+
+		JPH::BodyLockRead lock{ lockInterface, bID };
+		if (!lock.Succeeded()) { continue; }
+		float const distanceSq = (JPH::Vec3(lock.GetBody().GetPosition()) - center).LengthSq();
+		if (distanceSq > radiusSq) { continue; }
+		_hits.emplace_back(id, std::sqrt(distanceSq));
+	}
 }
-void				WP_PhysicsSystem::SetBodyGravityFactor(WP_GameObjectID _id, float _newGravityFactor)
+
+namespace
 {
-	DELAYED_PHYSICS_P1(_id, SetBodyGravityFactor,float , _newGravityFactor);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetGravityFactor(pComp->m_bID, _newGravityFactor);
+	//nearest first, ties by id so results do not depend on broadphase order
+	bool IsNearer(WP_PhysicsSystem::WP_DistanceResult const& _lhs, WP_PhysicsSystem::WP_DistanceResult const& _rhs)
+	{
+		return (_lhs.second != _rhs.second) ? _lhs.second < _rhs.second : _lhs.first < _rhs.first;
+	}
+
+	void KeepNearest(WP_PhysicsSystem::WP_DistanceResultCollector& _hits, uint32_t _k)
+	{
+		if (_k == 0 || _hits.size() <= _k)
+		{
+			std::sort(_hits.begin(), _hits.end(), IsNearer);
+			return;
+		}
+		std::partial_sort(_hits.begin(), _hits.begin() + _k, _hits.end(), IsNearer);
+		_hits.resize(_k);
+	}
 }
 
-void				WP_PhysicsSystem::SetBodyMotionQuality(WP_GameObjectID _id, JPH::EMotionQuality _newMotionQuality)
+bool WP_PhysicsSystem::QueryRadius(
+	glm::vec3 const&							_center,
+	float										_radius,
+	WP_PhysicsSystem::WP_DistanceResultCollector& _hits,
+	CastBPEnum									_BroadPhaseLayerMask,
+	CastLayerEnum								_ObjectLayerMask,
+	WP_PhysicsSystem::CastIDMask const&			_GameObjectIDMask) const
 {
-	DELAYED_PHYSICS_P1(_id, SetBodyMotionQuality, JPH::EMotionQuality, _newMotionQuality);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetMotionQuality(pComp->m_bID, _newMotionQuality);
+	assert(!m_isPhysicsLocked);
+	CollectWithinRadius(_center, _radius, WP_INVALID_GAMEOBJECTID, _BroadPhaseLayerMask, _ObjectLayerMask, _GameObjectIDMask, _hits);
+	KeepNearest(_hits, 0);
+	return !_hits.empty();
 }
-void				WP_PhysicsSystem::SetBodyMotionType(WP_GameObjectID _id, JPH::EMotionType _newMotionType)
+
+bool WP_PhysicsSystem::QueryNearest(
+	glm::vec3 const&							_center,
+	uint32_t									_k,
+	float										_maxRadius,
+	WP_PhysicsSystem::WP_DistanceResultCollector& _hits,
+	CastBPEnum									_BroadPhaseLayerMask,
+	CastLayerEnum								_ObjectLayerMask,
+	WP_PhysicsSystem::CastIDMask const&			_GameObjectIDMask) const
 {
-	DELAYED_PHYSICS_P1(_id, SetBodyMotionType, JPH::EMotionType, _newMotionType);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetMotionType(pComp->m_bID, _newMotionType, WP_ACTIVATION_IS_ACTIVE(GetBodyActive(_id)));
+	assert(!m_isPhysicsLocked);
+	if (_k == 0) { _hits.clear(); return false; }
+	CollectWithinRadius(_center, _maxRadius, WP_INVALID_GAMEOBJECTID, _BroadPhaseLayerMask, _ObjectLayerMask, _GameObjectIDMask, _hits);
+	KeepNearest(_hits, _k);
+	return !_hits.empty();
 }
-void				WP_PhysicsSystem::SetBodyObjectLayer(WP_GameObjectID _id, JPH::ObjectLayer _newMotionLayer)
+
+void WP_PhysicsSystem::QueryRadiusBatch(
+	std::span<const glm::vec3>					_centers,
+	float										_radius,
+	std::span<WP_DistanceResultCollector>		_hits,
+	std::span<const WP_GameObjectID>			_ignoredPerQuery,
+	CastBPEnum									_BroadPhaseLayerMask,
+	CastLayerEnum								_ObjectLayerMask,
+	WP_PhysicsSystem::CastIDMask const&			_GameObjectIDMask) const
 {
-	DELAYED_PHYSICS_P1(_id, SetBodyObjectLayer, JPH::ObjectLayer, _newMotionLayer);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetObjectLayer(pComp->m_bID, _newMotionLayer);
+	RunQueryBatch(_centers, 0, _radius, _hits, _ignoredPerQuery, _BroadPhaseLayerMask, _ObjectLayerMask, _GameObjectIDMask);
 }
 
-void				WP_PhysicsSystem::SetBodyPosition(WP_GameObjectID _id, glm::vec3 const& _newPos)
+void WP_PhysicsSystem::QueryNearestBatch(
+	std::span<const glm::vec3>					_centers,
+	uint32_t									_k,
+	float										_maxRadius,
+	std::span<WP_DistanceResultCollector>		_hits,
+	std::span<const WP_GameObjectID>			_ignoredPerQuery,
+	CastBPEnum									_BroadPhaseLayerMask,
+	CastLayerEnum								_ObjectLayerMask,
+	WP_PhysicsSystem::CastIDMask const&			_GameObjectIDMask) const
 {
-	DELAYED_PHYSICS_P1(_id, SetBodyPosition, glm::vec3 const&, _newPos);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetPosition(pComp->m_bID, WP_Physics::ToJoltVec3(_newPos) - GetPhysicsBI().GetCenterOfMassPosition(pComp->m_bID)
-			, WP_ACTIVATION_IS_ACTIVE(GetBodyActive(_id)));
+	if (_k == 0)
+	{
+		for (auto& hits : _hits) { hits.clear(); }
+		return;
+	}
+	RunQueryBatch(_centers, _k, _maxRadius, _hits, _ignoredPerQuery, _BroadPhaseLayerMask, _ObjectLayerMask, _GameObjectIDMask);
 }
-void				WP_PhysicsSystem::SetBodyRotation(WP_GameObjectID _id, glm::quat const& _newRot)
+
+void WP_PhysicsSystem::RunQueryBatch(std::span<const glm::vec3> _centers, uint32_t _k, float _radius,
+	std::span<WP_DistanceResultCollector> _hits, std::span<const WP_GameObjectID> _ignoredPerQuery,
+	CastBPEnum _BroadPhaseLayerMask, CastLayerEnum _ObjectLayerMask, WP_PhysicsSystem::CastIDMask const& _GameObjectIDMask) const
 {
-	DELAYED_PHYSICS_P1(_id, SetBodyRotation, glm::quat const&, _newRot);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetRotation(pComp->m_bID, WP_Physics::ToJoltQuat(_newRot), WP_ACTIVATION_IS_ACTIVE(GetBodyActive(_id)));
+	assert(!m_isPhysicsLocked);
+	if (_hits.size() < _centers.size() || (!_ignoredPerQuery.empty() && _ignoredPerQuery.size() < _centers.size()))
+	{
+		WP_WARN("Batch of %u queries has too few outputs or ignored ids. WP_PhysicsSystem::RunQueryBatch()", static_cast<uint32_t>(_centers.size()));
+		return;
+	}
+	uint32_t const numQueries = static_cast<uint32_t>(_centers.size());
+	auto runRange = [=, this](uint32_t _begin, uint32_t _end)
+		{
+			for (uint32_t i = _begin; i < _end; ++i)
+			{
+				WP_GameObjectID const ignored = _ignoredPerQuery.empty() ? WP_INVALID_GAMEOBJECTID : _ignoredPerQuery[i];
+				CollectWithinRadius(_centers[i], _radius, ignored, _BroadPhaseLayerMask, _ObjectLayerMask, _GameObjectIDMask, _hits[i]);
+				KeepNearest(_hits[i], _k);
+			}
+		};
+	if (numQueries <= WP_PHYSICS_QUERY_BATCH_SIZE)
+	{	//not worth a job
+		runRange(0, numQueries);
+		return;
+	}
+	WP_JobSystem* const jobSystem = WP_JobSystem::GetInstance();
+	WP_JobSystem::WP_JobCounter counter;
+	for (uint32_t begin{}; begin < numQueries; begin += WP_PHYSICS_QUERY_BATCH_SIZE)
+	{
+		uint32_t const end = std::min<uint32_t>(begin + WP_PHYSICS_QUERY_BATCH_SIZE, numQueries);
+		jobSystem->Schedule([&runRange, begin, end]() { runRange(begin, end); }, WP_JobSystem::WP_JobPriority::HIGH, &counter);
+	}
+	jobSystem->Wait(counter);
+}
+
+//================================================================================
+//						Ray query cache
+//================================================================================
+
+size_t WP_PhysicsSystem::WP_RayCacheKeyHash::operator()(WP_RayCacheKey const& _key) const
+{
+	uint64_t hash = 14695981039346656037ull;	//FNV-1a over the quantized values
+	auto combine = [&hash](uint64_t _value)
+		{
+			hash ^= _value;
+			hash *= 1099511628211ull;
+		};
+	for (int32_t value : _key.m_ray) { combine(static_cast<uint32_t>(value)); }
+	combine((static_cast<uint64_t>(_key.m_objectLayerMask) << 8) | static_cast<uint64_t>(_key.m_broadPhaseMask));
+	for (WP_GameObjectID id : _key.m_ignoredIDs) { combine(static_cast<uint64_t>(id)); }
+	combine(_key.m_isAllHits);
+	return static_cast<size_t>(hash);
+}
+
+WP_PhysicsSystem::WP_RayCacheKey WP_PhysicsSystem::MakeRayCacheKey(glm::vec3 const& _origin, glm::vec3 const& _dirVector,
+	CastBPLayer _BroadPhaseLayerMask, CastLayer _ObjectLayerMask, CastIDMask const& _GameObjectIDMask, bool _isAllHits) const
+{
+	constexpr float c_inverseQuantum = 1.0f / WP_PHYSICS_RAY_CACHE_QUANTUM;
+	WP_RayCacheKey key{};
+	for (int i{}; i < 3; ++i)
+	{
+		key.m_ray[i] = static_cast<int32_t>(std::lround(_origin[i] * c_inverseQuantum));
+		key.m_ray[i + 3] = static_cast<int32_t>(std::lround(_dirVector[i] * c_inverseQuantum));
+	}
+	key.m_broadPhaseMask = _BroadPhaseLayerMask;
+	key.m_objectLayerMask = _ObjectLayerMask;
+	key.m_ignoredIDs = _GameObjectIDMask;
+	key.m_isAllHits = _isAllHits;
+	return key;
+}
+
+void				WP_PhysicsSystem::SetRayCacheEnabled(bool _enable)
+{
+	m_isRayCacheEnabled = _enable;
+	InvalidateRayCache();
+}
+
+bool				WP_PhysicsSystem::GetIsRayCacheEnabled() const
+{
+	return m_isRayCacheEnabled;
 }
-void				WP_PhysicsSystem::SetBodyRotation(WP_GameObjectID _id, glm::vec3 const& _newRot)
+
+void				WP_PhysicsSystem::InvalidateRayCache()
 {
-	DELAYED_PHYSICS_P1(_id, SetBodyRotation, glm::vec3 const&, _newRot);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetRotation(pComp->m_bID,
-			JPH::Quat::sEulerAngles(WP_Physics::ToJoltVec3(GetRadianFromDegreesVector(_newRot))),
-			WP_ACTIVATION_IS_ACTIVE(GetBodyActive(_id)));
+	std::lock_guard<std::mutex> lock{ m_rayCacheMutex };
+	m_rayCache.clear();
 }
 
-void				WP_PhysicsSystem::SetBodyLinearVelocity(WP_GameObjectID _id, glm::vec3 const& _newLinearVelocity)
+float				WP_PhysicsSystem::GetRayCacheHitRate() const
 {
-	DELAYED_PHYSICS_P1(_id, SetBodyLinearVelocity, glm::vec3 const&, _newLinearVelocity);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetLinearVelocity(pComp->m_bID, WP_Physics::ToJoltVec3(_newLinearVelocity));
+	std::lock_guard<std::mutex> lock{ m_rayCacheMutex };
+	uint64_t const lookups = m_rayCacheHits + m_rayCacheMisses;
+	return lookups ? static_cast<float>(m_rayCacheHits) / static_cast<float>(lookups) : 0.0f;
 }
-void				WP_PhysicsSystem::SetBodyAngularVelocity(WP_GameObjectID _id, glm::vec3 const& _newAngularVelocity)
+
+void				WP_PhysicsSystem::ResetRayCacheStats()
 {
-	DELAYED_PHYSICS_P1(_id, SetBodyAngularVelocity, glm::vec3 const&, _newAngularVelocity);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().SetLinearVelocity(pComp->m_bID, WP_Physics::ToJoltVec3(_newAngularVelocity));
+	std::lock_guard<std::mutex> lock{ m_rayCacheMutex };
+	m_rayCacheHits = m_rayCacheMisses = 0;
 }
 
 //================================================================================
-//					JPH::Body Property Add Force functions
+//						Bulk functions for scripting
 //================================================================================
 
-void				WP_PhysicsSystem::AddForceToBody(WP_GameObjectID _id, glm::vec3 const& _force, bool _isActive)
+namespace
 {
-	DELAYED_PHYSICS_P2(_id, AddForceToBody, glm::vec3 const&, bool, _force, _isActive);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().AddForce(pComp->m_bID, WP_Physics::ToJoltVec3(_force), WP_ACTIVATION_IS_ACTIVE(_isActive));
+	//resolve each id to its component once, skipping ids that are not in the physics system
+	template <typename Func>
+	void ForEachBulkComponent(std::span<const WP_GameObjectID> _ids, Func&& _func)
+	{
+		auto* const list = WP_ComponentList<WP_Physics3D>::GetComponentList();
+		for (size_t i{}; i < _ids.size(); ++i)
+		{
+			WP_Physics3D* pComp = list->GetComponent(_ids[i]);
+			if (!pComp || pComp->m_bID.IsInvalid()) { continue; }
+			_func(i, *pComp);
+		}
+	}
 }
-void				WP_PhysicsSystem::AddForceToPoint(WP_GameObjectID _id, glm::vec3 const& _force, glm::vec3 const& _point, bool _isActive)
+
+//While unlocked the main thread owns the bodies, so the bulk functions use the no lock body
+//interface instead of taking a body mutex per call. While locked they fall back to the single
+//object functions, which queue into the delayed list.
+
+void				WP_PhysicsSystem::BulkSetLinearVelocity(std::span<const WP_GameObjectID> _ids, std::span<const glm::vec3> _vels)
 {
-	DELAYED_PHYSICS_P3(_id, AddForceToPoint, glm::vec3 const&, glm::vec3 const&, bool, _force, _point, _isActive);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().AddForce(pComp->m_bID, WP_Physics::ToJoltVec3(_force), WP_Physics::ToJoltVec3(_point), WP_ACTIVATION_IS_ACTIVE(_isActive));
+	assert(_ids.size() == _vels.size());
+	if (m_isRayCacheEnabled && !m_isPhysicsLocked) { InvalidateRayCache(); }
+	JPH::BodyInterface& bi = m_physics_system.GetBodyInterfaceNoLock();
+	ForEachBulkComponent(_ids, [&](size_t _i, WP_Physics3D& _comp)
+		{
+			if (m_isPhysicsLocked)
+			{
+				_comp.m_isNPC ? CharacterSetLinearVelocity(_ids[_i], _vels[_i]) : SetBodyLinearVelocity(_ids[_i], _vels[_i]);
+				return;
+			}
+			MarkSnapshotDirty(_comp.m_bID);
+			if (_comp.m_isNPC)
+			{
+				if (_comp.m_charPtr) { _comp.m_charPtr->SetLinearVelocity(WP_Physics::ToJoltVec3(_vels[_i])); }
+				return;
+			}
+			bi.SetLinearVelocity(_comp.m_bID, WP_Physics::ToJoltVec3(_vels[_i]));
+		});
 }
-void				WP_PhysicsSystem::AddTorqueToBody(WP_GameObjectID _id, glm::vec3 const& _torque, bool _isActive)
+
+void				WP_PhysicsSystem::BulkAddVelocity(std::span<const WP_GameObjectID> _ids, std::span<const glm::vec3> _vels)
 {
-	DELAYED_PHYSICS_P2(_id, AddTorqueToBody, glm::vec3 const&, bool, _torque, _isActive);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().AddTorque(pComp->m_bID, WP_Physics::ToJoltVec3(_torque), WP_ACTIVATION_IS_ACTIVE(_isActive));
+	assert(_ids.size() == _vels.size());
+	if (m_isRayCacheEnabled && !m_isPhysicsLocked) { InvalidateRayCache(); }
+	JPH::BodyInterface& bi = m_physics_system.GetBodyInterfaceNoLock();
+	ForEachBulkComponent(_ids, [&](size_t _i, WP_Physics3D& _comp)
+		{
+			if (m_isPhysicsLocked)
+			{
+				_comp.m_isNPC ? CharacterAddVelocity(_ids[_i], _vels[_i]) : AddForceToBody(_ids[_i], _vels[_i]);
+				return;
+			}
+			MarkSnapshotDirty(_comp.m_bID);
+			if (_comp.m_isNPC)
+			{
+				if (_comp.m_charPtr) { _comp.m_charPtr->AddLinearVelocity(WP_Physics::ToJoltVec3(_vels[_i])); }
+				return;
+			}
+			bi.AddForce(_comp.m_bID, WP_Physics::ToJoltVec3(_vels[_i]), JPH::EActivation::Activate);
+		});
 }
-void				WP_PhysicsSystem::AddForceAndTorqueToBody(WP_GameObjectID _id, glm::vec3 const& _force, glm::vec3 const& _torque, bool _isActive)
+
+void				WP_PhysicsSystem::BulkAddImpulse(std::span<const WP_GameObjectID> _ids, std::span<const glm::vec3> _impulses)
 {
-	DELAYED_PHYSICS_P3(_id, AddForceAndTorqueToBody, glm::vec3 const&, glm::vec3 const&, bool, _force, _torque, _isActive);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().AddForceAndTorque(pComp->m_bID, WP_Physics::ToJoltVec3(_force), WP_Physics::ToJoltVec3(_torque), WP_ACTIVATION_IS_ACTIVE(_isActive));
+	assert(_ids.size() == _impulses.size());
+	if (m_isRayCacheEnabled && !m_isPhysicsLocked) { InvalidateRayCache(); }
+	JPH::BodyInterface& bi = m_physics_system.GetBodyInterfaceNoLock();
+	ForEachBulkComponent(_ids, [&](size_t _i, WP_Physics3D& _comp)
+		{
+			if (m_isPhysicsLocked)
+			{
+				_comp.m_isNPC ? CharacterAddImpulse(_ids[_i], _impulses[_i]) : AddImpulseToBody(_ids[_i], _impulses[_i]);
+				return;
+			}
+			MarkSnapshotDirty(_comp.m_bID);
+			if (_comp.m_isNPC)
+			{
+				if (_comp.m_charPtr) { _comp.m_charPtr->AddImpulse(WP_Physics::ToJoltVec3(_impulses[_i])); }
+				return;
+			}
+			bi.AddImpulse(_comp.m_bID, WP_Physics::ToJoltVec3(_impulses[_i]));
+		});
 }
 
-void				WP_PhysicsSystem::AddImpulseToBody(WP_GameObjectID _id, glm::vec3 const& _impulse)
+void				WP_PhysicsSystem::BulkSetPosition(std::span<const WP_GameObjectID> _ids, std::span<const glm::vec3> _positions)
 {
-	DELAYED_PHYSICS_P1(_id, AddImpulseToBody, glm::vec3 const&, _impulse);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().AddImpulse(pComp->m_bID, WP_Physics::ToJoltVec3(_impulse));
+	assert(_ids.size() == _positions.size());
+	if (m_isRayCacheEnabled && !m_isPhysicsLocked) { InvalidateRayCache(); }
+	JPH::BodyInterface& bi = m_physics_system.GetBodyInterfaceNoLock();
+	ForEachBulkComponent(_ids, [&](size_t _i, WP_Physics3D& _comp)
+		{
+			if (m_isPhysicsLocked)
+			{
+				SetBodyPosition(_ids[_i], _positions[_i]);
+				return;
+			}
+			MarkSnapshotDirty(_comp.m_bID);
+			//characters included, SetBodyPosition moves their body directly as well
+			bi.SetPosition(_comp.m_bID, ToBodySetPosition(bi, _comp.m_bID, _positions[_i]), WP_ACTIVATION_IS_ACTIVE(_comp.m_isActive));
+		});
 }
-void				WP_PhysicsSystem::AddImpulseToPoint(WP_GameObjectID _id, glm::vec3 const& _impulse, glm::vec3 const& _point)
+
+void				WP_PhysicsSystem::BulkGetLinearVelocity(std::span<const WP_GameObjectID> _ids, std::span<glm::vec3> _outVels) const
 {
-	DELAYED_PHYSICS_P2(_id, AddImpulseToPoint, glm::vec3 const&, glm::vec3 const&, _impulse, _point);
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().AddImpulse(pComp->m_bID, WP_Physics::ToJoltVec3(_impulse), WP_Physics::ToJoltVec3(_point));
+	assert(_ids.size() == _outVels.size());
+	std::fill(_outVels.begin(), _outVels.end(), glm::vec3{ 0.0f });
+	JPH::BodyInterface const& bi = m_physics_system.GetBodyInterfaceNoLock();
+	ForEachBulkComponent(_ids, [&](size_t _i, WP_Physics3D& _comp)
+		{
+			WP_BodyState state;
+			if (_comp.m_isNPC && _comp.m_charPtr)
+				_outVels[_i] = WP_Physics::ToGLMVec3(_comp.m_charPtr->GetLinearVelocity());
+			else if (TryReadSnapshot(_comp.m_bID, state))
+				_outVels[_i] = state.m_linearVelocity;
+			else
+				_outVels[_i] = WP_Physics::ToGLMVec3(bi.GetLinearVelocity(_comp.m_bID));
+		});
 }
-void				WP_PhysicsSystem::AddAngularImpulseToBody(WP_GameObjectID _id, glm::vec3 const& _angularImpulse)
+
+void				WP_PhysicsSystem::BulkGetPosition(std::span<const WP_GameObjectID> _ids, std::span<glm::vec3> _outPositions) const
 {
-	DELAYED_PHYSICS_P1(_id, AddAngularImpulseToBody, glm::vec3 const&, _angularImpulse);
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id)
-		GetPhysicsBI().AddAngularImpulse(pComp->m_bID, WP_Physics::ToJoltVec3(_angularImpulse));
+	assert(_ids.size() == _outPositions.size());
+	std::fill(_outPositions.begin(), _outPositions.end(), glm::vec3{ 0.0f });
+	JPH::BodyInterface const& bi = m_physics_system.GetBodyInterfaceNoLock();
+	ForEachBulkComponent(_ids, [&](size_t _i, WP_Physics3D& _comp)
+		{
+			WP_BodyState state;
+			if (_comp.m_isNPC && _comp.m_charPtr)
+				_outPositions[_i] = WP_Physics::ToGLMVec3(_comp.m_charPtr->GetPosition());
+			else if (TryReadSnapshot(_comp.m_bID, state))
+				_outPositions[_i] = state.m_position;
+			else
+				_outPositions[_i] = WP_Physics::ToGLMVec3(bi.GetPosition(_comp.m_bID));
+		});
 }
 
-// JPH has a function for buoyancy impulse, but wont be implemented unless needed.
-//bool 	ApplyBuoyancyImpulse (const BodyID &inBodyID, RVec3Arg inSurfacePosition, Vec3Arg inSurfaceNormal, float inBuoyancy, float inLinearDrag, float inAngularDrag, Vec3Arg inFluidVelocity, Vec3Arg inGravity, float inDeltaTime)
+uint32_t			WP_PhysicsSystem::BulkCastRay(std::span<const glm::vec3> _origins,
+	std::span<const glm::vec3> _dirVectors, std::span<WP_RayResult> _outHits) const
+{
+	assert(_origins.size() == _dirVectors.size() && _origins.size() == _outHits.size());
+	uint32_t numHits{};
+	for (size_t i{}; i < _origins.size(); ++i)
+	{
+		_outHits[i] = { WP_INVALID_GAMEOBJECTID, 0.0f };
+		numHits += CastRay(_origins[i], _dirVectors[i], _outHits[i]) ? 1 : 0;
+	}
+	return numHits;
+}
+
+
+
+//Raycast enum mask operator Macros
+#ifndef DEFINE_ENUM_LOGIC_OPERATOR
+#define DEFINE_ENUM_LOGIC_OPERATOR(_Type,_op)																\
+constexpr _Type		operator _op					(_Type _lhs , _Type _rhs)								\
+{return (_Type)((std::underlying_type<_Type>::type)(_lhs) _op (std::underlying_type<_Type>::type)(_rhs));}	\
+
+#endif
+
+#ifndef DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR
+#define DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(_Type,_op,_opNoEql)														\
+constexpr _Type &	operator _op					(_Type & _lhs , _Type _rhs)											\
+{return _lhs = (_Type)((std::underlying_type<_Type>::type)(_lhs) _opNoEql (std::underlying_type<_Type>::type)(_rhs));}	\
+
+#endif
+
+#ifndef DEFINE_ENUM_UNARY_LOGIC_OPERATOR
+#define DEFINE_ENUM_UNARY_LOGIC_OPERATOR(_Type,_op)									\
+constexpr _Type		operator _op					(_Type _ref)					\
+{return (_Type)((_op(std::underlying_type<_Type>::type)(_ref)));}					\
+
+#endif
+
+
+DEFINE_ENUM_LOGIC_OPERATOR(CastLayerEnum, &);
+DEFINE_ENUM_LOGIC_OPERATOR(CastLayerEnum, |);
+DEFINE_ENUM_LOGIC_OPERATOR(CastLayerEnum, ^);
+DEFINE_ENUM_UNARY_LOGIC_OPERATOR(CastLayerEnum, ~);
+DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastLayerEnum, &=, &);
+DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastLayerEnum, |=, |);
+DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastLayerEnum, ^=, ^);
+
+DEFINE_ENUM_LOGIC_OPERATOR(CastBPEnum, &);
+DEFINE_ENUM_LOGIC_OPERATOR(CastBPEnum, |);
+DEFINE_ENUM_LOGIC_OPERATOR(CastBPEnum, ^);
+DEFINE_ENUM_UNARY_LOGIC_OPERATOR(CastBPEnum, ~);
+DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastBPEnum, &=, &);
+DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastBPEnum, |=, |);
+DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastBPEnum, ^=, ^);
+
 
 //================================================================================
-//						Create Body functions for ECS Component
+//						Delayed functioncall adder for Physics
 //================================================================================
-// create a shape setting for
-#ifdef ILL_DO_THIS_PROPERLY_LATER_PLS
-physicsIdType WP_PhysicsSystem::AddBody(const JPH::ShapeSettings* inShape, glm::vec3 inPosition, glm::vec4 inRotation,
-	JPH::EMotionType inMotionType, JPH::ObjectLayer inObjectLayer);			//add body
 
-physicsIdType WP_PhysicsSystem::AddBody(WP_Physics3D& _comp);			//add body
+//================================================================================
+//							Contact Listener functions
+//================================================================================
 
-#endif
+#define PHYSICS_CONTACT_SCENE_RELOAD_GUARD								\
+if (WP_PhysicsSystem::GetInstance()->m_isPhysicsReloaded) { return; }	\
 
-WP_PhysicsSystem::physicsIdType WP_PhysicsSystem::AddBody(WP_GameObjectID _id)		//Depriecated?
+using WP_CL = WP_PhysicsSystem::WP_ContactListener;
+
+JPH::ValidateResult	WP_CL::OnContactValidate(const JPH::Body& inBody1, const JPH::Body& inBody2,
+	JPH::RVec3Arg inBaseOffset, const JPH::CollideShapeResult& inCollisionResult)
 {
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		JPH::BodyCreationSettings temp{};
-	return pComp->m_bID = WP_PhysicsSystem::GetInstance()->GetPhysicsBI().CreateBody(temp)->GetID();
-}			//add body
-void				WP_PhysicsSystem::SuspendBody(WP_GameObjectID _id)				//Depriecated?
+	m_numValidatedPairs.fetch_add(1, std::memory_order_relaxed);
+	// Allows you to ignore a contact before it is created (using layers to not make objects collide is cheaper!)
+	if (!m_ignoredPairs.IsEmpty() && m_ignoredPairs.Contains(inBody1.GetID(), inBody2.GetID()))
+	{
+		return JPH::ValidateResult::RejectAllContactsForThisBodyPair;
+	}
+	JPH::ObjectLayer const layer1 = inBody1.GetObjectLayer();
+	JPH::ObjectLayer const layer2 = inBody2.GetObjectLayer();
+	auto const isFiltered = [this](JPH::ObjectLayer _layer) { return _layer < WP_PhysicsLayerMatrix::c_MaxLayers && ((m_filteredLayers >> _layer) & 1u); };
+	if (!isFiltered(layer1) && !isFiltered(layer2))
+	{
+		return JPH::ValidateResult::AcceptAllContactsForThisBodyPair;
+	}
+
+	using namespace WP_Physics;
+	auto physics = WP_PhysicsSystem::GetInstance();
+	JPH::RVec3 const point = inBaseOffset + inCollisionResult.mContactPointOn1;
+	JPH::Vec3 const normal = inCollisionResult.mPenetrationAxis.NormalizedOr(JPH::Vec3::sAxisY());
+	JPH::Vec3 const relativeVelocity = inBody2.GetPointVelocity(point) - inBody1.GetPointVelocity(point);
+	WP_ContactFilterInfo const info{
+		physics->GetIDfromSubShape(inBody1.GetID(), inCollisionResult.mSubShapeID1),
+		physics->GetIDfromSubShape(inBody2.GetID(), inCollisionResult.mSubShapeID2),
+		layer1, layer2, ToGLMVec3(JPH::Vec3(point)), ToGLMVec3(normal), ToGLMVec3(relativeVelocity) };
+
+	//the stricter answer wins
+	WP_ContactFilterResult result = WP_ContactFilterResult::ACCEPT;
+	if (isFiltered(layer1)) { result = m_layerFilters[layer1](info); }
+	if (isFiltered(layer2) && layer2 != layer1 && result != WP_ContactFilterResult::REJECT_PAIR)
+	{
+		result = std::max(result, m_layerFilters[layer2](info));
+	}
+	switch (result)
+	{
+	case WP_ContactFilterResult::REJECT_CONTACT:	return JPH::ValidateResult::RejectContact;
+	case WP_ContactFilterResult::REJECT_PAIR:		return JPH::ValidateResult::RejectAllContactsForThisBodyPair;
+	default:										return JPH::ValidateResult::AcceptAllContactsForThisBodyPair;
+	}
+}
+
+namespace
 {
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		WP_PhysicsSystem::GetInstance()->GetPhysicsBI().RemoveBody(pComp->m_bID);
-}	//suspend body
-void				WP_PhysicsSystem::ResumeBody(WP_GameObjectID _id)				//Depriecated?
+	//order independent key for a body pair
+	uint64_t GetBodyPairKey(JPH::BodyID _body1, JPH::BodyID _body2)
+	{
+		uint64_t const a = _body1.GetIndexAndSequenceNumber();
+		uint64_t const b = _body2.GetIndexAndSequenceNumber();
+		return (a < b) ? (a << 32 | b) : (b << 32 | a);
+	}
+
+	uint64_t GetObjectPairKey(WP_GameObjectID _object1, WP_GameObjectID _object2)
+	{
+		uint64_t const a = static_cast<uint32_t>(_object1);
+		uint64_t const b = static_cast<uint32_t>(_object2);
+		return (a < b) ? (a << 32 | b) : (b << 32 | a);
+	}
+
+	float GetInverseMassOrZero(const JPH::Body& _body)
+	{	//static and kinematic bodies act as infinite mass
+		return _body.IsDynamic() ? _body.GetMotionProperties()->GetInverseMass() : 0.0f;
+	}
+}
+
+void WP_CL::OnStep([[maybe_unused]] const JPH::PhysicsStepListenerContext& inContext)
+{	//steps run one after another, contact callbacks of a step only start after its listeners
+	m_currentStep.store(m_numStepsStarted++, std::memory_order_relaxed);
+}
+
+WP_CL::WP_ContactStripe& WP_CL::GetStripe(WP_ContactPairKey const& _key)
+{	//top bits of a multiplicative hash, the pair key hash keeps low body index bits in its low bits
+	uint64_t const hash = static_cast<uint64_t>(WP_ContactPairKeyHash{}(_key)) * 0x9E3779B97F4A7C15ull;
+	return m_stripes[(hash >> 32) % WP_PHYSICS_CONTACT_STRIPES];
+}
+
+WP_CL::WP_ContactPayloadDelayed& WP_CL::AggregateContact(WP_ContactStripe& _stripe, WP_ContactType _type,
+	WP_ContactPairKey const& _key, WP_GameObjectID _object1, WP_GameObjectID _object2)
 {
-	if (m_isPhysicsLocked) { return; }
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		WP_PhysicsSystem::GetInstance()->GetPhysicsBI().AddBody(pComp->m_bID, JPH::EActivation::Activate);
-}	//re-add body
-void				WP_PhysicsSystem::RemoveBody(WP_GameObjectID _id)				//Depriecated?
+	auto& list = _stripe.m_lists[static_cast<size_t>(_type)];
+	uint32_t const step = m_currentStep.load(std::memory_order_relaxed);
+	auto [iter, isNew] = _stripe.m_indices[static_cast<size_t>(_type)].try_emplace(_key, static_cast<uint32_t>(list.size()));
+	if (isNew)
+	{
+		list.emplace_back(_object1, _object2, step);
+	}
+	auto& record = list[iter->second];
+	record.m_lastStep = step;
+	++record.m_numReports;
+	return record;
+}
+
+void WP_CL::AggregateManifold(WP_ContactType _type, const JPH::Body& _body1, const JPH::Body& _body2,
+	const JPH::ContactManifold& _manifold)
 {
-	if (m_isPhysicsLocked) { return; }
-	OBTAIN_PHYSIC_COMPONENT(_id)
-		WP_PhysicsSystem::GetInstance()->GetPhysicsBI().RemoveBody(pComp->m_bID);
-	WP_PhysicsSystem::GetInstance()->GetPhysicsBI().DestroyBody(pComp->m_bID);
-}	//suspend and remove.
+	using namespace WP_Physics;
+	//estimate impulse from approach speed at the first contact point, before taking the lock
+	float impulse{};
+	float const inverseMassSum = GetInverseMassOrZero(_body1) + GetInverseMassOrZero(_body2);
+	if (inverseMassSum > 0.0f && !_manifold.mRelativeContactPointsOn1.empty())
+	{
+		JPH::RVec3 const point = _manifold.GetWorldSpaceContactPointOn1(0);
+		JPH::Vec3 const relativeVelocity = _body2.GetPointVelocity(point) - _body1.GetPointVelocity(point);
+		float const approachSpeed = -relativeVelocity.Dot(_manifold.mWorldSpaceNormal);
+		impulse = (approachSpeed > 0.0f) ? approachSpeed / inverseMassSum : 0.0f;
+	}
+	JPH::Vec3 normal = _manifold.mWorldSpaceNormal;
 
+	auto physics = WP_PhysicsSystem::GetInstance();
+	WP_GameObjectID const object1 = physics->GetIDfromSubShape(_body1.GetID(), _manifold.mSubShapeID1);
+	WP_GameObjectID const object2 = physics->GetIDfromSubShape(_body2.GetID(), _manifold.mSubShapeID2);
 
-void WP_PhysicsSystem::CharacterSetLinearVelocity(WP_GameObjectID _id, glm::vec3 const& _vel)
-{
-	DELAYED_PHYSICS_P1(_id, CharacterSetLinearVelocity, glm::vec3 const&, _vel);
-	OBTAIN_PHYSIC_COMPONENT(_id);
-	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
-	pComp->m_charPtr->SetLinearVelocity(WP_Physics::ToJoltVec3(_vel));
+	//copy the points now, the manifold is gone once the callback returns
+	WP_ContactPoints points;
+	points.m_numPoints = std::min(static_cast<uint32_t>(_manifold.mRelativeContactPointsOn1.size()), WP_ContactPoints::c_MaxPoints);
+	for (uint32_t i{}; i < points.m_numPoints; ++i)
+	{
+		points.m_pointsOn1[i] = ToGLMVec3(_manifold.GetWorldSpaceContactPointOn1(i));
+		points.m_pointsOn2[i] = ToGLMVec3(_manifold.GetWorldSpaceContactPointOn2(i));
+	}
+	points.m_normal = ToGLMVec3(normal);
+	points.m_penetrationDepth = _manifold.mPenetrationDepth;
+
+	WP_ContactPairKey const key{ GetBodyPairKey(_body1.GetID(), _body2.GetID()), GetObjectPairKey(object1, object2) };
+	WP_ContactStripe& stripe = GetStripe(key);
+	std::lock_guard<std::mutex> lock{ stripe.m_mutex };
+	auto& record = AggregateContact(stripe, _type, key, object1, object2);
+	//keep the normal consistent with the record's body order if the pair was first reported swapped
+	if (record.m_gameObject1 != object1)
+	{
+		normal = -normal;
+		points.m_normal = -points.m_normal;
+		for (uint32_t i{}; i < points.m_numPoints; ++i)
+		{
+			std::swap(points.m_pointsOn1[i], points.m_pointsOn2[i]);
+		}
+	}
+	record.m_impulseEstimate += impulse;
+	record.m_maxPenetration = std::max(record.m_maxPenetration, _manifold.mPenetrationDepth);
+	if (m_isRecordingIslands && (_body1.IsDynamic() || _body2.IsDynamic()))
+	{
+		uint32_t const index1 = _body1.GetID().GetIndex(), index2 = _body2.GetID().GetIndex();
+		stripe.m_islandLinks.emplace_back(_body1.IsDynamic() ? index1 : index2, _body2.IsDynamic() ? index2 : index1);
+	}
+	record.m_normal += ToGLMVec3(normal);
 
+	//one pool slot per record, later collision steps overwrite it with the latest points
+	if (record.m_contactPointIndex == WP_ContactPoints::c_InvalidIndex)
+	{
+		record.m_contactPointIndex = static_cast<uint32_t>(stripe.m_points.size());
+		stripe.m_points.emplace_back();
+	}
+	stripe.m_points[record.m_contactPointIndex] = points;
 }
-void WP_PhysicsSystem::CharacterAddVelocity(WP_GameObjectID _id, glm::vec3 const& _vel)
+
+void WP_CL::GatherContacts()
 {
-	DELAYED_PHYSICS_P1(_id, CharacterAddVelocity, glm::vec3 const&, _vel);
-	OBTAIN_PHYSIC_COMPONENT(_id);
-	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
-	pComp->m_charPtr->AddLinearVelocity(WP_Physics::ToJoltVec3(_vel));
+	using namespace WP_Physics;
+	std::array<std::vector<WP_ContactPayloadDelayed>*, 3> const lists{ &m_ContactAddedList, &m_ContactPersistList, &m_ContactRemovedList };
+	for (WP_ContactStripe& stripe : m_stripes)
+	{
+		uint32_t const pointOffset = static_cast<uint32_t>(m_ContactPointPool.size());
+		m_ContactPointPool.insert(m_ContactPointPool.end(), stripe.m_points.begin(), stripe.m_points.end());
+		for (size_t type{}; type < lists.size(); ++type)
+		{
+			for (WP_ContactPayloadDelayed& record : stripe.m_lists[type])
+			{
+				if (record.m_contactPointIndex != WP_ContactPoints::c_InvalidIndex) { record.m_contactPointIndex += pointOffset; }
+				lists[type]->push_back(record);
+			}
+			stripe.m_lists[type].clear();
+			stripe.m_indices[type].clear();
+		}
+		m_islandLinks.insert(m_islandLinks.end(), stripe.m_islandLinks.begin(), stripe.m_islandLinks.end());
+		stripe.m_points.clear();
+		stripe.m_islandLinks.clear();
+	}
 }
-glm::vec3 WP_PhysicsSystem::CharacterGetLinearVelocity(WP_GameObjectID _id) const
+
+void			WP_CL::OnContactAdded(const JPH::Body& inBody1, const JPH::Body& inBody2,
+	const JPH::ContactManifold& inManifold, [[maybe_unused]] JPH::ContactSettings& ioSettings)
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id);
-	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return glm::vec3(0, 0, 0); }
-	return WP_Physics::ToGLMVec3(pComp->m_charPtr->GetLinearVelocity());
+	PHYSICS_CONTACT_SCENE_RELOAD_GUARD
+	m_numManifolds.fetch_add(1, std::memory_order_relaxed);
+	AggregateManifold(WP_ContactType::ADDED, inBody1, inBody2, inManifold);
+
+#if WP_PHYSICS_IMMEDIATE_CONTACT_NOTIFY
+	auto physics = WP_PhysicsSystem::GetInstance();
+	//notify event
+	WP_ContactPayload payload{
+		physics->GetIDfromSubShape(inBody1.GetID(), inManifold.mSubShapeID1),
+		physics->GetIDfromSubShape(inBody2.GetID(), inManifold.mSubShapeID2),
+		inManifold, ioSettings };
+
+	WP_EventSystem::GetInstance()->Notify(EventType::kPhysicsContactTrigger, &payload);
+#endif
+}
+
+void			WP_CL::OnContactPersisted(const JPH::Body& inBody1, const JPH::Body& inBody2,
+	const JPH::ContactManifold& inManifold, [[maybe_unused]] JPH::ContactSettings& ioSettings)
+{
+	PHYSICS_CONTACT_SCENE_RELOAD_GUARD
+	m_numManifolds.fetch_add(1, std::memory_order_relaxed);
+	AggregateManifold(WP_ContactType::PERSISTED, inBody1, inBody2, inManifold);
+
+#if WP_PHYSICS_IMMEDIATE_PERSIST_NOTIFY
+	auto physics = WP_PhysicsSystem::GetInstance();
+	//notify event
+	WP_ContactPayload payload{
+		physics->GetIDfromSubShape(inBody1.GetID(), inManifold.mSubShapeID1),
+		physics->GetIDfromSubShape(inBody2.GetID(), inManifold.mSubShapeID2),
+		inManifold, ioSettings };
+
+	WP_EventSystem::GetInstance()->Notify(EventType::kPhysicsContactPersist, &payload);
+#endif
 }
-void WP_PhysicsSystem::CharacterAddImpulse(WP_GameObjectID _id, glm::vec3 const& _imp)
+
+void			WP_CL::OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair)
 {
-	DELAYED_PHYSICS_P1(_id, CharacterAddImpulse, glm::vec3 const&, _imp);
-	OBTAIN_PHYSIC_COMPONENT(_id);
-	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
-	pComp->m_charPtr->AddImpulse(WP_Physics::ToJoltVec3(_imp));
+	PHYSICS_CONTACT_SCENE_RELOAD_GUARD
+	auto physics = WP_PhysicsSystem::GetInstance();
+	WP_GameObjectID const object1 = physics->GetIDfromSubShape(inSubShapePair.GetBody1ID(), inSubShapePair.GetSubShapeID1());
+	WP_GameObjectID const object2 = physics->GetIDfromSubShape(inSubShapePair.GetBody2ID(), inSubShapePair.GetSubShapeID2());
+	{	//compound shapes report one removal per sub shape pair, keep one per gameobject pair
+		WP_ContactPairKey const key{ GetBodyPairKey(inSubShapePair.GetBody1ID(), inSubShapePair.GetBody2ID()), GetObjectPairKey(object1, object2) };
+		WP_ContactStripe& stripe = GetStripe(key);
+		std::lock_guard<std::mutex> lock{ stripe.m_mutex };
+		AggregateContact(stripe, WP_ContactType::REMOVED, key, object1, object2);
+	}
+
+#if WP_PHYSICS_IMMEDIATE_CONTACT_NOTIFY
+	//notify event
+	WP_ContactClearPayload payload{ object1, object2 };
+
+	WP_EventSystem::GetInstance()->Notify(EventType::kPhysicsContactExit, &payload);
+#endif
 }
 
-//rotation in degrees for each axis for the 3D Gimbal
-void WP_PhysicsSystem::CharacterSetRotation(WP_GameObjectID _id, glm::vec3 const& _rotInDegrees)
+void			WP_CL::FinalizeContacts()
 {
-	DELAYED_PHYSICS_P1(_id, CharacterSetRotation, glm::vec3 const&, _rotInDegrees);
-	OBTAIN_PHYSIC_COMPONENT(_id);
-	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
-	pComp->m_charPtr->SetRotation(JPH::Quat::sEulerAngles(WP_Physics::ToJoltVec3(GetRadianFromDegreesVector(_rotInDegrees))));
+	auto finalize = [](std::vector<WP_ContactPayloadDelayed>& _list)
+		{
+			for (auto& record : _list)
+			{
+				float const length = glm::length(record.m_normal);
+				record.m_normal = (length > 0.0f) ? record.m_normal / length : record.m_normal;
+			}
+		};
+	finalize(m_ContactAddedList);
+	finalize(m_ContactPersistList);
 }
-void WP_PhysicsSystem::CharacterRotate(WP_GameObjectID _id, glm::vec3 const& _addRot)
+
+//delayed payloads only hold ids and pooled copies of contact data, no references to jolt manifolds
+void			WP_CL::CallbackAllContacts()
 {
-	DELAYED_PHYSICS_P1(_id, CharacterRotate, glm::vec3 const&, _addRot);
-	OBTAIN_PHYSIC_COMPONENT(_id);
-	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
-	auto rot = pComp->m_charPtr->GetRotation().GetEulerAngles() + WP_Physics::ToJoltVec3(GetRadianFromDegreesVector(_addRot));
-	pComp->m_charPtr->SetRotation(JPH::Quat::sEulerAngles(rot));
+	PHYSICS_CONTACT_SCENE_RELOAD_GUARD
+	FinalizeContacts();
+	WP_PhysicsSystem* const physics = WP_PhysicsSystem::GetInstance();
+	EventType currentType = EventType::kPhysicsContactTriggerDelayed;
+	auto notify = [&currentType](auto& _payload)
+		{
+			WP_EventSystem::GetInstance()->Notify(currentType, &_payload);
+#ifdef DEBUG_PHYS_CONTACT
+			switch (currentType)
+			{
+			case EventType::kPhysicsContactTrigger:
+				WP_INFO("ContactTrigger");
+				break;
+			case EventType::kPhysicsContactPersist:
+				WP_INFO("ContactPersist");
+				break;
+			case EventType::kPhysicsContactExit:
+				WP_INFO("ContactExit");
+				break;
+			case EventType::kPhysicsContactTriggerDelayed:
+				WP_INFO("ContactTriggerDelayed");
+				break;
+			case EventType::kPhysicsContactPersistDelayed:
+				WP_INFO("ContactPersistDelayed");
+				break;
+			case EventType::kPhysicsContactExitDelayed:
+				WP_INFO("ContactExitDelayed");
+				break;
+			default:
+				break;
+			}
+#endif // _DEBUG
+		};	//end of lambda
+
+	if (physics->m_isDelayedContactEventsEnabled)
+	{	//sensor enter/exit are only reported through the stream and subscribers, they are not body contacts
+		std::for_each(m_ContactAddedList.begin(), m_ContactAddedList.end(), notify);		//notify contact start
+		currentType = EventType::kPhysicsContactPersistDelayed;
+		std::for_each(m_ContactPersistList.begin(), m_ContactPersistList.end(), notify);	//notify contact persist
+		currentType = EventType::kPhysicsContactExitDelayed;
+		std::for_each(m_ContactRemovedList.begin(), m_ContactRemovedList.end(), notify);	//notify contact end
+	}
+
+	//one call per contact type and stream callback
+	physics->DispatchContactStreams();
+
+	//objects subscribed to their own contacts
+	physics->DispatchContactSubscribers();
+
+	//run all delayed calls to physics set functions
+	auto& delayedList = physics->m_DelayedPhysicsList;
+	for (auto& delayedPhysicsObject : delayedList)
+	{
+		(*delayedPhysicsObject)();	//operator call for each delayed physics object
+	}
+	delayedList.clear();			//remove all delayed calls to physics set functions
 }
-//rotation for y axis only
-void WP_PhysicsSystem::CharacterRotate(WP_GameObjectID _id, float _angle)
+
+void				WP_CL::ClearContacts()
 {
-	DELAYED_PHYSICS_P1(_id, CharacterRotate, float, _angle);
-	OBTAIN_PHYSIC_COMPONENT(_id);
-	if (pComp->m_bID.IsInvalid() || !pComp->m_charPtr) { return; }
-	auto rot = pComp->m_charPtr->GetRotation().GetEulerAngles() + WP_Physics::ToJoltVec3(glm::vec3(0, JPH::DegreesToRadians(_angle), 0));
-	pComp->m_charPtr->SetRotation(JPH::Quat::sEulerAngles(rot));
+	m_ContactAddedList.clear(); m_ContactPersistList.clear(); m_ContactRemovedList.clear();
+	for (WP_ContactStripe& stripe : m_stripes)
+	{	//normally emptied by GatherContacts, not after an update outside the frame loop
+		for (auto& list : stripe.m_lists) { list.clear(); }
+		for (auto& index : stripe.m_indices) { index.clear(); }
+		stripe.m_points.clear();
+		stripe.m_islandLinks.clear();
+	}
+	m_ContactPointPool.clear();		//keeps capacity, no allocation once warmed up
+	m_islandLinks.clear();
+	m_numStepsStarted = 0;
 }
-glm::vec3 WP_PhysicsSystem::CharacterGetRotattion(WP_GameObjectID _id) const
+
+WP_Physics::WP_ContactPoints const* WP_CL::GetContactPoints(WP_ContactPayloadDelayed const& _contact) const
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id);
-	if (pComp->m_bID.IsInvalid() || !pComp->m_isNPC|| !pComp->m_charPtr)
-	{
-		assert(0 && "no Physics body or is not a Physics Character! WP_Physics3D::CharacterGetRotattion()");
-		return glm::vec3(0, 0, 0);
-	}
-	return GetDegreesFromRadianVector(WP_Physics::ToGLMVec3(pComp->m_charPtr->GetRotation().GetEulerAngles()));
+	if (_contact.m_contactPointIndex >= m_ContactPointPool.size()) { return nullptr; }
+	return &m_ContactPointPool[_contact.m_contactPointIndex];
 }
 
-bool WP_PhysicsSystem::CharacterGetIsGrounded(WP_GameObjectID _id) const
+std::span<const WP_CL::WP_ContactPayloadDelayed> WP_CL::GetContacts(WP_ContactType _type) const
 {
-	OBTAIN_CONST_PHYSIC_COMPONENT(_id);
-	if (pComp->m_bID.IsInvalid() || !pComp->m_isNPC || !pComp->m_charPtr)
-	{
-		assert(0 && "no Physics body or is not a Physics Character! WP_Physics3D::CharacterGetIsGrounded()");
-		return false;
-	}
-	switch (pComp->m_charPtr->GetGroundState())
+	switch (_type)
 	{
-	case JPH::Character::EGroundState::InAir :
-	case JPH::Character::EGroundState::NotSupported :
-		return false;
-	case JPH::Character::EGroundState::OnGround :
-	case JPH::Character::EGroundState::OnSteepGround :
-		return true;
+	case WP_ContactType::ADDED:
+		return m_ContactAddedList;
+	case WP_ContactType::PERSISTED:
+		return m_ContactPersistList;
+	case WP_ContactType::REMOVED:
+		return m_ContactRemovedList;
+	case WP_ContactType::SENSOR_ENTER:
+	case WP_ContactType::SENSOR_EXIT:
+		return {};	//owned by the sensor tracker, see WP_PhysicsSystem::GetContactStream()
 	default:
-		assert(0 && "unknown ground state! WP_Physics3D::CharacterGetIsGrounded()");
-		break;
+		assert(0 && "Invalid contact type, WP_ContactListener::GetContacts()");
+		return {};
 	}
-	return true;
 }
 
-
 //================================================================================
-//						Ray Cast Functions for Physics
+//						Per GameObject contact subscription
 //================================================================================
 
-
-//Use this function if trying to raycast and collect result for the closest object.
-//Use CastRayAgainstObject() if attempting to raycast against specific objects.
-bool WP_PhysicsSystem::CastRay(
-	glm::vec3 const&							_origin,
-	glm::vec3 const&							_dirVector,
-	WP_PhysicsSystem::WP_RayResult&				_hit,					//out variable
-	CastBPEnum									_BroadPhaseLayerMask,
-	CastLayerEnum								_ObjectLayerMask,
-	WP_PhysicsSystem::CastIDMask const&			_GameObjectIDMask ) const
+WP_PhysicsSystem::WP_ContactSpan WP_PhysicsSystem::GetContactStream(WP_ContactType _type) const
 {
-	using namespace WP_Physics;
-
-	JPH::RRayCast ray { ToJoltVec3(_origin),ToJoltVec3(_dirVector) };
-	JPH::RayCastResult results;
+	switch (_type)
+	{
+	case WP_ContactType::SENSOR_ENTER:
+		return m_sensorEnterList;
+	case WP_ContactType::SENSOR_EXIT:
+		return m_sensorExitList;
+	default:
+		return m_ContactListener.GetContacts(_type);
+	}
+}
 
-	GetPhysicsNPQ().CastRay(
-		JPH::RRayCast{ ToJoltVec3(_origin),ToJoltVec3(_dirVector) },
-		results,
-		WP_PhysicsSystem::CastBPMask(_BroadPhaseLayerMask),
-		WP_PhysicsSystem::CastLayerMask(_ObjectLayerMask),
-		WP_PhysicsSystem::CastIDFilter(_GameObjectIDMask));
+WP_Physics::WP_ContactPoints const* WP_PhysicsSystem::GetContactPoints(WP_ContactRecord const& _contact) const
+{
+	return m_ContactListener.GetContactPoints(_contact);
+}
 
-	assert( m_bodyToID.contains(results.mBodyID.GetIndex()) );
-	if (results.mBodyID.IsInvalid())
-	{
-		_hit.first = WP_INVALID_GAMEOBJECTID;
-		return false;
+WP_PhysicsSystem::WP_ContactSubscriptionID WP_PhysicsSystem::SubscribeContact(
+	WP_GameObjectID _id, WP_ContactType _type, WP_ContactCallback _callback)
+{
+	if (!_callback || _type >= WP_ContactType::NUM_CONTACT_TYPES) { return c_InvalidContactSubscription; }
+
+	WP_ContactSubscriptionID const subscription = m_nextContactSubscription++;
+	m_contactSubscriptionOwner.emplace(subscription, _id);
+	if (m_isDispatchingContacts)
+	{	//subscriber lists are being iterated, add after dispatch
+		m_pendingContactSubscribers.emplace_back(_id, WP_ContactSubscriber{ subscription, _type, std::move(_callback) });
+		return subscription;
 	}
-	_hit.first = m_bodyToID.find(results.mBodyID.GetIndex())->second;
-	_hit.second = results.mFraction;
+	m_contactSubscribers[_id].push_back(WP_ContactSubscriber{ subscription, _type, std::move(_callback) });
+	return subscription;
+}
 
-	return true;
+WP_PhysicsSystem::WP_ContactSubscriptionID WP_PhysicsSystem::AddContactStreamCallback(WP_ContactStreamCallback _callback)
+{
+	if (!_callback) { return c_InvalidContactSubscription; }
+	WP_ContactSubscriptionID const subscription = m_nextContactSubscription++;
+	m_contactStreamCallbacks.emplace_back(subscription, std::move(_callback));
+	return subscription;
 }
-/*
-	WP_RayResult a;
 
-	// CastRay( origin of ray(start),
-	//			direction of ray(vector description of ray if ray starts at origin) ,
-	//			result collector);
+void WP_PhysicsSystem::RemoveContactStreamCallback(WP_ContactSubscriptionID _subscription)
+{
+	auto iter = std::find_if(m_contactStreamCallbacks.begin(), m_contactStreamCallbacks.end(),
+		[_subscription](auto const& _ref) { return _ref.first == _subscription; });
+	if (iter == m_contactStreamCallbacks.end()) { return; }
+	if (m_isDispatchingContacts) { iter->second = nullptr; return; }	//erased after the dispatch
+	m_contactStreamCallbacks.erase(iter);
+}
 
-	if (CastRay(glm::vec3(0, 1, 0), glm::vec3(0, -2, 0), a))
+void WP_PhysicsSystem::DispatchContactStreams()
+{
+	if (m_contactStreamCallbacks.empty()) { return; }
+	m_isDispatchingContacts = true;
+	size_t const numCallbacks = m_contactStreamCallbacks.size();	//added while dispatching start next update
+	for (uint8_t type = 0; type < static_cast<uint8_t>(WP_ContactType::NUM_CONTACT_TYPES); ++type)
 	{
-		std::cout << "hit id:[" << a.first << "] \n";
+		WP_ContactType const contactType = static_cast<WP_ContactType>(type);
+		WP_ContactSpan const contacts = GetContactStream(contactType);
+		if (contacts.empty()) { continue; }
+		for (size_t i{}; i < numCallbacks; ++i)
+		{	//copy, a callback adding another can grow the vector under it
+			WP_ContactStreamCallback const callback = m_contactStreamCallbacks[i].second;
+			if (callback) { callback(contactType, contacts); }
+		}
 	}
-	else
+	m_isDispatchingContacts = false;
+	std::erase_if(m_contactStreamCallbacks, [](auto const& _ref) { return !_ref.second; });
+}
+
+void WP_PhysicsSystem::UnsubscribeContact(WP_ContactSubscriptionID _subscription)
+{
+	if (m_isDispatchingContacts)
 	{
-		std::cout << "NO hit \n";
+		m_pendingContactUnsubscribes.push_back(_subscription);
+		return;
 	}
-*/
+	RemoveContactSubscriber(_subscription);
+}
 
-//default collector. when writing custom collector, shift to new function
-//Use this function if trying to raycast and collect result for multiple objects.
-//Use CastRayAgainstObject() if attempting to raycast against specific objects.
-bool WP_PhysicsSystem::CastRay(
-	glm::vec3 const&							_origin,
-	glm::vec3 const&							_dirVector,
-	WP_PhysicsSystem::WP_RayResultCollector&	_hits,		//out all hits variable
-	CastBPEnum									_BroadPhaseLayerMask,
-	CastLayerEnum								_ObjectLayerMask,
-	WP_PhysicsSystem::CastIDMask const&			_GameObjectIDMask) const
+void WP_PhysicsSystem::RemoveContactSubscriber(WP_ContactSubscriptionID _subscription)
 {
-	using namespace WP_Physics;
-
-	_hits.clear();
-
-	JPH::RRayCast ray{ ToJoltVec3(_origin),ToJoltVec3(_dirVector) };
-	JPH::RayCastSettings raySettings{};
-
-	JPH::AllHitCollisionCollector<JPH::CastRayCollector> results;
-
-	GetPhysicsNPQ().CastRay(
-		JPH::RRayCast{ ToJoltVec3(_origin),ToJoltVec3(_dirVector) },
-		raySettings,
-		results,
-		WP_PhysicsSystem::CastBPMask(_BroadPhaseLayerMask),
-		WP_PhysicsSystem::CastLayerMask(_ObjectLayerMask),
-		WP_PhysicsSystem::CastIDFilter(_GameObjectIDMask));
-
-	if (!results.mHits.size())	{	return false;	}
+	auto ownerIter = m_contactSubscriptionOwner.find(_subscription);
+	if (ownerIter == m_contactSubscriptionOwner.end()) { return; }
+
+	auto listIter = m_contactSubscribers.find(ownerIter->second);
+	m_contactSubscriptionOwner.erase(ownerIter);
+	if (listIter == m_contactSubscribers.end()) { return; }
+
+	auto& list = listIter->second;
+	list.erase(std::remove_if(list.begin(), list.end(),
+		[_subscription](WP_ContactSubscriber const& _sub) { return _sub.m_subscriptionID == _subscription; }),
+		list.end());
+	if (list.empty()) { m_contactSubscribers.erase(listIter); }
+}
 
-	for (auto& result : results.mHits) //move results to out variable
+void WP_PhysicsSystem::ApplyPendingContactSubscriptions()
+{
+	for (auto& [id, subscriber] : m_pendingContactSubscribers)
 	{
-		_hits.push_back(std::make_pair(m_bodyToID.find(result.mBodyID.GetIndex())->second,result.mFraction));
-
-#if 0	//debug code
-		//brute force
-		for (auto& t : WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponentVector())
-		{
-			if (t->m_bID == result.mBodyID)
-			{
-				if (_hits.back().first != t->GetGameObjectID())
-				{
-
-					WP_INFO("OH WOE IS TO BE ME ");
-					std::cout << "storedID [" << m_bodyToID.find(result.mBodyID.GetIndex())->second << "]";
-					std::cout << "storedID [" << _hits.back().first << "]";
-				}
-				else
-				{
-					std::cout << "happy raycast ids stored internally are same [" << m_bodyToID.find(result.mBodyID.GetIndex())->second << "]";
-				}
+		m_contactSubscribers[id].push_back(std::move(subscriber));
+	}
+	m_pendingContactSubscribers.clear();
 
-			}
-		}
-#endif
+	for (auto subscription : m_pendingContactUnsubscribes)
+	{
+		RemoveContactSubscriber(subscription);
 	}
-	return true;
+	m_pendingContactUnsubscribes.clear();
 }
-//some sample ray cast code for this function ^^
-/*
-	WP_RayResultCollector a;
 
-	// CastRay( origin of ray(start),
-	//			direction of ray(vector description of ray if ray starts at origin) ,
-	//			results collector);
+//================================================================================
+//						Contact filtering
+//================================================================================
 
-	if (CastRay(glm::vec3(0, 1, 0), glm::vec3(0, -2, 0), a))
+void WP_PhysicsSystem::IgnoreContacts(WP_GameObjectID _id1, WP_GameObjectID _id2)
+{
+	DELAYED_PHYSICS_P1(_id1, IgnoreContacts, WP_GameObjectID, _id2);
+	auto* const comp1 = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponent(_id1);
+	auto* const comp2 = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponent(_id2);
+	if (!comp1 || !comp2 || comp1->m_bID.IsInvalid() || comp2->m_bID.IsInvalid())
 	{
-		std::cout << "hits collected:["<< a.size()<<"] \n";
+		WP_WARN("Gameobject %u or %u has no body. WP_PhysicsSystem::IgnoreContacts()", _id1, _id2);
+		return;
 	}
-	else
+	if (!m_ContactListener.m_ignoredPairs.Add(comp1->m_bID, comp2->m_bID)) { return; }
+	//a pair already touching reuses its cached manifold and is not validated again
+	GetPhysicsBI().InvalidateContactCache(comp1->m_bID);
+}
+
+void WP_PhysicsSystem::UnignoreContacts(WP_GameObjectID _id1, WP_GameObjectID _id2)
+{
+	DELAYED_PHYSICS_P1(_id1, UnignoreContacts, WP_GameObjectID, _id2);
+	auto* const comp1 = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponent(_id1);
+	auto* const comp2 = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponent(_id2);
+	if (!comp1 || !comp2) { return; }
+	if (m_ContactListener.m_ignoredPairs.Remove(comp1->m_bID, comp2->m_bID))
 	{
-		std::cout << "NO hit \n";
+		GetPhysicsBI().InvalidateContactCache(comp1->m_bID);
 	}
-*/
-
+}
 
+bool WP_PhysicsSystem::GetIsContactIgnored(WP_GameObjectID _id1, WP_GameObjectID _id2) const
+{
+	auto const* const comp1 = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponent(_id1);
+	auto const* const comp2 = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponent(_id2);
+	return comp1 && comp2 && m_ContactListener.m_ignoredPairs.Contains(comp1->m_bID, comp2->m_bID);
+}
 
-//Use this function if trying to raycast against a specific gameobject.
-//please refrain from using gameobjects ids that do not have corresponding physics component.
-//Use CastRay if hit check against any object is required.
-bool WP_PhysicsSystem::CastRayAgainstObject(
-	WP_GameObjectID _objectToCheck,
-	glm::vec3 const& _origin,
-	glm::vec3 const& _dirVector) const
+void WP_PhysicsSystem::ClearIgnoredContacts()
 {
-	using namespace WP_Physics;
-	OBTAIN_CONST_PHYSIC_COMPONENT(_objectToCheck);
-	if (!pComp) return false;
+	assert(!m_isPhysicsLocked);
+	m_ContactListener.m_ignoredPairs.Clear();
+}
 
-	JPH::RayCastResult results;
-	return GetPhysicsBI().GetTransformedShape(pComp->m_bID).CastRay(
-		JPH::RRayCast{ ToJoltVec3(_origin),ToJoltVec3(_dirVector) },
-		results
-	);
+void WP_PhysicsSystem::SetLayerContactFilter(JPH::ObjectLayer _layer, WP_ContactFilter _filter)
+{
+	assert(!m_isPhysicsLocked);
+	if (_layer >= WP_PhysicsLayerMatrix::c_MaxLayers)
+	{
+		WP_WARN("Layer %u out of range. WP_PhysicsSystem::SetLayerContactFilter()", static_cast<uint32_t>(_layer));
+		return;
+	}
+	uint32_t const bit = 1u << _layer;
+	m_ContactListener.m_filteredLayers = _filter ? (m_ContactListener.m_filteredLayers | bit) : (m_ContactListener.m_filteredLayers & ~bit);
+	m_ContactListener.m_layerFilters[_layer] = std::move(_filter);
 }
-/*
 
-			// CastRay( GameObjectID,
-			//			origin of ray(start),
-			//			direction/length of ray(vector description of ray if ray was moved to origin) );
+//call subscribers of each object in a contact pair. main thread only, after physics update.
+void WP_PhysicsSystem::DispatchContactSubscribers()
+{
+	if (m_contactSubscribers.empty()) { return; }
+	m_isDispatchingContacts = true;
 
-			if (CastRayAgainstObject(2,glm::vec3(0, 1, 0), glm::vec3(0, -2, 0)))
+	auto dispatchTo = [this](WP_GameObjectID _id, WP_ContactType _type, WP_ContactRecord const& _contact)
+		{
+			auto iter = m_contactSubscribers.find(_id);
+			if (iter == m_contactSubscribers.end()) { return; }
+			for (auto const& subscriber : iter->second)
 			{
-				std::cout << "hit id:[" << 2 << "] \n";
+				if (subscriber.m_type == _type) { subscriber.m_callback(_type, _contact); }
 			}
-			else
+		};
+
+	for (WP_ContactType type{}; type < WP_ContactType::NUM_CONTACT_TYPES;
+		type = static_cast<WP_ContactType>(static_cast<uint8_t>(type) + 1))
+	{
+		for (auto const& contact : GetContactStream(type))
+		{
+			dispatchTo(contact.m_gameObject1, type, contact);
+			if (contact.m_gameObject2 != contact.m_gameObject1)
 			{
-				std::cout << "NO hit \n";
+				dispatchTo(contact.m_gameObject2, type, contact);
 			}
-*/
+		}
+	}
 
+	m_isDispatchingContacts = false;
+	ApplyPendingContactSubscriptions();
+}
 
-//Raycast enum mask operator Macros
-#ifndef DEFINE_ENUM_LOGIC_OPERATOR
-#define DEFINE_ENUM_LOGIC_OPERATOR(_Type,_op)																\
-constexpr _Type		operator _op					(_Type _lhs , _Type _rhs)								\
-{return (_Type)((std::underlying_type<_Type>::type)(_lhs) _op (std::underlying_type<_Type>::type)(_rhs));}	\
+//================================================================================
+//						Sensor overlap tracker
+//================================================================================
 
-#endif
+namespace
+{
+	//tracked sensors are out of the simulation by collision group, not by layer, so the queries use the plain matrix
+	class WP_SensorBroadPhaseFilter final : public JPH::BroadPhaseLayerFilter
+	{
+	public:
+		WP_SensorBroadPhaseFilter(WP_PhysicsLayerMatrix const& _matrix, JPH::ObjectLayer _layer)
+			: m_matrix{ _matrix }, m_layer{ _layer } {/*Empty by Design*/ }
+		virtual bool			ShouldCollide(JPH::BroadPhaseLayer _inLayer) const override
+		{
+			return m_matrix.ShouldCollide(m_layer, _inLayer);
+		}
+	private:
+		WP_PhysicsLayerMatrix const&	m_matrix;
+		JPH::ObjectLayer				m_layer;
+	};
 
-#ifndef DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR
-#define DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(_Type,_op,_opNoEql)														\
-constexpr _Type &	operator _op					(_Type & _lhs , _Type _rhs)											\
-{return _lhs = (_Type)((std::underlying_type<_Type>::type)(_lhs) _opNoEql (std::underlying_type<_Type>::type)(_rhs));}	\
+	class WP_SensorObjectLayerFilter final : public JPH::ObjectLayerFilter
+	{
+	public:
+		WP_SensorObjectLayerFilter(WP_PhysicsLayerMatrix const& _matrix, JPH::ObjectLayer _layer)
+			: m_matrix{ _matrix }, m_layer{ _layer } {/*Empty by Design*/ }
+		virtual bool			ShouldCollide(JPH::ObjectLayer _inLayer) const override
+		{
+			return m_matrix.ShouldCollide(m_layer, _inLayer);
+		}
+	private:
+		WP_PhysicsLayerMatrix const&	m_matrix;
+		JPH::ObjectLayer				m_layer;
+	};
+
+	//checked when the broadphase pairs bodies, so tracked sensors never reach the narrow phase
+	class WP_TrackedSensorGroupFilter final : public JPH::GroupFilter
+	{
+	public:
+		virtual bool			CanCollide(JPH::CollisionGroup const& _inGroup1, JPH::CollisionGroup const& _inGroup2) const override
+		{
+			return false;
+		}
+	};
+}
 
+void WP_PhysicsSystem::UpdateSensorTracking(WP_Physics3D& _comp)
+{
+	if (!_comp.m_isTrigger || _comp.m_isNPC || _comp.m_bID.IsInvalid()) { UnregisterSensor(_comp.GetGameObjectID()); return; }
+	bool const isTracked = _comp.m_isInPhysicsSystem && m_layerMatrix.IsTrackedSensorLayer(GetPhysicsBI().GetObjectLayer(_comp.m_bID));
+	if (isTracked) { RegisterSensor(_comp.GetGameObjectID()); }
+	else { UnregisterSensor(_comp.GetGameObjectID()); }
+#if !WP_PHYSICS_SENSOR_CONTACT_EVENTS
+	if (!m_trackedSensorFilter) { m_trackedSensorFilter = new WP_TrackedSensorGroupFilter; }
+	JPH::BodyLockWrite lock{ m_physics_system.GetBodyLockInterface(), _comp.m_bID };
+	if (!lock.Succeeded()) { return; }
+	lock.GetBody().SetCollisionGroup(isTracked ? JPH::CollisionGroup{ m_trackedSensorFilter, 0, 0 } : JPH::CollisionGroup{});
 #endif
+}
 
-#ifndef DEFINE_ENUM_UNARY_LOGIC_OPERATOR
-#define DEFINE_ENUM_UNARY_LOGIC_OPERATOR(_Type,_op)									\
-constexpr _Type		operator _op					(_Type _ref)					\
-{return (_Type)((_op(std::underlying_type<_Type>::type)(_ref)));}					\
+void WP_PhysicsSystem::RegisterSensor(WP_GameObjectID _id)
+{
+	if (m_sensorIndex.contains(_id)) { return; }
+	m_sensorIndex.emplace(_id, static_cast<uint32_t>(m_sensors.size()));
+	m_sensors.push_back(WP_SensorState{ _id, {} });
+}
 
-#endif
+void WP_PhysicsSystem::UnregisterSensor(WP_GameObjectID _id)
+{
+	auto iter = m_sensorIndex.find(_id);
+	if (iter == m_sensorIndex.end()) { return; }
+	for (WP_GameObjectID other : m_sensors[iter->second].m_overlaps)
+	{	//reported with the next update's exits
+		m_sensorPendingExitList.emplace_back(_id, other);
+	}
+	RemoveSensorAt(iter->second);
+}
 
+void WP_PhysicsSystem::RemoveSensorAt(uint32_t _index)
+{
+	m_sensorIndex.erase(m_sensors[_index].m_id);
+	if (_index != m_sensors.size() - 1)
+	{	//swap and pop, keep sensors dense
+		m_sensors[_index] = std::move(m_sensors.back());
+		m_sensorIndex[m_sensors[_index].m_id] = _index;
+	}
+	m_sensors.pop_back();
+}
 
-DEFINE_ENUM_LOGIC_OPERATOR(CastLayerEnum, &);
-DEFINE_ENUM_LOGIC_OPERATOR(CastLayerEnum, |);
-DEFINE_ENUM_LOGIC_OPERATOR(CastLayerEnum, ^);
-DEFINE_ENUM_UNARY_LOGIC_OPERATOR(CastLayerEnum, ~);
-DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastLayerEnum, &=, &);
-DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastLayerEnum, |=, |);
-DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastLayerEnum, ^=, ^);
+std::span<const WP_GameObjectID> WP_PhysicsSystem::GetSensorOverlaps(WP_GameObjectID _id) const
+{
+	auto iter = m_sensorIndex.find(_id);
+	if (iter == m_sensorIndex.end()) { return {}; }
+	return m_sensors[iter->second].m_overlaps;
+}
 
-DEFINE_ENUM_LOGIC_OPERATOR(CastBPEnum, &);
-DEFINE_ENUM_LOGIC_OPERATOR(CastBPEnum, |);
-DEFINE_ENUM_LOGIC_OPERATOR(CastBPEnum, ^);
-DEFINE_ENUM_UNARY_LOGIC_OPERATOR(CastBPEnum, ~);
-DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastBPEnum, &=, &);
-DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastBPEnum, |=, |);
-DEFINE_ENUM_LOGIC_ASSIGNMENT_OPERATOR(CastBPEnum, ^=, ^);
+void WP_PhysicsSystem::ClearSensors()
+{
+	m_sensors.clear();
+	m_sensorIndex.clear();
+	m_sensorEnterList.clear();
+	m_sensorExitList.clear();
+	m_sensorPendingExitList.clear();
+}
+
+void WP_PhysicsSystem::UpdateSensors()
+{
+	m_sensorEnterList.clear();
+	m_sensorExitList.clear();
+	for (auto const& exit : m_sensorPendingExitList)
+	{
+		m_sensorExitList.emplace_back(exit.m_gameObject1, exit.m_gameObject2);
+	}
+	m_sensorPendingExitList.clear();
+	if (m_sensors.empty()) { return; }
+
+	//main thread after the update, no other thread touches the bodies
+	JPH::BodyInterface const& bi = m_physics_system.GetBodyInterfaceNoLock();
+	JPH::NarrowPhaseQuery const& narrowPhase = m_physics_system.GetNarrowPhaseQueryNoLock();
+	auto* const physicsList = WP_ComponentList<WP_Physics3D>::GetComponentList();
+	JPH::AllHitCollisionCollector<JPH::CollideShapeCollector> collector;
+	JPH::CollideShapeSettings settings;
+	settings.mBackFaceMode = JPH::EBackFaceMode::CollideWithBackFaces;	//inside a mesh still counts as overlapping
+
+	//backwards so sensors that lost their component can be swap-removed
+	for (uint32_t i = static_cast<uint32_t>(m_sensors.size()); i-- > 0;)
+	{
+		WP_SensorState& sensor = m_sensors[i];
+		WP_Physics3D const* pComp = physicsList->GetComponent(sensor.m_id);
 
+		m_sensorScratch.clear();
+		if (pComp && !pComp->m_bID.IsInvalid() && pComp->m_isInPhysicsSystem)
+		{
+			JPH::ObjectLayer const layer = bi.GetObjectLayer(pComp->m_bID);
+			JPH::TransformedShape const shape = bi.GetTransformedShape(pComp->m_bID);
+			JPH::RMat44 const comTransform = shape.GetCenterOfMassTransform();
+			collector.Reset();
+			//exact shape overlap, bounds alone would report bodies that only touch the sensor's box
+			narrowPhase.CollideShape(shape.mShape, shape.GetShapeScale(), comTransform, settings, comTransform.GetTranslation(), collector,
+				WP_SensorBroadPhaseFilter{ m_layerMatrix, layer }, WP_SensorObjectLayerFilter{ m_layerMatrix, layer },
+				JPH::IgnoreSingleBodyFilter{ pComp->m_bID });
+
+			for (JPH::CollideShapeResult const& hit : collector.mHits)
+			{
+				auto bodyIter = m_bodyToID.find(hit.mBodyID2.GetIndex());
+				if (bodyIter == m_bodyToID.end() || bodyIter->second == WP_INVALID_GAMEOBJECTID) { continue; }
+				m_sensorScratch.push_back(bodyIter->second);
+			}
+			std::sort(m_sensorScratch.begin(), m_sensorScratch.end());
+			m_sensorScratch.erase(std::unique(m_sensorScratch.begin(), m_sensorScratch.end()), m_sensorScratch.end());
+		}
+
+		//merge walk of two sorted sets, only differences become events
+		auto previous = sensor.m_overlaps.begin();
+		auto current = m_sensorScratch.begin();
+		while (previous != sensor.m_overlaps.end() || current != m_sensorScratch.end())
+		{
+			if (current == m_sensorScratch.end() || (previous != sensor.m_overlaps.end() && *previous < *current))
+			{
+				m_sensorExitList.emplace_back(sensor.m_id, *previous++);
+			}
+			else if (previous == sensor.m_overlaps.end() || *current < *previous)
+			{
+				m_sensorEnterList.emplace_back(sensor.m_id, *current++);
+			}
+			else
+			{
+				++previous; ++current;
+			}
+		}
+		sensor.m_overlaps.swap(m_sensorScratch);
+
+		if (!pComp) { RemoveSensorAt(i); }
+	}
+}
 
 //================================================================================
-//						Delayed functioncall adder for Physics
+//						End of Contact Listener functions
 //================================================================================
 
 //================================================================================
-//							Contact Listener functions
+//						Force field volumes
 //================================================================================
 
-#define PHYSICS_CONTACT_SCENE_RELOAD_GUARD								\
-if (WP_PhysicsSystem::GetInstance()->m_isPhysicsReloaded) { return; }	\
+namespace
+{
+	//trees holding any of the affected layers, statics and sensors are never pushed
+	class WP_ForceFieldBroadPhaseFilter final : public JPH::BroadPhaseLayerFilter
+	{
+	public:
+		WP_ForceFieldBroadPhaseFilter(WP_PhysicsLayerMatrix const& _matrix, uint32_t _layerMask)
+		{
+			using WP_LayerTree = WP_PhysicsLayerMatrix::WP_LayerTree;
+			for (uint32_t layer{}; layer < _matrix.GetNumLayers(); ++layer)
+			{
+				if (!((_layerMask >> layer) & 1u)) { continue; }
+				m_treeMask |= 1u << _matrix.GetBroadPhaseLayer(static_cast<JPH::ObjectLayer>(layer)).GetValue();
+			}
+			m_treeMask &= ~((1u << static_cast<uint32_t>(WP_LayerTree::NON_MOVING)) | (1u << static_cast<uint32_t>(WP_LayerTree::SENSOR)));
+		}
+		virtual bool			ShouldCollide(JPH::BroadPhaseLayer _inLayer) const override
+		{
+			return (m_treeMask >> _inLayer.GetValue()) & 1u;
+		}
+	private:
+		uint32_t				m_treeMask = 0;
+	};
 
-using WP_CL = WP_PhysicsSystem::WP_ContactListener;
+	class WP_ForceFieldObjectLayerFilter final : public JPH::ObjectLayerFilter
+	{
+	public:
+		explicit WP_ForceFieldObjectLayerFilter(uint32_t _layerMask) : m_layerMask{ _layerMask } {/*Empty by Design*/ }
+		virtual bool			ShouldCollide(JPH::ObjectLayer _inLayer) const override
+		{
+			return _inLayer < WP_PhysicsLayerMatrix::c_MaxLayers && ((m_layerMask >> _inLayer) & 1u);
+		}
+	private:
+		uint32_t				m_layerMask;
+	};
+}
 
-JPH::ValidateResult	WP_CL::OnContactValidate(const JPH::Body& inBody1, const JPH::Body& inBody2,
-	JPH::RVec3Arg inBaseOffset, const JPH::CollideShapeResult& inCollisionResult)
+WP_PhysicsSystem::WP_ForceFieldID WP_PhysicsSystem::AddForceField(WP_ForceFieldSettings const& _settings)
 {
-	// Allows you to ignore a contact before it is created (using layers to not make objects collide is cheaper!)
-	return JPH::ValidateResult::AcceptAllContactsForThisBodyPair;
+	WP_ForceFieldID const id = m_nextForceField++;
+	m_forceFields.push_back(WP_ForceField{ id, _settings });
+	return id;
 }
 
-void			WP_CL::OnContactAdded(const JPH::Body& inBody1, const JPH::Body& inBody2,
-	const JPH::ContactManifold& inManifold, JPH::ContactSettings& ioSettings)
+void WP_PhysicsSystem::SetForceField(WP_ForceFieldID _field, WP_ForceFieldSettings const& _settings)
 {
-	PHYSICS_CONTACT_SCENE_RELOAD_GUARD
-	auto physics = WP_PhysicsSystem::GetInstance();
-	m_ContactAddedList.emplace_back(
-		physics->GetIDfromBodyID(inBody1.GetID().GetIndex()),
-		physics->GetIDfromBodyID(inBody2.GetID().GetIndex()));
+	auto iter = std::find_if(m_forceFields.begin(), m_forceFields.end(), [_field](WP_ForceField const& _ref) { return _ref.m_id == _field; });
+	if (iter == m_forceFields.end())
+	{
+		WP_WARN("Force field %u not found. WP_PhysicsSystem::SetForceField()", _field);
+		return;
+	}
+	iter->m_settings = _settings;
+}
 
-	//notify event
-	WP_ContactPayload payload{
-		physics->GetIDfromBodyID(inBody1.GetID().GetIndex()),
-		physics->GetIDfromBodyID(inBody2.GetID().GetIndex()),
-		inManifold, ioSettings };
+WP_PhysicsSystem::WP_ForceFieldSettings const* WP_PhysicsSystem::GetForceField(WP_ForceFieldID _field) const
+{
+	auto iter = std::find_if(m_forceFields.begin(), m_forceFields.end(), [_field](WP_ForceField const& _ref) { return _ref.m_id == _field; });
+	return (iter != m_forceFields.end()) ? &iter->m_settings : nullptr;
+}
 
-	WP_EventSystem::GetInstance()->Notify(EventType::kPhysicsContactTrigger, &payload);
+void WP_PhysicsSystem::RemoveForceField(WP_ForceFieldID _field)
+{
+	auto iter = std::find_if(m_forceFields.begin(), m_forceFields.end(), [_field](WP_ForceField const& _ref) { return _ref.m_id == _field; });
+	if (iter == m_forceFields.end()) { return; }
+	*iter = m_forceFields.back();	//swap and pop, order does not matter
+	m_forceFields.pop_back();
 }
 
-void			WP_CL::OnContactPersisted(const JPH::Body& inBody1, const JPH::Body& inBody2,
-	const JPH::ContactManifold& inManifold, JPH::ContactSettings& ioSettings)
+void WP_PhysicsSystem::ClearForceFields()
 {
-	PHYSICS_CONTACT_SCENE_RELOAD_GUARD
-	auto physics = WP_PhysicsSystem::GetInstance();
-	m_ContactPersistList.emplace_back(
-		physics->GetIDfromBodyID(inBody1.GetID().GetIndex()),
-		physics->GetIDfromBodyID(inBody2.GetID().GetIndex()));
+	m_forceFields.clear();
+}
 
-	//notify event
-	WP_ContactPayload payload{
-		physics->GetIDfromBodyID(inBody1.GetID().GetIndex()),
-		physics->GetIDfromBodyID(inBody2.GetID().GetIndex()),
-		inManifold, ioSettings };
+void WP_PhysicsSystem::WP_ForceFieldStepListener::OnStep(const JPH::PhysicsStepListenerContext& inContext)
+{	//one listener call per step, Update returns before m_forceFieldMilliseconds is read
+	if (m_system.m_forceFields.empty()) { return; }
+	WP_TimerSystem::clock::time_point const start = WP_TimerSystem::clock::now();
+	m_system.ApplyForceFields(inContext.mDeltaTime);
+	m_system.m_forceFieldMilliseconds += std::chrono::duration<float, std::milli>(WP_TimerSystem::clock::now() - start).count();
+}
 
-	WP_EventSystem::GetInstance()->Notify(EventType::kPhysicsContactPersist, &payload);
+void WP_PhysicsSystem::ApplyForceFields(float _deltaTime)
+{
+	using namespace WP_Physics;
+	//from the step listener, jolt has not started on the bodies of this step yet
+	JPH::BroadPhaseQuery const& broadPhase = m_physics_system.GetBroadPhaseQuery();
+	JPH::AllHitCollisionCollector<JPH::CollideShapeBodyCollector> collector;
+	m_forceFieldEntries.clear();
+	m_forceFieldBatches.clear();
+	for (uint32_t field{}; field < m_forceFields.size(); ++field)
+	{
+		WP_ForceFieldSettings const& settings = m_forceFields[field].m_settings;
+		collector.Reset();
+		broadPhase.CollideAABox(JPH::AABox{ ToJoltVec3(settings.m_center - settings.m_halfExtent), ToJoltVec3(settings.m_center + settings.m_halfExtent) },
+			collector, WP_ForceFieldBroadPhaseFilter{ m_layerMatrix, settings.m_layerMask }, WP_ForceFieldObjectLayerFilter{ settings.m_layerMask });
+		for (JPH::BodyID const& hit : collector.mHits) { m_forceFieldEntries.push_back(WP_ForceFieldEntry{ hit, field }); }
+	}
+	if (m_forceFieldEntries.empty()) { return; }
+
+	//group the volumes of a body, broadphase hit order is not stable between runs
+	std::sort(m_forceFieldEntries.begin(), m_forceFieldEntries.end(), [](WP_ForceFieldEntry const& _lhs, WP_ForceFieldEntry const& _rhs)
+		{
+			return (_lhs.m_bID != _rhs.m_bID) ? _lhs.m_bID.GetIndex() < _rhs.m_bID.GetIndex() : _lhs.m_field < _rhs.m_field;
+		});
+	uint32_t const numEntries = static_cast<uint32_t>(m_forceFieldEntries.size());
+	for (uint32_t begin{}; begin < numEntries;)
+	{
+		uint32_t end = std::min<uint32_t>(begin + WP_PHYSICS_FORCE_FIELD_BATCH_SIZE, numEntries);
+		while (end < numEntries && m_forceFieldEntries[end].m_bID == m_forceFieldEntries[end - 1].m_bID) { ++end; }
+		m_forceFieldBatches.push_back(WP_ForceFieldBatch{ begin, end });
+		begin = end;
+	}
+
+	if (m_forceFieldBatches.size() == 1)
+	{	//not worth a job
+		ApplyForceFieldBatch(m_forceFieldBatches.front(), _deltaTime);
+		return;
+	}
+	WP_JobSystem* const jobSystem = WP_JobSystem::GetInstance();
+	WP_JobSystem::WP_JobCounter counter;
+	for (WP_ForceFieldBatch const& batch : m_forceFieldBatches)
+	{
+		jobSystem->Schedule([this, &batch, _deltaTime]() { ApplyForceFieldBatch(batch, _deltaTime); },
+			WP_JobSystem::WP_JobPriority::HIGH, &counter);
+	}
+	jobSystem->Wait(counter);
 }
 
-void			WP_CL::OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair)
+void WP_PhysicsSystem::ApplyForceFieldBatch(WP_ForceFieldBatch const& _batch, float _deltaTime)
 {
-	PHYSICS_CONTACT_SCENE_RELOAD_GUARD
-	auto physics = WP_PhysicsSystem::GetInstance();
-	m_ContactRemovedList.emplace_back(
-		physics->GetIDfromBodyID(inSubShapePair.GetBody1ID().GetIndex()),
-		physics->GetIDfromBodyID(inSubShapePair.GetBody2ID().GetIndex()));
+	using namespace WP_Physics;
+	JPH::Vec3 const gravity = m_physics_system.GetGravity();
+	//no body is in two batches and the step has not reached the bodies, so they are written without their mutexes
+	JPH::BodyLockInterfaceNoLock const& lockInterface = m_physics_system.GetBodyLockInterfaceNoLock();
+	for (uint32_t entry = _batch.m_begin; entry < _batch.m_end; ++entry)
+	{
+		JPH::Body* body = lockInterface.TryGetBody(m_forceFieldEntries[entry].m_bID);
+		if (!body || !body->IsDynamic() || !body->IsActive()) { continue; }
+		WP_ForceFieldSettings const& settings = m_forceFields[m_forceFieldEntries[entry].m_field].m_settings;
+		JPH::Vec3 const velocity = ToJoltVec3(settings.m_velocity);
+		switch (settings.m_type)
+		{
+		case WP_ForceFieldType::WATER:
+		{	//surface is the top face of the volume
+			JPH::RVec3 const surface = ToJoltVec3(settings.m_center + glm::vec3(0.f, settings.m_halfExtent.y, 0.f));
+			body->ApplyBuoyancyImpulse(surface, JPH::Vec3::sAxisY(), settings.m_buoyancy, settings.m_linearDrag,
+				settings.m_angularDrag, velocity, gravity, _deltaTime);
+			break;
+		}
+		case WP_ForceFieldType::WIND:
+		{
+			float const blend = std::min(1.f, settings.m_linearDrag * _deltaTime);
+			JPH::Vec3 const current = body->GetLinearVelocity();
+			body->SetLinearVelocityClamped(current + (velocity - current) * blend);
+			break;
+		}
+		case WP_ForceFieldType::RADIAL_GRAVITY:
+		{
+			JPH::Vec3 acceleration = JPH::Vec3::sZero();
+			JPH::Vec3 const toCenter = JPH::Vec3(ToJoltVec3(settings.m_center) - body->GetCenterOfMassPosition());
+			float const distance = toCenter.Length();
+			if (distance > 1.0e-4f) { acceleration = toCenter * (settings.m_strength / distance); }
+			if (settings.m_isReplacingGravity) { acceleration -= gravity * body->GetMotionProperties()->GetGravityFactor(); }
+			body->SetLinearVelocityClamped(body->GetLinearVelocity() + acceleration * _deltaTime);
+			break;
+		}
+		case WP_ForceFieldType::DRAG:
+			body->SetLinearVelocityClamped(body->GetLinearVelocity() * std::max(0.f, 1.f - settings.m_linearDrag * _deltaTime));
+			body->SetAngularVelocityClamped(body->GetAngularVelocity() * std::max(0.f, 1.f - settings.m_angularDrag * _deltaTime));
+			break;
+		default:
+			break;
+		}
+	}
+}
 
-	//notify event
-	WP_ContactClearPayload payload{
-		physics->GetIDfromBodyID(inSubShapePair.GetBody1ID().GetIndex()),
-		physics->GetIDfromBodyID(inSubShapePair.GetBody2ID().GetIndex()) };
+//================================================================================
+//						Body pool
+//================================================================================
 
-	WP_EventSystem::GetInstance()->Notify(EventType::kPhysicsContactExit, &payload);
+size_t WP_PhysicsSystem::WP_BodyPoolKeyHash::operator()(WP_BodyPoolKey const& _key) const
+{
+	using WP_Physics::HashCombine;
+	size_t hash = std::hash<JPH::Shape const*>{}(_key.m_innerShape);
+	HashCombine(hash, static_cast<size_t>(_key.m_subType));
+	for (int axis{}; axis < 3; ++axis)
+	{
+		HashCombine(hash, std::hash<int>{}(_key.m_boundsMin[axis]));
+		HashCombine(hash, std::hash<int>{}(_key.m_boundsMax[axis]));
+	}
+	HashCombine(hash, static_cast<size_t>(_key.m_layer));
+	HashCombine(hash, static_cast<size_t>(_key.m_motionType));
+	return hash;
 }
 
-void			WP_CL::CallbackAllContacts()
-{//TODO: fix dangling reference
-	PHYSICS_CONTACT_SCENE_RELOAD_GUARD
-	EventType currentType = EventType::kPhysicsContactTriggerDelayed;
-	auto notify = [&currentType](auto& _payload)
+WP_PhysicsSystem::WP_BodyPoolKey WP_PhysicsSystem::MakeBodyPoolKey(JPH::Shape const* _shape, JPH::ObjectLayer _layer, JPH::EMotionType _motionType)
+{
+	WP_BodyPoolKey key{};
+	key.m_subType = _shape->GetSubType();
+	if (_shape->GetType() == JPH::EShapeType::Decorated)
+	{	//scaled cooked meshes, the cooked shape is shared so its address tells assets apart
+		key.m_innerShape = static_cast<JPH::DecoratedShape const*>(_shape)->GetInnerShape();
+	}
+	else if (_shape->GetType() != JPH::EShapeType::Convex)
+	{	//meshes and compounds can match in bounds only
+		key.m_innerShape = _shape;
+	}
+	//primitives of one sub type are the same shape when their bounds match
+	JPH::AABox const bounds = _shape->GetLocalBounds();
+	key.m_boundsMin = glm::ivec3(glm::round(WP_Physics::ToGLMVec3(bounds.mMin) * 1000.f));
+	key.m_boundsMax = glm::ivec3(glm::round(WP_Physics::ToGLMVec3(bounds.mMax) * 1000.f));
+	key.m_layer = _layer;
+	key.m_motionType = _motionType;
+	return key;
+}
+
+JPH::BodyID WP_PhysicsSystem::AcquirePooledBody(JPH::BodyCreationSettings const& _settings)
+{
+	if (!GetIsPooledLayer(_settings.mObjectLayer) || _settings.mIsSensor) { return JPH::BodyID{}; }
+	++m_bodyPoolStats.m_numAcquires;
+	auto iter = m_bodyPool.find(MakeBodyPoolKey(_settings.GetShape(), _settings.mObjectLayer, _settings.mMotionType));
+	if (iter == m_bodyPool.end() || iter->second.empty()) { return JPH::BodyID{}; }
+	++m_bodyPoolStats.m_numHits;
+	--m_bodyPoolStats.m_numParked;
+	JPH::BodyID const bID = iter->second.back();
+	iter->second.pop_back();
+
+	JPH::BodyInterface& bodyInterface = GetPhysicsBI();
+	{	//the parked body is outside the broadphase, nothing else is touching it
+		JPH::BodyLockWrite lock{ m_physics_system.GetBodyLockInterface(), bID };
+		assert(lock.Succeeded());
+		JPH::Body& body = lock.GetBody();
+		body.SetFriction(_settings.mFriction);
+		body.SetRestitution(_settings.mRestitution);
+		if (!body.IsStatic())
 		{
-			WP_EventSystem::GetInstance()->Notify(currentType, &_payload);
-#ifdef DEBUG_PHYS_CONTACT
-			switch (currentType)
-			{
-			case EventType::kTest:
-				break;
-			case EventType::kEditorPressPlay:
-				break;
-			case EventType::kEditorPressStop:
-				break;
-			case EventType::kAddComponent:
-				break;
-			case EventType::kDeleteComponent:
-				break;
-			case EventType::kReloadComponent:
-				break;
-			case EventType::kPhysicsBodyActivate:
-				break;
-			case EventType::kPhysicsBodyDeactivate:
-				break;
-			case EventType::kPhysicsContactTrigger:
-				WP_INFO("ContactTrigger");
-				break;
-			case EventType::kPhysicsContactPersist:
-				WP_INFO("ContactPersist");
-				break;
-			case EventType::kPhysicsContactExit:
-				WP_INFO("ContactExit");
-				break;
-			case EventType::kPhysicsContactTriggerDelayed:
-				WP_INFO("ContactTriggerDelayed");
-				break;
-			case EventType::kPhysicsContactPersistDelayed:
-				WP_INFO("ContactPersistDelayed");
-				break;
-			case EventType::kPhysicsContactExitDelayed:
-				WP_INFO("ContactExitDelayed");
-				break;
-			default:
-				break;
-			}
-#endif // _DEBUG
-		};	//end of lambda
+			JPH::MotionProperties* const motion = body.GetMotionProperties();
+			motion->SetMassProperties(_settings.mAllowedDOFs, _settings.GetMassProperties());
+			motion->SetGravityFactor(_settings.mGravityFactor);
+			motion->SetLinearVelocity(JPH::Vec3::sZero());
+			motion->SetAngularVelocity(JPH::Vec3::sZero());
+		}
+	}
+	bodyInterface.SetMotionQuality(bID, _settings.mMotionQuality);
+	bodyInterface.SetPositionAndRotation(bID, _settings.mPosition, _settings.mRotation, JPH::EActivation::DontActivate);
+	bodyInterface.AddBody(bID, JPH::EActivation::Activate);
+	//same id as the previous owner, readers must not see its published state or cached rays
+	MarkSnapshotDirty(bID);
+	if (m_isRayCacheEnabled) { InvalidateRayCache(); }
+	return bID;
+}
+
+uint32_t WP_PhysicsSystem::GetBodyPoolRoom() const
+{
+	uint32_t const maxParked = static_cast<uint32_t>(cMaxBodies * WP_PHYSICS_BODY_POOL_MAX_RATIO);
+	return (m_bodyPoolStats.m_numParked < maxParked) ? maxParked - m_bodyPoolStats.m_numParked : 0;
+}
 
-	std::for_each(m_ContactAddedList.begin(), m_ContactAddedList.end(), notify);		//notify contact start
-	currentType = EventType::kPhysicsContactPersistDelayed;
-	std::for_each(m_ContactPersistList.begin(), m_ContactPersistList.end(), notify);	//notify contact persist
-	currentType = EventType::kPhysicsContactExitDelayed;
-	std::for_each(m_ContactRemovedList.begin(), m_ContactRemovedList.end(), notify);	//notify contact end
+bool WP_PhysicsSystem::ReleasePooledBody(JPH::BodyID _bID)
+{
+	JPH::BodyInterface& bodyInterface = GetPhysicsBI();
+	JPH::ObjectLayer const layer = bodyInterface.GetObjectLayer(_bID);
+	if (!GetIsPooledLayer(layer) || bodyInterface.IsAdded(_bID)) { return false; }
 
-	//run all delayed calls to physics set functions
-	for (auto& delayedPhysicsObject : WP_PhysicsSystem::GetInstance()->m_DelayedPhysicsList)
+	//a demoted body goes back to its full lod, the next owner starts from scratch
+	if (auto iter = m_bodyLODs.find(_bID.GetIndex()); iter != m_bodyLODs.end())
 	{
-		(*delayedPhysicsObject)();	//operator call for each delayed physics object
+		if (iter->second.m_bID == _bID)
+		{
+			if (iter->second.m_lod == WP_PhysicsLOD::PROXY) { SetSolverSteps(m_physics_system, _bID, iter->second.m_fullVelocitySteps, iter->second.m_fullPositionSteps); }
+			bodyInterface.SetMotionQuality(_bID, iter->second.m_fullQuality);
+		}
+		m_bodyLODs.erase(iter);
+	}
+
+	WP_BodyPoolKey key;
+	{
+		JPH::BodyLockRead lock{ m_physics_system.GetBodyLockInterface(), _bID };
+		if (!lock.Succeeded() || lock.GetBody().IsSensor()) { return false; }
+		key = MakeBodyPoolKey(lock.GetBody().GetShape(), layer, lock.GetBody().GetMotionType());
+	}
+	std::vector<JPH::BodyID>& parked = m_bodyPool[key];
+	if (parked.size() >= WP_PHYSICS_BODY_POOL_MAX_PER_KEY || GetBodyPoolRoom() == 0)
+	{
+		++m_bodyPoolStats.m_numOverflows;
+		return false;
 	}
+	parked.push_back(_bID);
+	++m_bodyPoolStats.m_numReleases;
+	++m_bodyPoolStats.m_numParked;
+	if (m_isRayCacheEnabled) { InvalidateRayCache(); }	//cached hits may name the parked body
+	return true;
 }
 
-void				WP_CL::ClearContacts()
+void WP_PhysicsSystem::PrewarmBodyPool(WP_GameObjectID _prototype, uint32_t _count)
 {
-	m_ContactAddedList.clear(); m_ContactPersistList.clear(); m_ContactRemovedList.clear();
-	WP_PhysicsSystem::GetInstance()->m_DelayedPhysicsList.clear();	//remove all delayed calls to physics set functions
+	OBTAIN_PHYSIC_COMPONENT(_prototype)
+		if (pComp->m_isNPC) { return; }
+		JPH::ShapeSettings::ShapeResult const shape = pComp->CreateShape();
+		if (!shape.IsValid())
+		{
+			WP_WARN("Invalid shape on gameobject %u. WP_PhysicsSystem::PrewarmBodyPool()", _prototype);
+			return;
+		}
+		PrewarmBodyPool(pComp->CreateBodySettings(shape), _count);
 }
 
-//================================================================================
-//						End of Contact Listener functions
-//================================================================================
\ No newline at end of file
+void WP_PhysicsSystem::PrewarmBodyPool(JPH::BodyCreationSettings const& _settings, uint32_t _count)
+{
+	if (!GetIsPooledLayer(_settings.mObjectLayer) || _settings.mIsSensor) { return; }
+	std::vector<JPH::BodyID>& parked = m_bodyPool[MakeBodyPoolKey(_settings.GetShape(), _settings.mObjectLayer, _settings.mMotionType)];
+	_count = std::min<uint32_t>(_count, WP_PHYSICS_BODY_POOL_MAX_PER_KEY - static_cast<uint32_t>(std::min<size_t>(parked.size(), WP_PHYSICS_BODY_POOL_MAX_PER_KEY)));
+	_count = std::min(_count, GetBodyPoolRoom());
+	JPH::BodyInterface& bodyInterface = GetPhysicsBI();
+	for (uint32_t i{}; i < _count; ++i)
+	{	//created but never added, kept out of the broadphase
+		JPH::Body* const body = bodyInterface.CreateBody(_settings);
+		if (!body)
+		{
+			WP_WARN("Out of bodies after %u of %u. WP_PhysicsSystem::PrewarmBodyPool()", i, _count);
+			break;
+		}
+		parked.push_back(body->GetID());
+		++m_bodyPoolStats.m_numParked;
+	}
+}
+
+void WP_PhysicsSystem::ClearBodyPool()
+{
+	JPH::BodyInterface& bodyInterface = GetPhysicsBI();
+	for (auto& [key, parked] : m_bodyPool)
+	{
+		if (!parked.empty()) { bodyInterface.DestroyBodies(parked.data(), static_cast<int>(parked.size())); }
+	}
+	m_bodyPool.clear();
+	m_bodyPoolStats.m_numParked = 0;
+}
+
+void WP_PhysicsSystem::ResetBodyPoolStats()
+{
+	uint32_t const numParked = m_bodyPoolStats.m_numParked;
+	m_bodyPoolStats = WP_BodyPoolStats{};
+	m_bodyPoolStats.m_numParked = numParked;
+}
@@ -1,6 +1,16 @@
 #pragma once
 #include <WP_EngineSystem/WP_EngineSystem.h>
 #include <WP_CoreComponents/WP_Physics.h>
+#include <WP_CoreComponents/WP_Transform3D.h>
+#include <WP_EngineSystem/WP_PhysicsFlightRecorder.h>
+#include <WP_EngineSystem/WP_PhysicsLayerMatrix.h>
+#include <WP_EngineSystem/WP_PhysicsMeshCooker.h>
+#include <WP_EngineSystem/WP_PhysicsPairFilter.h>
+#include <WP_EngineSystem/WP_PhysicsPrediction.h>
+#include <WP_EngineSystem/WP_PhysicsProjectiles.h>
+#include <WP_EngineSystem/WP_PhysicsStateCodec.h>
+#include <WP_EngineSystem/WP_PhysicsTempAllocator.h>
+#include <WP_EngineSystem/WP_JobSystem.h>
 #include <Jolt/Jolt.h>
 
 // Jolt includes
@@ -11,9 +21,11 @@
 #include <Jolt/Core/JobSystemSingleThreaded.h>			//single job system
 #include <Jolt/Physics/PhysicsSettings.h>
 #include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/PhysicsStepListener.h>
 #include <Jolt/Physics/Collision/Shape/Shape.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
 #include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/Collision/Shape/StaticCompoundShape.h>
 #include <Jolt/Physics/Body/BodyCreationSettings.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
 #include <Jolt/Physics/Collision/RayCast.h>
@@ -21,8 +33,16 @@
 #include <Jolt/Physics/Collision/CastResult.h>
 #include <Jolt/Physics/Collision/CollisionCollector.h>
 #include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
+#include <Jolt/Physics/Collision/GroupFilter.h>
 #include <Jolt/Physics/StateRecorderImpl.h>
+#include <array>
+#include <atomic>
+#include <deque>
 #include <map>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <unordered_map>
 
 //would be ideal to move each class to different files
 //DebugRenderer for debug integration??
@@ -38,6 +58,159 @@
 #define MAX_PHYSICS_UPDATES_PER_FRAME 2
 #endif
 
+//collision layer matrix loaded on startup, default layers are used if missing
+#ifndef WP_PHYSICS_LAYER_CONFIG_PATH
+#define WP_PHYSICS_LAYER_CONFIG_PATH "Assets/Config/PhysicsLayers.cfg"
+#endif
+
+//contact records are split over this many independently locked stripes by body pair
+#ifndef WP_PHYSICS_CONTACT_STRIPES
+#define WP_PHYSICS_CONTACT_STRIPES 16
+#endif
+
+//rays whose origin and direction fall in the same cell of this size share a cached result
+#ifndef WP_PHYSICS_RAY_CACHE_QUANTUM
+#define WP_PHYSICS_RAY_CACHE_QUANTUM 0.01f
+#endif
+
+//pure static colliders are merged into one compound body per cell of this size on engine run
+#ifndef WP_PHYSICS_STATIC_BAKE_CELL_SIZE
+#define WP_PHYSICS_STATIC_BAKE_CELL_SIZE 32.0f
+#endif
+
+//cells with fewer colliders than this keep separate bodies
+#ifndef WP_PHYSICS_STATIC_BAKE_MIN_COLLIDERS
+#define WP_PHYSICS_STATIC_BAKE_MIN_COLLIDERS 4
+#endif
+
+//with world streaming enabled, pure static colliders are grouped into cells of this size
+#ifndef WP_PHYSICS_STREAMING_CELL_SIZE
+#define WP_PHYSICS_STREAMING_CELL_SIZE 64.0f
+#endif
+
+//cells closer to the physics focus than the load radius are streamed in,
+//loaded cells further than the unload radius are streamed out
+#ifndef WP_PHYSICS_STREAMING_LOAD_RADIUS
+#define WP_PHYSICS_STREAMING_LOAD_RADIUS 128.0f
+#endif
+
+#ifndef WP_PHYSICS_STREAMING_UNLOAD_RADIUS
+#define WP_PHYSICS_STREAMING_UNLOAD_RADIUS 160.0f
+#endif
+
+//physics LOD is evaluated once every this many updates
+#ifndef WP_PHYSICS_LOD_INTERVAL
+#define WP_PHYSICS_LOD_INTERVAL 10
+#endif
+
+//dynamic bodies further from the physics focus than these distances drop to discrete motion quality,
+//become proxies solved with fewer steps and are forced to sleep, in that order
+#ifndef WP_PHYSICS_LOD_DISCRETE_DISTANCE
+#define WP_PHYSICS_LOD_DISCRETE_DISTANCE 40.0f
+#endif
+
+#ifndef WP_PHYSICS_LOD_PROXY_DISTANCE
+#define WP_PHYSICS_LOD_PROXY_DISTANCE 80.0f
+#endif
+
+#ifndef WP_PHYSICS_LOD_SLEEP_DISTANCE
+#define WP_PHYSICS_LOD_SLEEP_DISTANCE 140.0f
+#endif
+
+//fraction a body must come closer than a boundary before it moves back up a level
+#ifndef WP_PHYSICS_LOD_HYSTERESIS
+#define WP_PHYSICS_LOD_HYSTERESIS 0.1f
+#endif
+
+//solver steps of a proxy. jolt solves an island with the most steps any of its bodies asks for,
+//so a proxy touching a full lod body is still solved fully
+#ifndef WP_PHYSICS_LOD_PROXY_VELOCITY_STEPS
+#define WP_PHYSICS_LOD_PROXY_VELOCITY_STEPS 2
+#endif
+
+#ifndef WP_PHYSICS_LOD_PROXY_POSITION_STEPS
+#define WP_PHYSICS_LOD_PROXY_POSITION_STEPS 1
+#endif
+
+//initial temp allocator arena, and the most an adaptive arena may grow to
+#ifndef WP_PHYSICS_TEMP_ALLOCATOR_SIZE
+#define WP_PHYSICS_TEMP_ALLOCATOR_SIZE (10 * 1024 * 1024)
+#endif
+
+#ifndef WP_PHYSICS_TEMP_ALLOCATOR_MAX_SIZE
+#define WP_PHYSICS_TEMP_ALLOCATOR_MAX_SIZE (160 * 1024 * 1024)
+#endif
+
+//an adaptive arena doubles between frames once an update used this fraction of it
+#ifndef WP_PHYSICS_TEMP_ALLOCATOR_GROW_RATIO
+#define WP_PHYSICS_TEMP_ALLOCATOR_GROW_RATIO 0.75f
+#endif
+
+//default fraction of a physics limit that triggers a telemetry warning
+#ifndef WP_PHYSICS_TELEMETRY_WARNING_RATIO
+#define WP_PHYSICS_TELEMETRY_WARNING_RATIO 0.9f
+#endif
+
+//body and volume pairs inside force field volumes are split into jobs of about this many, a body is never split
+#ifndef WP_PHYSICS_FORCE_FIELD_BATCH_SIZE
+#define WP_PHYSICS_FORCE_FIELD_BATCH_SIZE 64
+#endif
+
+//radius and nearest queries run as one engine job per this many queries in the batched forms
+#ifndef WP_PHYSICS_QUERY_BATCH_SIZE
+#define WP_PHYSICS_QUERY_BATCH_SIZE 32
+#endif
+
+//parked bodies created per shape and layer when a scene loads, on top of the bodies in use
+#ifndef WP_PHYSICS_BODY_POOL_PREWARM
+#define WP_PHYSICS_BODY_POOL_PREWARM 16
+#endif
+
+//released bodies past this many parked per shape and layer are destroyed
+#ifndef WP_PHYSICS_BODY_POOL_MAX_PER_KEY
+#define WP_PHYSICS_BODY_POOL_MAX_PER_KEY 256
+#endif
+
+//parked bodies count against the body limit, at most this share of it is parked over all keys
+#ifndef WP_PHYSICS_BODY_POOL_MAX_RATIO
+#define WP_PHYSICS_BODY_POOL_MAX_RATIO 0.25f
+#endif
+
+//default frame or physics update time in milliseconds that dumps the flight recorder, 0 = no hitch dumps.
+//development builds only, shipped builds do not write dumps unless a threshold is set
+#ifndef WP_PHYSICS_FLIGHT_RECORDER_HITCH_MS
+#ifdef _DEBUG
+#define WP_PHYSICS_FLIGHT_RECORDER_HITCH_MS 50.0f
+#else
+#define WP_PHYSICS_FLIGHT_RECORDER_HITCH_MS 0.0f
+#endif
+#endif
+
+//hitch dumps kept on disk, the oldest is overwritten after this many
+#ifndef WP_PHYSICS_FLIGHT_RECORDER_MAX_HITCH_DUMPS
+#define WP_PHYSICS_FLIGHT_RECORDER_MAX_HITCH_DUMPS 8
+#endif
+
+//where flight recorder dumps are written
+#ifndef WP_PHYSICS_FLIGHT_RECORDER_DIRECTORY
+#define WP_PHYSICS_FLIGHT_RECORDER_DIRECTORY "Logs/Physics"
+#endif
+
+//transform scale reaches the body shape in steps of this size, smaller changes are ignored
+#ifndef WP_PHYSICS_SCALE_QUANTUM
+#define WP_PHYSICS_SCALE_QUANTUM 0.001f
+#endif
+
+//updates a rescaled dynamic body has to keep its scale before its mass and inertia follow the shape
+#ifndef WP_PHYSICS_SCALE_MASS_SETTLE_FRAMES
+#define WP_PHYSICS_SCALE_MASS_SETTLE_FRAMES 10
+#endif
+
+//scaled shapes kept past this many drop the ones no body uses any more
+#ifndef WP_PHYSICS_SCALED_SHAPE_CACHE_SIZE
+#define WP_PHYSICS_SCALED_SHAPE_CACHE_SIZE 1024
+#endif
+
 
 //class pre-declarations
 class WP_PhysicsSystem;
@@ -283,11 +456,26 @@ namespace WP_Physics
 		// If this value is negative, this is a speculative contact point and may not
 		// actually result in a velocity change as during solving the bodies may not actually collide.
 		float const					m_penetrationDepth;
-		JPH::ContactManifold const& m_manifold;
+		JPH::ContactManifold const& m_manifold;		//only valid inside the contact callback, use WP_ContactPoints after
 		glm::vec3 const				m_normal;
 		glm::vec3 const				m_baseOffset;
 
 	};
+
+	//copy of the contact points of a manifold, stays valid after the contact callback returns.
+	//stored in a per frame pool owned by the contact listener, valid until the next physics update.
+	struct WP_ContactPoints
+	{
+		static constexpr uint32_t	c_MaxPoints		= 4;
+		static constexpr uint32_t	c_InvalidIndex	= ~0u;
+
+		glm::vec3					m_pointsOn1[c_MaxPoints];	//world space contact points on body 1
+		glm::vec3					m_pointsOn2[c_MaxPoints];	//world space contact points on body 2
+		glm::vec3					m_normal;					//world space normal, pointing from body 1 to body 2
+		float						m_penetrationDepth;
+		uint32_t					m_numPoints;
+	};
+
 	class WP_ContactSettings
 	{
 	public:
@@ -344,6 +532,8 @@ namespace WP_Physics
 
 	JPH::Quat NormalizeJPHQuat(JPH::Quat const& _quat);	//prevent divide by zero error for all JPH quarternions when normalizing.
 	JPH::Quat InverseJPHQuat(JPH::Quat const& _quat);	//prevent divide by zero error for all JPH quarternions when inversing.
+
+	void HashCombine(size_t& _hash, size_t _value);		//mix _value into _hash, for the hash map keys of the physics system
 }
 
 // Layer that objects can be in, determines which other objects it can collide with
@@ -351,13 +541,14 @@ namespace WP_Physics
 // layers if you want. E.g. you could have a layer for high detail collision (which is not used by the physics simulation
 // but only if you do collision testing).
 // If functionallity to add object layers is wanted, please inform the guy who did physics :)
+// These are the default layers, WP_PHYSICS_LAYER_CONFIG_PATH can add more (up to 32) and change the masks.
 namespace Layers
 {
 	static constexpr JPH::ObjectLayer NON_MOVING = 0;		//static objects
 	static constexpr JPH::ObjectLayer MOVING = 1;			//non-static objects that have physics
 	static constexpr JPH::ObjectLayer SENSOR = 2;			//static isTrigger objects
 	static constexpr JPH::ObjectLayer DEBRIES = 3;			//non-static physics objects that dont collide with moving objects
-	static constexpr JPH::ObjectLayer BULLET = 4;			//pure kinematics without collision.
+	static constexpr JPH::ObjectLayer BULLET = 4;			//pure kinematics without collision. passive in the layer matrix, queries no tree
 	static constexpr JPH::ObjectLayer WEAPON = 5;			//?? Raycast layer?
 
 	static constexpr JPH::ObjectLayer NUM_LAYERS = 6;
@@ -372,54 +563,36 @@ namespace Layers
 
 namespace BroadPhaseLayers
 {
-	static constexpr JPH::BroadPhaseLayer NON_MOVING(0);	//static
-	static constexpr JPH::BroadPhaseLayer MOVING(1);		//dynamic
-	static constexpr JPH::BroadPhaseLayer DEBRIES(2);		//dynamic collsion outside of moving objects
-
-	static constexpr JPH::uint NUM_LAYERS(3);
+	using WP_LayerTree = WP_PhysicsLayerMatrix::WP_LayerTree;
+	static constexpr JPH::BroadPhaseLayer NON_MOVING(static_cast<JPH::BroadPhaseLayer::Type>(WP_LayerTree::NON_MOVING));	//static
+	static constexpr JPH::BroadPhaseLayer MOVING(static_cast<JPH::BroadPhaseLayer::Type>(WP_LayerTree::MOVING));			//dynamic
+	static constexpr JPH::BroadPhaseLayer DEBRIES(static_cast<JPH::BroadPhaseLayer::Type>(WP_LayerTree::DEBRIES));		//dynamic collsion outside of moving objects
+	static constexpr JPH::BroadPhaseLayer SENSOR(static_cast<JPH::BroadPhaseLayer::Type>(WP_LayerTree::SENSOR));			//triggers
+	static constexpr JPH::BroadPhaseLayer BULLET(static_cast<JPH::BroadPhaseLayer::Type>(WP_LayerTree::BULLET));			//fast kinematics
+
+	static constexpr JPH::uint NUM_LAYERS(WP_PhysicsLayerMatrix::GetNumBroadPhaseLayers());
 };
 
+//Filters below are lookups into the system's WP_PhysicsLayerMatrix, see WP_PhysicsLayerMatrix.h
 //Which ObjectLayers should check collision with the other ObjectLayers.
 class WP_ObjectLayerPairFilter : public JPH::ObjectLayerPairFilter
 {
 public:
+	explicit WP_ObjectLayerPairFilter(WP_PhysicsLayerMatrix const& _matrix) : m_matrix{ _matrix } {/*Empty by Design*/ }
+
 	virtual bool					ShouldCollide(JPH::ObjectLayer inObject1, JPH::ObjectLayer inObject2) const override
 	{
-		using namespace Layers;
-		assert((inObject1 < NUM_LAYERS) && (inObject2 < NUM_LAYERS));	//both are valid layers
-
-		switch (inObject1)
-		{	//find if layers collide
-		case NON_MOVING:
-			return (1 << inObject2) & s_nonMovingLayerMask;
-		case MOVING:
-			return (1 << inObject2) & s_movingLayerMask;
-		case DEBRIES:
-			return (1 << inObject2) & s_debriesLayerMask;
-		case SENSOR:
-			return (1 << inObject2) & s_sensorLayerMask;
-		case BULLET:
-			return (1 << inObject2) & s_bulletLayerMask;
-		case WEAPON:
-			return (1 << inObject2) & s_weaponLayerMask;
-		default:
-			JPH_ASSERT(false);
-			return false;
-		}
+		return m_matrix.ShouldCollide(inObject1, inObject2);
 	}
+private:
+	WP_PhysicsLayerMatrix const&	m_matrix;
 };
 
 //quick return broad phase layers
 class WP_BPLayerInterfaceImpl final : public JPH::BroadPhaseLayerInterface
 {
 public:
-	WP_BPLayerInterfaceImpl()
-	{
-		// Create a mapping table from object to broad phase layer
-		m_ObjectToBroadPhase[Layers::NON_MOVING] = BroadPhaseLayers::NON_MOVING;
-		m_ObjectToBroadPhase[Layers::MOVING] = BroadPhaseLayers::MOVING;
-		m_ObjectToBroadPhase[Layers::DEBRIES] = BroadPhaseLayers::DEBRIES;
-	}
+	explicit WP_BPLayerInterfaceImpl(WP_PhysicsLayerMatrix const& _matrix) : m_matrix{ _matrix } {/*Empty by Design*/ }
 
 	virtual JPH::uint					GetNumBroadPhaseLayers() const override
 	{
@@ -428,69 +601,76 @@ public:
 
 	virtual JPH::BroadPhaseLayer			GetBroadPhaseLayer(JPH::ObjectLayer inLayer) const override
 	{
-		JPH_ASSERT(inLayer < Layers::NUM_LAYERS);
-		return m_ObjectToBroadPhase[inLayer];
+		return m_matrix.GetBroadPhaseLayer(inLayer);
 	}
 
 #if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
 	virtual const char* GetBroadPhaseLayerName(JPH::BroadPhaseLayer inLayer) const override
 	{
-		switch ((JPH::BroadPhaseLayer::Type)inLayer)
-		{
-		case (JPH::BroadPhaseLayer::Type)BroadPhaseLayers::NON_MOVING:	return "NON_MOVING";
-		case (JPH::BroadPhaseLayer::Type)BroadPhaseLayers::MOVING:		return "MOVING";
-		case (JPH::BroadPhaseLayer::Type)BroadPhaseLayers::DEBRIES:		return "SENSOR";
-		default:													JPH_ASSERT(false); return "INVALID";
-		}
+		return WP_PhysicsLayerMatrix::GetTreeName(static_cast<BroadPhaseLayers::WP_LayerTree>(inLayer.GetValue()));
 	}
 #endif // JPH_EXTERNAL_PROFILE || JPH_PROFILE_ENABLED
 
 private:
-	JPH::BroadPhaseLayer					m_ObjectToBroadPhase[Layers::NUM_LAYERS];
+	WP_PhysicsLayerMatrix const&			m_matrix;
 };
 
 //which ObjectLayers should work on which BP_Layer?
 class WP_ObjectVsBroadPhaseLayerFilterImpl : public JPH::ObjectVsBroadPhaseLayerFilter
 {
 public:
+	explicit WP_ObjectVsBroadPhaseLayerFilterImpl(WP_PhysicsLayerMatrix const& _matrix) : m_matrix{ _matrix } {/*Empty by Design*/ }
+
 	virtual bool				ShouldCollide(JPH::ObjectLayer inLayer1, JPH::BroadPhaseLayer inLayer2) const override
 	{
-		assert(inLayer1<Layers::NUM_LAYERS);
-		assert(inLayer2.GetValue()<BroadPhaseLayers::NUM_LAYERS);
-		using namespace Layers;
-		switch (inLayer1)
-		{
-		case NON_MOVING:
-			return inLayer2 == BroadPhaseLayers::MOVING;	//switch with another selector for layer for more complicated layers
-		case MOVING:
-			return inLayer2 != BroadPhaseLayers::DEBRIES; // Moving collides with everything but raycast
-		case DEBRIES:
-			return inLayer2 != BroadPhaseLayers::MOVING; // raycasts collides with everything
-		case SENSOR:
-			return inLayer2 == BroadPhaseLayers::MOVING;
-		case BULLET:
-			return false;
-		case WEAPON:
-			return inLayer2 != BroadPhaseLayers::DEBRIES;
-		default:
-			JPH_ASSERT(false);
-			return false;
-		}
+		assert(inLayer2.GetValue() < BroadPhaseLayers::NUM_LAYERS);
+		return m_matrix.ShouldCollide(inLayer1, inLayer2);
 	}
+private:
+	WP_PhysicsLayerMatrix const&	m_matrix;
 };
 
 //use event system to broadcast
+//Activation callbacks are called from physics job threads (and from body add/remove on main thread).
+//Changes are only staged here, WP_PhysicsSystem drains them on the main thread after each update.
 class WP_BodyActivationListener : public JPH::BodyActivationListener
 {
 public:
-	virtual void		OnBodyActivated(const JPH::BodyID& inBodyID, JPH::uint64 inBodyUserData) override
+	struct WP_ActivationChange
+	{
+		JPH::BodyID		m_bodyID;
+		bool			m_isActivated;
+	};
+	using WP_ActivationChangeList = std::vector<WP_ActivationChange>;
+
+	virtual void		OnBodyActivated(const JPH::BodyID& inBodyID, [[maybe_unused]] JPH::uint64 inBodyUserData) override
+	{
+		std::lock_guard<std::mutex> lock{ m_stagingMutex };
+		m_stagedChanges.push_back({ inBodyID, true });
+	}
+
+	virtual void		OnBodyDeactivated(const JPH::BodyID& inBodyID, [[maybe_unused]] JPH::uint64 inBodyUserData) override
+	{
+		std::lock_guard<std::mutex> lock{ m_stagingMutex };
+		m_stagedChanges.push_back({ inBodyID, false });
+	}
+
+	//move all staged changes into _out (in order of arrival). _out is cleared first.
+	void				SwapStagedChanges(WP_ActivationChangeList& _out)
 	{
+		_out.clear();
+		std::lock_guard<std::mutex> lock{ m_stagingMutex };
+		_out.swap(m_stagedChanges);
 	}
 
-	virtual void		OnBodyDeactivated(const JPH::BodyID& inBodyID, JPH::uint64 inBodyUserData) override
+	void				ClearStagedChanges()
 	{
+		std::lock_guard<std::mutex> lock{ m_stagingMutex };
+		m_stagedChanges.clear();
 	}
 private:
+	std::mutex					m_stagingMutex;
+	WP_ActivationChangeList		m_stagedChanges;
 };			//call while collision active
 
 //================================================================================
@@ -513,8 +693,8 @@ public:
 	//							Contact Listener
 	//================================================================================
 
-	//on collision enter type callback
-	class WP_ContactListener : public JPH::ContactListener
+	//on collision enter type callback, also a step listener to stamp contacts with their collision step
+	class WP_ContactListener : public JPH::ContactListener, public JPH::PhysicsStepListener
 	{
 
 	public:
@@ -530,6 +710,12 @@ public:
 
 		virtual void			OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) override;
 
+		// See: PhysicsStepListener, called once at the start of every collision step
+		virtual void			OnStep(const JPH::PhysicsStepListenerContext& inContext) override;
+
+		//move the striped records into the contact lists, after the last physics update of the frame
+		void					GatherContacts();
+
 
 		//callback after all contact is identified this frame
 		void					CallbackAllContacts();
@@ -538,15 +724,34 @@ public:
 		//clear all contacts before next physics frame.
 		void					ClearContacts();
 
+		enum class WP_ContactType : uint8_t
+		{
+			ADDED,
+			PERSISTED,
+			REMOVED,
+			SENSOR_ENTER,		//tracked sensors only (SENSOR tree layers), m_gameObject1 is the sensor
+			SENSOR_EXIT,
+			NUM_CONTACT_TYPES
+		};
+
+		//one record per body pair per frame, merged across all collision steps of the frame
 		class WP_ContactPayloadDelayed final : public EventPayload
 		{
 		public:
-			WP_ContactPayloadDelayed(const WP_GameObjectID _gID1, const WP_GameObjectID _gID2)
-				: m_gameObject1{ _gID1 }, m_gameObject2{ _gID2 }
+			WP_ContactPayloadDelayed(const WP_GameObjectID _gID1, const WP_GameObjectID _gID2, uint32_t _step = 0)
+				: m_gameObject1{ _gID1 }, m_gameObject2{ _gID2 }, m_firstStep{ _step }, m_lastStep{ _step }
 			{/*Empty by Design*/}
 
 			const WP_GameObjectID m_gameObject1;
 			const WP_GameObjectID m_gameObject2;
+
+			uint32_t	m_firstStep			{ 0 };			//first collision step of the frame this pair was reported in
+			uint32_t	m_lastStep			{ 0 };			//last collision step of the frame this pair was reported in
+			uint32_t	m_numReports		{ 0 };			//number of contact callbacks merged into this record
+			float		m_impulseEstimate	{ 0.0f };		//summed estimate of normal impulse (effective mass * approach speed)
+			float		m_maxPenetration	{ 0.0f };		//deepest penetration depth reported
+			glm::vec3	m_normal			{ 0.0f };		//averaged world space normal, pointing from body 1 to body 2
+			uint32_t	m_contactPointIndex	{ WP_Physics::WP_ContactPoints::c_InvalidIndex };	//latest contact points, see GetContactPoints()
 		};
 
 		class WP_ContactPayload final : public EventPayload
@@ -575,9 +780,94 @@ public:
 			const WP_GameObjectID m_gameObject2;
 		};
 
+		//all contacts of a type found in the last physics update, valid until the next physics update.
+		std::span<const WP_ContactPayloadDelayed>	GetContacts(WP_ContactType _type) const;
+		//pooled contact points of a record, nullptr if the record has none (removed contacts).
+		WP_Physics::WP_ContactPoints const*		GetContactPoints(WP_ContactPayloadDelayed const& _contact) const;
+
+		WP_ContactListener()	{ m_ContactPointPool.reserve(1024); m_islandLinks.reserve(1024); }
+
+		//validate stage filtering, rejected pairs never get a manifold or a contact record
+		enum class WP_ContactFilterResult : uint8_t
+		{
+			ACCEPT,
+			REJECT_CONTACT,		//this sub shape hit only, e.g. the underside of a one way platform
+			REJECT_PAIR			//every contact of the body pair for this collision step
+		};
+		struct WP_ContactFilterInfo
+		{
+			WP_GameObjectID		m_gameObject1;
+			WP_GameObjectID		m_gameObject2;
+			JPH::ObjectLayer	m_layer1;
+			JPH::ObjectLayer	m_layer2;
+			glm::vec3			m_position;				//deepest point on body 1
+			glm::vec3			m_normal;				//from body 1 to body 2
+			glm::vec3			m_relativeVelocity;		//velocity of body 2 relative to body 1 at m_position
+		};
+		//called from the physics jobs, must not touch the physics system or gameobjects
+		using WP_ContactFilter = std::function<WP_ContactFilterResult(WP_ContactFilterInfo const&)>;
+
+		//read from the job threads, only written between physics updates
+		WP_PhysicsPairFilter											m_ignoredPairs;
+		std::array<WP_ContactFilter, WP_PhysicsLayerMatrix::c_MaxLayers>	m_layerFilters;
+		uint32_t														m_filteredLayers = 0;			//bit per layer with a filter
+
+		//counted from the job threads, taken and reset by the physics system after each update
+		std::atomic<uint32_t>											m_numValidatedPairs{ 0 };		//body pairs that reached the narrow phase
+		std::atomic<uint32_t>											m_numManifolds{ 0 };			//added and persisted manifolds, one contact constraint each
+
 		std::vector<WP_ContactPayloadDelayed>							m_ContactAddedList;
 		std::vector<WP_ContactPayloadDelayed>							m_ContactPersistList;
 		std::vector<WP_ContactPayloadDelayed>							m_ContactRemovedList;
+
+		//flight recorder islands, body index pairs of every manifold touching a dynamic body. a static or
+		//kinematic side is replaced by the dynamic body, they do not join islands
+		bool															m_isRecordingIslands = true;
+		std::vector<std::pair<uint32_t, uint32_t>>						m_islandLinks;
+
+	private:
+		//body pair and gameobject pair, a baked static body holds many gameobjects
+		struct WP_ContactPairKey
+		{
+			uint64_t	m_bodies;
+			uint64_t	m_objects;
+			bool operator==(WP_ContactPairKey const&) const = default;
+		};
+		struct WP_ContactPairKeyHash
+		{
+			size_t operator()(WP_ContactPairKey const& _key) const
+			{
+				return std::hash<uint64_t>{}(_key.m_bodies ^ (_key.m_objects * 0x9E3779B97F4A7C15ull));
+			}
+		};
+		//pair key to index in a contact list
+		using WP_ContactPairIndex = std::unordered_map<WP_ContactPairKey, uint32_t, WP_ContactPairKeyHash>;
+
+		//records of the pairs hashed to one stripe during the physics updates of a frame. job threads
+		//reporting pairs of different stripes never wait on each other
+		struct alignas(JPH_CACHE_LINE_SIZE) WP_ContactStripe
+		{
+			std::mutex													m_mutex;
+			std::array<std::vector<WP_ContactPayloadDelayed>, 3>		m_lists;			//ADDED, PERSISTED, REMOVED
+			std::array<WP_ContactPairIndex, 3>							m_indices;
+			std::vector<WP_Physics::WP_ContactPoints>					m_points;			//record point indices are local to the stripe until gathered
+			std::vector<std::pair<uint32_t, uint32_t>>					m_islandLinks;
+		};
+
+		WP_ContactStripe&				GetStripe(WP_ContactPairKey const& _key);
+		//merge a contact callback into the record of its pair, the stripe's mutex must be held
+		WP_ContactPayloadDelayed&		AggregateContact(WP_ContactStripe& _stripe, WP_ContactType _type, WP_ContactPairKey const& _key,
+											WP_GameObjectID _object1, WP_GameObjectID _object2);
+		//called from physics job threads
+		void							AggregateManifold(WP_ContactType _type, const JPH::Body& _body1, const JPH::Body& _body2,
+											const JPH::ContactManifold& _manifold);
+		//turn summed values into averages before the contact stream is read
+		void							FinalizeContacts();
+
+		std::array<WP_ContactStripe, WP_PHYSICS_CONTACT_STRIPES>		m_stripes;
+		std::vector<WP_Physics::WP_ContactPoints>						m_ContactPointPool;				//one slot per added/persisted record, reused every frame
+		std::atomic<uint32_t>											m_currentStep{ 0 };				//collision step since the start of the frame, written by OnStep
+		uint32_t														m_numStepsStarted = 0;
 };
 
 
@@ -585,6 +875,265 @@ public:
 	//							End of Contact Listener
 	//================================================================================
 
+	//================================================================================
+	//						Per GameObject contact subscription
+	//================================================================================
+	using WP_ContactType			= WP_ContactListener::WP_ContactType;
+	using WP_ContactRecord			= WP_ContactListener::WP_ContactPayloadDelayed;
+	using WP_ContactSpan			= std::span<const WP_ContactRecord>;
+	using WP_ContactCallback		= std::function<void(WP_ContactType, WP_ContactRecord const&)>;
+	using WP_ContactStreamCallback	= std::function<void(WP_ContactType, WP_ContactSpan)>;
+	using WP_ContactSubscriptionID	= uint32_t;
+	static constexpr WP_ContactSubscriptionID c_InvalidContactSubscription = 0;
+
+	//contacts of _type from the last physics update, valid until the next physics update.
+	WP_ContactSpan				GetContactStream(WP_ContactType _type) const;
+	//contact points of a record from GetContactStream(), nullptr if none. same lifetime as the stream.
+	WP_Physics::WP_ContactPoints const* GetContactPoints(WP_ContactRecord const& _contact) const;
+	//_callback is called once per non empty contact type per physics update with the whole stream, before the
+	//per gameobject subscribers. Shares ids with SubscribeContact, same rules for changes made while dispatching.
+	WP_ContactSubscriptionID	AddContactStreamCallback(WP_ContactStreamCallback _callback);
+	void						RemoveContactStreamCallback(WP_ContactSubscriptionID _subscription);
+	//the per contact kPhysicsContact*Delayed events with a WP_ContactPayloadDelayed. on by default,
+	//turn off once every listener has moved to the contact stream or SubscribeContact.
+	void						SetDelayedContactEventsEnabled(bool _isEnabled) { m_isDelayedContactEventsEnabled = _isEnabled; }
+	bool						GetIsDelayedContactEventsEnabled() const { return m_isDelayedContactEventsEnabled; }
+
+	//_callback is only called for contacts where _id is one of the pair, after the physics update.
+	//Safe to call from inside a contact callback, change applies after the current dispatch.
+	WP_ContactSubscriptionID	SubscribeContact(WP_GameObjectID _id, WP_ContactType _type, WP_ContactCallback _callback);
+	void						UnsubscribeContact(WP_ContactSubscriptionID _subscription);
+
+	//================================================================================
+	//						Contact filtering
+	//================================================================================
+	//Rules checked in OnContactValidate, before manifolds and contact constraints are built, so
+	//rejected pairs cost no solver work and never reach the contact streams or events.
+	//Ignored pairs are keyed by body and dropped when either body is removed, ignore again after
+	//recreating a body. Layer filters run on the physics jobs for any pair with a body on the layer,
+	//when both layers have one, both must accept.
+	using WP_ContactFilterResult	= WP_ContactListener::WP_ContactFilterResult;
+	using WP_ContactFilterInfo		= WP_ContactListener::WP_ContactFilterInfo;
+	using WP_ContactFilter			= WP_ContactListener::WP_ContactFilter;
+
+	void						IgnoreContacts(WP_GameObjectID _id1, WP_GameObjectID _id2);		//e.g. a thrower and its weapon
+	void						UnignoreContacts(WP_GameObjectID _id1, WP_GameObjectID _id2);
+	bool						GetIsContactIgnored(WP_GameObjectID _id1, WP_GameObjectID _id2) const;
+	void						ClearIgnoredContacts();
+	void						SetLayerContactFilter(JPH::ObjectLayer _layer, WP_ContactFilter _filter);	//empty _filter removes it
+	//used by WP_Physics3D before its body goes away
+	void						ForgetIgnoredContacts(JPH::BodyID _bID) { m_ContactListener.m_ignoredPairs.RemoveBody(_bID); }
+	//the body was changed or woken outside the physics update, getters skip its snapshot until the next publish.
+	//called by every setter that can move, wake or sleep a body, WP_Physics3D included
+	void						MarkSnapshotDirty(JPH::BodyID _bodyID);
+
+	//================================================================================
+	//						Sensor overlap tracker
+	//================================================================================
+	//Triggers on a tracked sensor layer (see WP_PhysicsLayerMatrix) skip the contact pipeline, their
+	//collision group rejects every pair before the narrow phase. Once per frame each sensor's shape is
+	//collided against the world and diffed against last frame's overlaps, only SENSOR_ENTER / SENSOR_EXIT
+	//records are produced. Any other trigger, SENSOR layer or not, keeps its simulation contacts.
+	//Define WP_PHYSICS_SENSOR_CONTACT_EVENTS to 1 to keep the contact events for tracked sensors as well.
+	void						RegisterSensor(WP_GameObjectID _id);
+	void						UnregisterSensor(WP_GameObjectID _id);	//emits exits for current overlaps
+	//called by WP_Physics3D when its body joins or leaves the world and on layer changes
+	void						UpdateSensorTracking(WP_Physics3D& _comp);
+	std::span<const WP_GameObjectID> GetSensorOverlaps(WP_GameObjectID _id) const;	//sorted, empty if not a sensor
+
+	//================================================================================
+	//						Static geometry bake
+	//================================================================================
+	//On engine run, pure static colliders (not triggers or npcs) are grouped by cell, layer and
+	//surface, and each group becomes one StaticCompoundShape body instead of one body per collider.
+	//Contacts and raycasts still report the original gameobject through GetIDfromSubShape.
+	//Off by default. Baked colliders have no body of their own, so they can not be moved or resized
+	//and the GetBody* getters see no body for them. Disabling or removing one takes its cell apart
+	//and bakes the rest of the cell again without it.
+	//With a cache path set, baked shapes are saved with Jolt's binary shape format and loaded
+	//directly on the next run if the static colliders did not change.
+	void						SetStaticBakeEnabled(bool _isEnabled) { m_isStaticBakeEnabled = _isEnabled; }	//applies on next engine run
+	bool						GetIsStaticBakeEnabled() const { return m_isStaticBakeEnabled; }
+	void						SetStaticBakeCachePath(std::string const& _path) { m_staticBakeCachePath = _path; }	//empty to disable
+	uint32_t					GetNumBakedCells() const { return static_cast<uint32_t>(m_bakedCells.size()); }
+	//takes _comp out of its baked cell, with a body of its own if _isKeptAsBody. Called by WP_Physics3D
+	void						UnbakeCollider(WP_Physics3D& _comp, bool _isKeptAsBody);
+
+	//point world streaming and physics LOD are measured from, usually the player. set by gameplay every frame
+	void						SetPhysicsFocus(glm::vec3 const& _position) { m_physicsFocus = _position; }
+	glm::vec3 const&			GetPhysicsFocus() const { return m_physicsFocus; }
+
+	//================================================================================
+	//						World streaming
+	//================================================================================
+	//On engine run, pure static colliders (not triggers or npcs) are grouped into streaming cells
+	//instead of being added to the physics system. Only cells around the physics focus have
+	//bodies: their bodies are created and the broadphase batch is prepared as low priority engine
+	//jobs, then added with AddBodiesFinalize at the start of the next update. Cells out of range are
+	//removed and their bodies freed, the body creation settings are kept so a cell streaming back in
+	//skips shape creation. Takes over from the static bake when enabled.
+	//Dynamic, kinematic, trigger and npc bodies are always resident. Disabling or removing a streamed
+	//collider takes it out of its cell for good, freeing its body if the cell is loaded.
+	void						SetStreamingEnabled(bool _isEnabled) { m_isStreamingEnabled = _isEnabled; }	//applies on next engine run
+	bool						GetIsStreamingEnabled() const { return m_isStreamingEnabled; }
+	uint32_t					GetNumStreamCells() const { return static_cast<uint32_t>(m_streamCells.size()); }
+	uint32_t					GetNumLoadedStreamCells() const { return m_numLoadedStreamCells; }
+	//takes _comp out of its streaming cell, with a body of its own if _isKeptAsBody. Called by WP_Physics3D
+	void						UnstreamCollider(WP_Physics3D& _comp, bool _isKeptAsBody);
+
+	//================================================================================
+	//						Physics level of detail
+	//================================================================================
+	//Dynamic bodies are bucketed by distance to the physics focus every WP_PHYSICS_LOD_INTERVAL updates.
+	//Far bodies drop to discrete motion quality, then become proxies that stay dynamic but are solved
+	//with fewer solver steps, then are forced to sleep. Coming back in range restores the motion
+	//quality, solver steps and velocities they had, so the switch is not visible up close.
+	//Calling SetBodyMotionType hands the body back to gameplay.
+	enum class WP_PhysicsLOD : uint8_t
+	{
+		FULL,
+		DISCRETE,		//motion quality forced to discrete
+		PROXY,			//still dynamic, solved with WP_PHYSICS_LOD_PROXY_*_STEPS
+		SLEEP,			//forced to sleep, velocities are restored on wake
+		NUM_LODS
+	};
+	void						SetLODEnabled(bool _isEnabled) { m_isLODEnabled = _isEnabled; }	//disabling restores all bodies on the next update
+	bool						GetIsLODEnabled() const { return m_isLODEnabled; }
+	WP_PhysicsLOD				GetBodyLOD(WP_GameObjectID _id) const;
+
+	//================================================================================
+	//						Memory telemetry
+	//================================================================================
+	//Usage of the fixed limits the physics system was created with, refreshed after every update.
+	//A warning is logged once when a value passes the warning ratio of its limit, and again after
+	//it has dropped back below. Pair and constraint counts come from the contact listener:
+	//colliding body pairs and contact manifolds per collision step, so broadphase pairs that
+	//did not touch are not included.
+	struct WP_PhysicsTelemetry
+	{
+		uint32_t	m_tempAllocatorCapacity;
+		uint32_t	m_tempAllocatorHighWaterMark;	//peak bytes used during the last update
+		uint32_t	m_tempAllocatorOverflows;		//allocations of the last update that did not fit the arena
+		uint32_t	m_numBodies;
+		uint32_t	m_maxBodies;
+		uint32_t	m_numBodyPairs;					//busiest collision step of the last update
+		uint32_t	m_maxBodyPairs;
+		uint32_t	m_numContactConstraints;		//busiest collision step of the last update
+		uint32_t	m_maxContactConstraints;
+	};
+	WP_PhysicsTelemetry const&	GetTelemetry() const { return m_telemetry; }
+	void						SetTelemetryWarningRatio(float _ratio) { m_telemetryWarningRatio = _ratio; }	//0 disables warnings
+	float						GetTelemetryWarningRatio() const { return m_telemetryWarningRatio; }
+	//adaptive arena doubles between frames when an update comes near its size, up to WP_PHYSICS_TEMP_ALLOCATOR_MAX_SIZE
+	void						SetTempAllocatorAdaptive(bool _isAdaptive) { m_isTempAllocatorAdaptive = _isAdaptive; }
+	bool						GetIsTempAllocatorAdaptive() const { return m_isTempAllocatorAdaptive; }
+
+	//================================================================================
+	//						Flight recorder
+	//================================================================================
+	//On by default. Every physics update appends one record (world size, contact counts, delayed
+	//commands, phase timings and the largest contact islands) to a fixed ring holding the last
+	//WP_PHYSICS_FLIGHT_RECORDER_FRAMES updates. The ring is dumped to the dump directory when the
+	//frame or the physics update takes longer than the hitch threshold, at most once per ring length
+	//so one long stall does not write a file every frame, or when DumpFlightRecorder is called.
+	//Hitch dumps are off outside development builds, skip the first ring length after engine run
+	//(scene load) and reuse WP_PHYSICS_FLIGHT_RECORDER_MAX_HITCH_DUMPS files, oldest first.
+	//Summarise a dump with Tools/WP_PhysicsFlightSummary.
+	void						SetFlightRecorderEnabled(bool _isEnabled);
+	bool						GetIsFlightRecorderEnabled() const { return m_isFlightRecorderEnabled; }
+	void						SetFlightRecorderHitchThreshold(float _milliseconds) { m_flightRecorderHitchThreshold = _milliseconds; }	//0 disables hitch dumps
+	float						GetFlightRecorderHitchThreshold() const { return m_flightRecorderHitchThreshold; }
+	void						SetFlightRecorderDirectory(std::string const& _directory) { m_flightRecorderDirectory = _directory; }
+	bool						DumpFlightRecorder();	//false if the file could not be written
+	WP_PhysicsFlightRecorder const& GetFlightRecorder() const { return m_flightRecorder; }
+
+	//================================================================================
+	//						State snapshots
+	//================================================================================
+	//Compact snapshots of every body (position, rotation, velocities, awake state) for play/stop,
+	//rewind and replays, see WP_PhysicsStateCodec. Captures form one delta encoded stream: each
+	//snapshot after a keyframe only holds the bodies that changed since the previous capture, so
+	//restores must be given the snapshots of that stream in capture order, starting at a keyframe.
+	//Bodies are keyed by JPH::BodyID, so a snapshot only restores into the same play session:
+	//play/stop recreates every body and the old ids no longer match anything.
+	//Restored poses are written back to the bound transforms. Main thread, between physics updates.
+	void						CaptureStateSnapshot(std::vector<uint8_t>& _out, bool _isKeyframe = false);	//appends to _out
+	//moves the bodies still alive to the snapshot state, false if the snapshot could not be decoded
+	bool						RestoreStateSnapshot(std::span<const uint8_t> _snapshot);
+	void						SetStateSnapshotSettings(WP_PhysicsStateCodec::WP_Settings const& _settings) { m_snapshotEncoder.SetSettings(_settings); }
+	WP_PhysicsStateCodec::WP_Settings const& GetStateSnapshotSettings() const { return m_snapshotEncoder.GetSettings(); }
+	//finer or coarser positions in one world cell, 0 bits restores the default
+	void						SetStateSnapshotCellPrecision(glm::ivec3 const& _cell, uint8_t _positionBits) { m_snapshotEncoder.SetCellPrecision(_cell, _positionBits); }
+	//next capture is a keyframe and restores wait for one
+	void						ResetStateSnapshots();
+
+	//================================================================================
+	//						Force field volumes
+	//================================================================================
+	//World space boxes that push the active dynamic bodies overlapping them. At the start of every
+	//collision step the bodies in each volume are gathered with a broadphase query and grouped by body, then
+	//the forces are applied in parallel engine jobs. Every volume of a body is applied by the same job
+	//in the order the volumes were added, so overlapping volumes give the same result every run.
+	//Sleeping bodies are left asleep. Force fields belong to the scene and are cleared on engine stop.
+	enum class WP_ForceFieldType : uint8_t
+	{
+		WATER,				//buoyancy and drag below the top face of the volume, flowing at m_velocity
+		WIND,				//pulls body velocity towards m_velocity at m_linearDrag per second
+		RADIAL_GRAVITY,		//accelerates towards m_center at m_strength
+		DRAG,				//damps linear and angular velocity
+		NUM_FORCE_FIELD_TYPES
+	};
+	struct WP_ForceFieldSettings
+	{
+		WP_ForceFieldType	m_type			{ WP_ForceFieldType::WATER };
+		glm::vec3			m_center		{ 0.f };
+		glm::vec3			m_halfExtent	{ 1.f };
+		glm::vec3			m_velocity		{ 0.f };		//water current or wind velocity
+		float				m_strength		{ 9.81f };		//radial gravity acceleration
+		float				m_buoyancy		{ 1.1f };		//water, 1 is neutral
+		float				m_linearDrag	{ 0.5f };
+		float				m_angularDrag	{ 0.05f };
+		bool				m_isReplacingGravity{ false };	//radial gravity cancels world gravity inside the volume
+		uint32_t			m_layerMask		{ ~0u };		//object layers affected, bit per layer
+	};
+	using WP_ForceFieldID = uint32_t;
+	static constexpr WP_ForceFieldID c_InvalidForceField = 0;
+
+	WP_ForceFieldID				AddForceField(WP_ForceFieldSettings const& _settings);
+	void						SetForceField(WP_ForceFieldID _field, WP_ForceFieldSettings const& _settings);
+	WP_ForceFieldSettings const* GetForceField(WP_ForceFieldID _field) const;		//nullptr if not found
+	void						RemoveForceField(WP_ForceFieldID _field);
+	void						ClearForceFields();
+	uint32_t					GetNumForceFields() const { return static_cast<uint32_t>(m_forceFields.size()); }
+
+	//================================================================================
+	//						Body pool
+	//================================================================================
+	//Bodies of the pooled layers (DEBRIES by default) are not destroyed when their component removes
+	//them. They are taken out of the broadphase and parked, keyed by shape, layer and motion type.
+	//The next component of the same key reuses a parked body: it is given the component's material
+	//and mass, moved and added back, instead of creating a new body. Parked bodies count towards
+	//the body limit. The pool is cleared on engine stop.
+	struct WP_BodyPoolStats
+	{
+		uint32_t	m_numAcquires;		//pooled layer bodies added since reset
+		uint32_t	m_numHits;			//of those, served from a parked body
+		uint32_t	m_numReleases;		//bodies parked instead of destroyed since reset
+		uint32_t	m_numOverflows;		//bodies destroyed since reset because their key or the pool was full
+		uint32_t	m_numParked;		//bodies parked now
+		float		GetHitRate() const { return m_numAcquires ? static_cast<float>(m_numHits) / m_numAcquires : 0.f; }
+	};
+	void						SetBodyPoolLayers(uint32_t _layerMask) { m_bodyPoolLayers = _layerMask; }	//bit per layer, 0 disables pooling
+	uint32_t					GetBodyPoolLayers() const { return m_bodyPoolLayers; }
+	//parks _count new bodies shaped like the body of _prototype
+	void						PrewarmBodyPool(WP_GameObjectID _prototype, uint32_t _count);
+	void						ClearBodyPool();
+	WP_BodyPoolStats const&		GetBodyPoolStats() const { return m_bodyPoolStats; }
+	void						ResetBodyPoolStats();
+	//used by WP_Physics3D. acquire returns an invalid id on a miss, release returns false if the body must be destroyed
+	JPH::BodyID					AcquirePooledBody(JPH::BodyCreationSettings const& _settings);
+	bool						ReleasePooledBody(JPH::BodyID _bID);
+
 #if 0		//Who should haave access?
 	physicsIdType AddBody(JPH::BodyCreationSettings);			//add body
 	void SuspendBody(physicsIdType id);	//remove body
@@ -598,6 +1147,9 @@ public:
 	inline JPH::BodyInterface& GetPhysicsBI() { return m_physics_system.GetBodyInterface(); }
 	inline JPH::BodyInterface const& GetPhysicsBI() const { return m_physics_system.GetBodyInterface(); }
 	inline JPH::NarrowPhaseQuery const& GetPhysicsNPQ() const { return m_physics_system.GetNarrowPhaseQuery(); }
+
+	//called by WP_Physics3D when its body or offsets change, the sync loops rebind before the next update
+	void						MarkTransformBindingsDirty() { m_isTransformBindingsDirty = true; }
 private:
 	WP_PhysicsSystem();
 	~WP_PhysicsSystem();
@@ -611,7 +1163,7 @@ private:
 	int											m_maxPhysicsSteps;
 	JPH::PhysicsSystem							m_physics_system;
 
-	std::unique_ptr<JPH::TempAllocator>			temp_allocator = nullptr;
+	std::unique_ptr<WP_PhysicsTempAllocator>	temp_allocator = nullptr;
 	std::unique_ptr<JPH::JobSystem>				job_system = nullptr;
 
 	enum class WP_PHYSICS_SYSTEM_FUNCTIONS {};
@@ -620,6 +1172,10 @@ private:
 	WP_DelayedPhysicsList						m_DelayedPhysicsList;
 
 #if 1
+	WP_PhysicsLayerMatrix						m_layerMatrix;									//must be declared before the layer filters
+	WP_PhysicsMeshCooker						m_meshCooker;
+	WP_PhysicsProjectiles						m_projectiles;
+	WP_PhysicsPrediction						m_prediction;
 	WP_BodyActivationListener					m_BodyActivationListener;						//call while collision active
 	WP_ObjectLayerPairFilter					m_ObjectLayerPairFilter;
 	WP_ObjectVsBroadPhaseLayerFilterImpl		m_ObjectVsBroadPhaseLayerFilterImpl;
@@ -631,6 +1187,279 @@ private:
 #endif
 
 	std::map<uint32_t, WP_GameObjectID>			m_bodyToID;
+
+	//dense set of awake bodies, updated from m_BodyActivationListener after each update
+	std::vector<WP_GameObjectID>							m_awakeObjects;
+	std::unordered_map<WP_GameObjectID, uint32_t>			m_awakeObjectIndex;		//gameobject id to index in m_awakeObjects
+	WP_BodyActivationListener::WP_ActivationChangeList		m_activationChanges;	//drain buffer, kept to avoid reallocation
+
+	void										ApplyActivationChanges();
+	void										ClearAwakeObjects();
+
+	struct WP_BodyStateBuffer
+	{
+		std::vector<uint32_t>			m_bodyIDs;			//index and sequence number, cInvalidBodyID if the slot is empty
+		std::vector<glm::vec3>			m_positions;
+		std::vector<glm::quat>			m_rotations;
+		std::vector<glm::vec3>			m_linearVelocities;
+		std::vector<glm::vec3>			m_angularVelocities;
+		std::vector<JPH::EMotionType>	m_motionTypes;
+		std::vector<uint8_t>			m_isActive;
+		std::vector<uint32_t>			m_writtenSlots;		//slots filled by the last publish into this buffer
+		std::atomic<uint64_t>			m_version{ 0 };		//odd while being written
+	};
+	std::array<WP_BodyStateBuffer, 2>			m_snapshots;
+	std::atomic<uint32_t>						m_publishedSnapshot{ 0 };
+	std::atomic<uint64_t>						m_snapshotFrame{ 0 };
+	std::vector<uint8_t>						m_snapshotDirty;		//per body index, changed by a setter since the publish
+	JPH::BodyIDVector							m_snapshotBodies;		//reused body list
+
+	void										PublishBodySnapshot();
+
+	struct WP_ContactSubscriber
+	{
+		WP_ContactSubscriptionID	m_subscriptionID;
+		WP_ContactType				m_type;
+		WP_ContactCallback			m_callback;
+	};
+	using WP_ContactSubscriberList = std::vector<WP_ContactSubscriber>;
+
+	//hashed by gameobject so dispatch cost only depends on contacts of subscribed objects
+	std::unordered_map<WP_GameObjectID, WP_ContactSubscriberList>		m_contactSubscribers;
+	std::unordered_map<WP_ContactSubscriptionID, WP_GameObjectID>		m_contactSubscriptionOwner;
+	std::vector<std::pair<WP_GameObjectID, WP_ContactSubscriber>>		m_pendingContactSubscribers;	//(un)subscribes made while dispatching
+	std::vector<WP_ContactSubscriptionID>								m_pendingContactUnsubscribes;
+	WP_ContactSubscriptionID											m_nextContactSubscription = c_InvalidContactSubscription + 1;
+	bool																m_isDispatchingContacts = false;
+	std::vector<std::pair<WP_ContactSubscriptionID, WP_ContactStreamCallback>>	m_contactStreamCallbacks;	//removed while dispatching = empty callback
+	bool																m_isDelayedContactEventsEnabled = true;
+
+	void										DispatchContactStreams();
+
+	void										DispatchContactSubscribers();
+
+	struct WP_SensorState
+	{
+		WP_GameObjectID					m_id;
+		std::vector<WP_GameObjectID>	m_overlaps;		//sorted, as of the last update
+	};
+	std::vector<WP_SensorState>							m_sensors;
+	std::unordered_map<WP_GameObjectID, uint32_t>		m_sensorIndex;			//gameobject id to index in m_sensors
+	std::vector<WP_GameObjectID>						m_sensorScratch;		//current overlaps of one sensor, reused
+	std::vector<WP_ContactRecord>						m_sensorEnterList;
+	std::vector<WP_ContactRecord>						m_sensorExitList;
+	std::vector<WP_ContactRecord>						m_sensorPendingExitList;	//exits from unregistered sensors
+	JPH::Ref<JPH::GroupFilter>							m_trackedSensorFilter;		//collision group filter of tracked sensors, rejects all pairs
+
+	struct WP_BakedCell
+	{
+		JPH::BodyID								m_bID;
+		JPH::RefConst<JPH::StaticCompoundShape>	m_shape;
+		std::vector<WP_GameObjectID>			m_subShapeToID;		//indexed by sub shape user data
+	};
+	bool												m_isStaticBakeEnabled = false;
+	std::string											m_staticBakeCachePath;
+	std::unordered_map<uint32_t, WP_BakedCell>			m_bakedCells;			//body index to baked cell
+
+	enum class WP_StreamCellState : uint8_t
+	{
+		UNLOADED,
+		PREPARING,		//bodies are being created on the job system
+		LOADED
+	};
+	struct WP_StreamCell
+	{
+		glm::vec3								m_min;
+		glm::vec3								m_max;
+		std::vector<WP_GameObjectID>			m_ids;
+		std::vector<JPH::BodyCreationSettings>	m_settings;		//built on first load, kept while unloaded
+		std::vector<JPH::BodyID>				m_bodies;		//written by the prepare job, empty while unloaded
+		JPH::BodyInterface::AddState			m_addState = nullptr;
+		WP_JobSystem::WP_JobCounter				m_jobCounter;
+		WP_StreamCellState						m_state = WP_StreamCellState::UNLOADED;
+	};
+	glm::vec3											m_physicsFocus{ 0.f };
+	bool												m_isStreamingEnabled = false;
+	std::deque<WP_StreamCell>							m_streamCells;			//deque, cells never move while a job holds one
+	uint32_t											m_numLoadedStreamCells = 0;
+
+	void										BuildStreamCells(std::vector<WP_Physics3D*> const& _colliders);
+	void										UpdateStreaming(bool _isBlocking = false);
+	void										PrepareStreamCell(WP_StreamCell& _cell);
+	void										FinalizeStreamCell(WP_StreamCell& _cell);
+	void										UnloadStreamCell(WP_StreamCell& _cell);
+	void										ClearStreamCells();
+
+	struct WP_BodyLODState
+	{
+		JPH::BodyID								m_bID;
+		WP_PhysicsLOD							m_lod = WP_PhysicsLOD::FULL;
+		JPH::EMotionQuality						m_fullQuality = JPH::EMotionQuality::Discrete;
+		uint32_t								m_fullVelocitySteps = 0;	//body overrides, 0 uses the physics settings
+		uint32_t								m_fullPositionSteps = 0;
+		JPH::Vec3								m_sleepLinearVelocity;		//velocities when forced to sleep
+		JPH::Vec3								m_sleepAngularVelocity;
+		bool									m_isSleepActive = false;	//was awake when forced to sleep
+	};
+	bool												m_isLODEnabled = false;
+	uint32_t											m_lodFrame = 0;
+	std::unordered_map<uint32_t, WP_BodyLODState>		m_bodyLODs;				//body index to lod, only bodies below FULL
+
+	WP_PhysicsTelemetry									m_telemetry{};
+	float												m_telemetryWarningRatio = WP_PHYSICS_TELEMETRY_WARNING_RATIO;
+	uint32_t											m_telemetryWarnings = 0;	//bit per limit already warned about
+	bool												m_isTempAllocatorAdaptive = false;
+
+	void										UpdateTelemetry(uint32_t _numBodyPairs, uint32_t _numContactConstraints);
+
+	using WP_PhysicsPhaseTimes = std::array<float, WP_PhysicsFlightRecorder::c_NumPhases>;
+	WP_PhysicsFlightRecorder							m_flightRecorder;
+	bool												m_isFlightRecorderEnabled = true;
+	float												m_flightRecorderHitchThreshold = WP_PHYSICS_FLIGHT_RECORDER_HITCH_MS;
+	std::string											m_flightRecorderDirectory{ WP_PHYSICS_FLIGHT_RECORDER_DIRECTORY };
+	uint32_t											m_flightRecorderCooldown = 0;		//updates before the next hitch dump is allowed
+	uint32_t											m_numHitchDumps = 0;				//since start, picks the file to overwrite
+	//union find over body indices, sized to the body limit, only touched entries are reset
+	std::vector<uint32_t>								m_islandParent;
+	std::vector<uint32_t>								m_islandNumBodies;					//0 = body not in a contact this update
+	std::vector<uint32_t>								m_islandNumContacts;
+	std::vector<uint32_t>								m_islandTouched;
+
+	void										RecordFlightFrame(WP_PhysicsPhaseTimes const& _phaseTimes, float _frameTime,
+													uint32_t _numCollisionSteps, uint32_t _numDelayedCommands, uint32_t _numBodyPairs, uint32_t _numContactConstraints);
+	void										RecordIslands(WP_PhysicsFlightRecorder::WP_FrameRecord& _record);
+	bool										DumpFlightRecorder(WP_PhysicsFlightRecorder::WP_DumpTrigger _trigger);
+
+	WP_PhysicsStateCodec								m_snapshotEncoder;
+	WP_PhysicsStateCodec								m_snapshotDecoder;
+	std::vector<WP_PhysicsStateCodec::WP_BodyState>		m_snapshotStates;		//reused capture and restore list
+
+	struct WP_ForceField
+	{
+		WP_ForceFieldID							m_id;
+		WP_ForceFieldSettings					m_settings;
+	};
+	struct WP_ForceFieldEntry
+	{
+		JPH::BodyID								m_bID;
+		uint32_t								m_field;		//index in m_forceFields
+	};
+	struct WP_ForceFieldBatch
+	{
+		uint32_t								m_begin;		//range in m_forceFieldEntries
+		uint32_t								m_end;
+	};
+	std::vector<WP_ForceField>							m_forceFields;
+	WP_ForceFieldID										m_nextForceField = c_InvalidForceField + 1;
+	std::vector<WP_ForceFieldEntry>						m_forceFieldEntries;	//scratch, sorted by body then volume
+	std::vector<WP_ForceFieldBatch>						m_forceFieldBatches;	//scratch, no body spans two batches
+
+	void										ApplyForceFields(float _deltaTime);
+	void										ApplyForceFieldBatch(WP_ForceFieldBatch const& _batch, float _deltaTime);
+
+	//applies the force fields once per collision step with the step's dt, not once per update
+	class WP_ForceFieldStepListener final : public JPH::PhysicsStepListener
+	{
+	public:
+		explicit WP_ForceFieldStepListener(WP_PhysicsSystem& _system) : m_system{ _system } {/*Empty by Design*/ }
+		// See: PhysicsStepListener
+		virtual void			OnStep(const JPH::PhysicsStepListenerContext& inContext) override;
+	private:
+		WP_PhysicsSystem&		m_system;
+	};
+	WP_ForceFieldStepListener							m_forceFieldListener{ *this };
+	float												m_forceFieldMilliseconds{};	//spent in the listener this update, moved out of the simulation phase
+
+	struct WP_BodyPoolKey
+	{
+		JPH::EShapeSubType						m_subType;
+		JPH::Shape const*						m_innerShape;	//cooked shape shared by the mesh cooker, nullptr for primitives
+		glm::ivec3								m_boundsMin;	//local bounds in millimetres
+		glm::ivec3								m_boundsMax;
+		JPH::ObjectLayer						m_layer;
+		JPH::EMotionType						m_motionType;
+		bool operator==(WP_BodyPoolKey const&) const = default;
+	};
+	struct WP_BodyPoolKeyHash
+	{
+		size_t operator()(WP_BodyPoolKey const& _key) const;
+	};
+	std::unordered_map<WP_BodyPoolKey, std::vector<JPH::BodyID>, WP_BodyPoolKeyHash>	m_bodyPool;
+	uint32_t											m_bodyPoolLayers = 1u << Layers::DEBRIES;
+	WP_BodyPoolStats									m_bodyPoolStats{};
+
+	static WP_BodyPoolKey						MakeBodyPoolKey(JPH::Shape const* _shape, JPH::ObjectLayer _layer, JPH::EMotionType _motionType);
+	uint32_t									GetBodyPoolRoom() const;	//bodies that can still be parked under WP_PHYSICS_BODY_POOL_MAX_RATIO
+	bool										GetIsPooledLayer(JPH::ObjectLayer _layer) const { return _layer < WP_PhysicsLayerMatrix::c_MaxLayers && ((m_bodyPoolLayers >> _layer) & 1u); }
+	void										PrewarmBodyPool(JPH::BodyCreationSettings const& _settings, uint32_t _count);
+
+	void										UpdateLOD();
+	void										SetLOD(JPH::BodyID _bodyID, WP_PhysicsLOD _lod);
+	void										RestoreLODs();
+
+	//one entry per simulated component in body index order, so the transform sync loops walk
+	//one array instead of walking the physics component list and its offsets per body.
+	//Rebuilt when a body is added or removed, an offset changes or a component list changes size.
+	//Transforms are looked up by gameobject every sync: transform components can be removed and
+	//added without the physics system hearing of it, so a cached pointer could be another entity's.
+	struct WP_TransformBinding
+	{
+		JPH::BodyID								m_bID;
+		WP_GameObjectID							m_id;
+		WP_Physics3D*							m_physics;		//characters and the npc post simulation only
+		JPH::Vec3								m_posOffset;
+		JPH::Quat								m_rotOffset;
+		JPH::Quat								m_invRotOffset;
+		bool									m_isCharacter;
+		bool									m_isScaled;		//follows the transform scale, see WP_BodyScale
+	};
+	std::vector<WP_TransformBinding>					m_transformBindings;
+	bool												m_isTransformBindingsDirty = true;
+	size_t												m_numBoundTransforms = 0;	//component list sizes at the last rebuild
+	size_t												m_numBoundPhysics = 0;
+
+	void										RefreshTransformBindings();
+
+	//runtime transform scale, per body index. The shape a body was created with is its base shape,
+	//later scale changes swap in a cached JPH::ScaledShape of the base relative to the creation scale,
+	//so the body is never recreated and bodies of a shared base at the same scale share the wrapper.
+	//Mass and inertia are left alone until the scale has held for WP_PHYSICS_SCALE_MASS_SETTLE_FRAMES.
+	struct WP_BodyScale
+	{
+		JPH::BodyID								m_bID;				//invalid = base not captured, taken on the next sync
+		JPH::RefConst<JPH::Shape>				m_baseShape;
+		glm::vec3								m_referenceScale;	//transform scale the base shape was built for
+		glm::ivec3								m_appliedScale;		//transform scale last applied, in WP_PHYSICS_SCALE_QUANTUM
+		uint32_t								m_massSettleFrames;	//0 = mass matches the shape
+	};
+	struct WP_ScaledShapeKey
+	{
+		JPH::Shape const*						m_baseShape;
+		glm::ivec3								m_scale;			//relative to the base, in WP_PHYSICS_SCALE_QUANTUM
+		bool operator==(WP_ScaledShapeKey const&) const = default;
+	};
+	struct WP_ScaledShapeKeyHash
+	{
+		size_t operator()(WP_ScaledShapeKey const& _key) const;
+	};
+	std::vector<WP_BodyScale>							m_bodyScales;
+	std::vector<JPH::BodyID>							m_pendingMassBodies;	//rescaled dynamic bodies waiting on their mass
+	std::unordered_map<WP_ScaledShapeKey, JPH::RefConst<JPH::Shape>, WP_ScaledShapeKeyHash>	m_scaledShapes;
+
+	void										SyncBodyScale(WP_TransformBinding const& _binding, WP_Transform3D const& _transform);
+	JPH::RefConst<JPH::Shape>					GetScaledShape(JPH::Shape const* _baseShape, JPH::Vec3Arg _scale);
+	void										UpdatePendingMass();
+	void										ClearBodyScales();
+
+	void										AddComponentBody(WP_Physics3D& _comp);
+	void										BakeStaticColliders(std::vector<WP_Physics3D*> const& _colliders, bool _isCacheUsed = true);
+	void										ClearBakedCells();
+
+	void										UpdateSensors();
+	void										RemoveSensorAt(uint32_t _index);
+	void										ClearSensors();
+	void										ApplyPendingContactSubscriptions();
+	void										RemoveContactSubscriber(WP_ContactSubscriptionID _subscription);
 	//JPH::StateRecorderImpl						m_defaultState;
 
 	using eventPair = std::pair<EventType, WP_EventCallback::idType>;
@@ -660,8 +1489,44 @@ public:
 	//void OnEngineStop(EventPayload*const);
 
 	WP_GameObjectID GetIDfromBodyID(uint32_t _bID);
+	//same as GetIDfromBodyID, but resolves colliders merged into a baked static cell
+	WP_GameObjectID GetIDfromSubShape(JPH::BodyID _bID, JPH::SubShapeID const& _subShapeID) const;
+	WP_PhysicsLayerMatrix const& GetLayerMatrix() const { return m_layerMatrix; }
+	WP_PhysicsMeshCooker& GetMeshCooker() { return m_meshCooker; }
+	//pooled bullets, swept against the world once per physics update
+	WP_PhysicsProjectiles& GetProjectiles() { return m_projectiles; }
+	//trajectory previews, stepped in a separate world on a background job
+	WP_PhysicsPrediction& GetPrediction() { return m_prediction; }
 	bool GetIsPhysicsLocked() const;
 
+	//Awake physics objects as of the last physics update. Dense and unordered, safe to iterate
+	//from the main thread outside of the physics update. Use this instead of iterating all
+	//WP_Physics3D components when only moving/awake objects are of interest.
+	std::vector<WP_GameObjectID> const&	GetAwakeObjects() const;
+	bool								GetIsObjectAwake(WP_GameObjectID _id) const;
+
+	//================================================================================
+	//					Body state snapshot
+	//================================================================================
+	// Struct of arrays copy of every body's state, indexed by JPH::BodyID index. Published
+	// after each physics update into one of two buffers, readers on any thread never lock.
+	// The GetBody* getters below read it when the body was not changed since the publish,
+	// and fall back to the locking body interface mid-step or after a setter.
+	struct WP_BodyState
+	{
+		glm::vec3			m_position;
+		glm::quat			m_rotation;
+		glm::vec3			m_linearVelocity;
+		glm::vec3			m_angularVelocity;
+		JPH::EMotionType	m_motionType;
+		bool				m_isActive;
+	};
+	bool				ReadBodySnapshot				(JPH::BodyID _bodyID, WP_BodyState& _outState) const;	//false if not in snapshot
+	uint64_t			GetSnapshotFrame				() const;	//number of snapshots published
+private:
+	bool				TryReadSnapshot					(JPH::BodyID _bodyID, WP_BodyState& _outState) const;	//main thread getters, false if dirty or locked
+public:
+
 	//================================================================================
 	//					JPH::Body Property retrieval functions
 	//================================================================================
@@ -727,8 +1592,7 @@ public:
 	void				AddImpulseToPoint				(WP_GameObjectID _id, glm::vec3 const& _impulse, glm::vec3 const& _point);
 	void				AddAngularImpulseToBody			(WP_GameObjectID _id, glm::vec3 const& _angularImpulse);
 
-	// JPH has a function for buoyancy impulse, but wont be implemented unless needed.
-	//bool 	ApplyBuoyancyImpulse (const BodyID &inBodyID, RVec3Arg inSurfacePosition, Vec3Arg inSurfaceNormal, float inBuoyancy, float inLinearDrag, float inAngularDrag, Vec3Arg inFluidVelocity, Vec3Arg inGravity, float inDeltaTime)
+	// buoyancy is applied by WATER force field volumes, see AddForceField
 	//================================================================================
 	//						Character settings for ECS Component
 	//================================================================================
@@ -862,6 +1726,123 @@ public:
 														glm::vec3 const& _origin,
 														glm::vec3 const& _dirVector) const;
 
+	//================================================================================
+	//						Radius and nearest queries
+	//================================================================================
+	// Broadphase queries for gameobjects whose body position lies within a radius, sorted nearest
+	// first. Same layer and id filters as CastRay. Baked static cells are not reported, they hold
+	// many gameobjects in one body. The batched forms run one query per center in parallel engine
+	// jobs, _ignoredPerQuery (optional, parallel to _centers) lets every querier skip itself.
+	// Not during a physics update.
+	using			WP_Distance = float;
+	using			WP_DistanceResult = std::pair<WP_GameObjectID, WP_Distance>;
+	using			WP_DistanceResultCollector = std::vector<WP_DistanceResult>;
+
+	bool				QueryRadius						(glm::vec3 const& _center,
+														float _radius,
+														WP_DistanceResultCollector& _hits,	//out, nearest first
+														CastBPLayer _BroadPhaseLayerMask = CastBPLayer::ALL,
+														CastLayer _ObjectLayerMask = CastLayer::ALL,
+														CastIDMask const& _GameObjectIDMask = CastIDMask()) const;
+
+	bool				QueryNearest					(glm::vec3 const& _center,
+														uint32_t _k,
+														float _maxRadius,
+														WP_DistanceResultCollector& _hits,	//out, at most _k, nearest first
+														CastBPLayer _BroadPhaseLayerMask = CastBPLayer::ALL,
+														CastLayer _ObjectLayerMask = CastLayer::ALL,
+														CastIDMask const& _GameObjectIDMask = CastIDMask()) const;
+
+	void				QueryRadiusBatch				(std::span<const glm::vec3> _centers,
+														float _radius,
+														std::span<WP_DistanceResultCollector> _hits,	//out, one per center
+														std::span<const WP_GameObjectID> _ignoredPerQuery = {},
+														CastBPLayer _BroadPhaseLayerMask = CastBPLayer::ALL,
+														CastLayer _ObjectLayerMask = CastLayer::ALL,
+														CastIDMask const& _GameObjectIDMask = CastIDMask()) const;
+
+	void				QueryNearestBatch				(std::span<const glm::vec3> _centers,
+														uint32_t _k,
+														float _maxRadius,
+														std::span<WP_DistanceResultCollector> _hits,	//out, one per center
+														std::span<const WP_GameObjectID> _ignoredPerQuery = {},
+														CastBPLayer _BroadPhaseLayerMask = CastBPLayer::ALL,
+														CastLayer _ObjectLayerMask = CastLayer::ALL,
+														CastIDMask const& _GameObjectIDMask = CastIDMask()) const;
+
+	//================================================================================
+	//						Ray query cache
+	//================================================================================
+	// Opt-in. CastRay results are cached by quantized origin, direction and filters until the
+	// next physics step, or until a body is teleported, added, removed, reshaped or moved to another
+	// layer, so repeated line of sight checks in a frame are free.
+	void				SetRayCacheEnabled				(bool _enable);
+	bool				GetIsRayCacheEnabled			() const;
+	void				InvalidateRayCache				();
+	float				GetRayCacheHitRate				() const;	//hits / lookups since last reset
+	void				ResetRayCacheStats				();
+
+private:
+	struct WP_RayCacheKey
+	{
+		std::array<int32_t, 6>	m_ray;			//quantized origin xyz, direction xyz
+		CastBPLayer				m_broadPhaseMask;
+		CastLayer				m_objectLayerMask;
+		CastIDMask				m_ignoredIDs;	//compared in full, the hash only narrows the bucket
+		bool					m_isAllHits;
+		bool operator==(WP_RayCacheKey const&) const = default;
+	};
+	struct WP_RayCacheKeyHash
+	{
+		size_t operator()(WP_RayCacheKey const& _key) const;
+	};
+	struct WP_RayCacheEntry
+	{
+		bool					m_isHit;
+		WP_RayResult			m_hit;			//single hit queries
+		WP_RayResultCollector	m_hits;			//all hit queries
+	};
+
+	WP_RayCacheKey		MakeRayCacheKey					(glm::vec3 const& _origin, glm::vec3 const& _dirVector,
+														CastBPLayer _BroadPhaseLayerMask, CastLayer _ObjectLayerMask,
+														CastIDMask const& _GameObjectIDMask, bool _isAllHits) const;
+
+	//gathers every match within _radius, unsorted. reads only, safe from several jobs at once
+	void				CollectWithinRadius				(glm::vec3 const& _center, float _radius, WP_GameObjectID _ignored,
+														CastBPLayer _BroadPhaseLayerMask, CastLayer _ObjectLayerMask,
+														CastIDMask const& _GameObjectIDMask, WP_DistanceResultCollector& _hits) const;
+	//one job per WP_PHYSICS_QUERY_BATCH_SIZE queries, _k == 0 keeps every match
+	void				RunQueryBatch					(std::span<const glm::vec3> _centers, uint32_t _k, float _radius,
+														std::span<WP_DistanceResultCollector> _hits, std::span<const WP_GameObjectID> _ignoredPerQuery,
+														CastBPLayer _BroadPhaseLayerMask, CastLayer _ObjectLayerMask,
+														CastIDMask const& _GameObjectIDMask) const;
+
+	bool																		m_isRayCacheEnabled = false;
+	mutable std::mutex															m_rayCacheMutex;	//CastRay is const and may run on any thread
+	mutable std::unordered_map<WP_RayCacheKey, WP_RayCacheEntry, WP_RayCacheKeyHash>	m_rayCache;
+	mutable uint64_t															m_rayCacheHits = 0;
+	mutable uint64_t															m_rayCacheMisses = 0;
+
+public:
+	//================================================================================
+	//						Bulk functions for scripting
+	//================================================================================
+	// _ids and values are parallel arrays, resolved in one pass. ids without a physics
+	// component/body are skipped (getters write zero). characters (m_isNPC) are routed to
+	// their JPH::Character like the single object functions in WP_PhysicsCS2CPP.
+	void				BulkSetLinearVelocity			(std::span<const WP_GameObjectID> _ids, std::span<const glm::vec3> _vels);
+	void				BulkAddVelocity					(std::span<const WP_GameObjectID> _ids, std::span<const glm::vec3> _vels);
+	void				BulkAddImpulse					(std::span<const WP_GameObjectID> _ids, std::span<const glm::vec3> _impulses);
+	void				BulkSetPosition					(std::span<const WP_GameObjectID> _ids, std::span<const glm::vec3> _positions);
+	void				BulkGetLinearVelocity			(std::span<const WP_GameObjectID> _ids, std::span<glm::vec3> _outVels) const;
+	void				BulkGetPosition					(std::span<const WP_GameObjectID> _ids, std::span<glm::vec3> _outPositions) const;
+
+	//casts _origins.size() rays with default masks, returns number of rays that hit.
+	//rays that miss write WP_INVALID_GAMEOBJECTID as their id.
+	uint32_t			BulkCastRay						(std::span<const glm::vec3> _origins,
+														std::span<const glm::vec3> _dirVectors,
+														std::span<WP_RayResult> _outHits) const;
+
 
 
 	//================================================================================
@@ -919,6 +1900,7 @@ void				WP_PhysicsSystem::SetBodyActive(WP_GameObjectID _id)
 {
 	WP_Physics3D* pComp = WP_ComponentList<WP_Physics3D>::GetComponentList()->GetComponent(_id);
 	assert(pComp);
+	MarkSnapshotDirty(pComp->m_bID);
 	if constexpr (_isActive)
 	{GetPhysicsBI().ActivateBody(pComp->m_bID);}
 	else
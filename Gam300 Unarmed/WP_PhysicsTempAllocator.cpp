@@ -0,0 +1,71 @@
+#include <WP_EngineSystem/WP_PhysicsTempAllocator.h>
+#include <Jolt/Core/Memory.h>
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	constexpr uint32_t c_TempAlignment = JPH_RVECTOR_ALIGNMENT;
+
+	uint32_t AlignSize(JPH::uint _size)
+	{
+		return static_cast<uint32_t>((_size + c_TempAlignment - 1) & ~(c_TempAlignment - 1));
+	}
+}
+
+WP_PhysicsTempAllocator::WP_PhysicsTempAllocator(uint32_t _capacity)
+{
+	Resize(_capacity);
+}
+
+WP_PhysicsTempAllocator::~WP_PhysicsTempAllocator()
+{
+	assert(m_top == 0 && m_overflowBytes == 0);
+	JPH::AlignedFree(m_base);
+}
+
+void* WP_PhysicsTempAllocator::Allocate(JPH::uint _size)
+{
+	if (_size == 0) { return nullptr; }
+	uint32_t const size = AlignSize(_size);
+	void* address;
+	if (size <= m_capacity - m_top)
+	{
+		address = m_base + m_top;
+		m_top += size;
+	}
+	else
+	{	//arena is full, keep the step running
+		address = JPH::AlignedAllocate(size, c_TempAlignment);
+		m_overflowBytes += size;
+		++m_numOverflows;
+	}
+	m_highWaterMark = std::max(m_highWaterMark, m_top + m_overflowBytes);
+	return address;
+}
+
+void WP_PhysicsTempAllocator::Free(void* _address, JPH::uint _size)
+{
+	if (_address == nullptr) { return; }
+	uint32_t const size = AlignSize(_size);
+	uint8_t* const address = static_cast<uint8_t*>(_address);
+	if (address >= m_base && address < m_base + m_capacity)
+	{
+		assert(address + size == m_base + m_top);	//stack order
+		m_top -= size;
+	}
+	else
+	{
+		JPH::AlignedFree(_address);
+		m_overflowBytes -= size;
+	}
+}
+
+bool WP_PhysicsTempAllocator::Resize(uint32_t _capacity)
+{
+	if (m_top != 0 || m_overflowBytes != 0) { return false; }
+	JPH::AlignedFree(m_base);
+	m_capacity = AlignSize(_capacity);
+	m_base = static_cast<uint8_t*>(JPH::AlignedAllocate(m_capacity, c_TempAlignment));
+	return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <cstdint>
+
+//Stack allocator handed to PhysicsSystem::Update, same layout as JPH::TempAllocatorImpl.
+//Also tracks the peak number of bytes in use, so the physics system can report how close a
+//step came to the arena size. Allocations that do not fit go to the heap instead of asserting,
+//and are counted as overflows.
+//Jolt only uses the temp allocator from one thread at a time.
+class WP_PhysicsTempAllocator final : public JPH::TempAllocator
+{
+public:
+	explicit WP_PhysicsTempAllocator(uint32_t _capacity);
+	~WP_PhysicsTempAllocator() override;
+
+	WP_PhysicsTempAllocator(WP_PhysicsTempAllocator const&) = delete;
+	WP_PhysicsTempAllocator& operator=(WP_PhysicsTempAllocator const&) = delete;
+
+	void*		Allocate(JPH::uint _size) override;
+	void		Free(void* _address, JPH::uint _size) override;
+
+	uint32_t	GetCapacity() const { return m_capacity; }
+	uint32_t	GetHighWaterMark() const { return m_highWaterMark; }	//peak bytes in use since reset, overflow included
+	uint32_t	GetNumOverflows() const { return m_numOverflows; }		//allocations sent to the heap since reset
+	void		ResetStats() { m_highWaterMark = m_top + m_overflowBytes; m_numOverflows = 0; }
+
+	//replaces the arena, only between updates when nothing is allocated. false if still in use
+	bool		Resize(uint32_t _capacity);
+
+private:
+	uint8_t*	m_base = nullptr;
+	uint32_t	m_capacity = 0;
+	uint32_t	m_top = 0;
+	uint32_t	m_overflowBytes = 0;		//heap bytes currently allocated
+	uint32_t	m_highWaterMark = 0;
+	uint32_t	m_numOverflows = 0;
+};